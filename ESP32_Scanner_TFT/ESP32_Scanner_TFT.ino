@@ -8,7 +8,7 @@
  * 4. Show event selection menu
  * 5. User selects event → Immediately activates event and starts scanning
  * 6. Scan for registered devices using BLE
- * 7. Record attendance for any registered devices found
+ * 7. Track presence of registered devices; upload arrivals and departures
  * 8. Press ENTER while scanning → Stops scan, deactivates event, returns to menu
  * 
  * Bluetooth Support:
@@ -27,9 +27,18 @@
 #include "display_manager.h"
 #include "button_manager.h"
 #include "led_manager.h"
+#include "power_manager.h"
 #include "backend_client.h"
 #include "ble_scanner.h"
 #include "event_manager.h"
+#include "string_arena.h"
+#include "scanner_metrics.h"
+#include "trace.h"
+#include "capture.h"
+#include "log.h"
+#include "heap_monitor.h"
+#include "metrics_server.h"
+#include "presence_tracker.h"
 
 // Configuration
 const char* WIFI_SSID = "scanner-wifi";
@@ -41,9 +50,18 @@ const char* API_KEY = "att_3sh4fmd2u14ffisevqztm";
 DisplayManager display;
 ButtonManager buttons;
 LEDManager leds;
+PowerManager power;
 BackendClient backend;
 BLEScanner bleScanner;
 EventManager events;
+ScannerMetrics scannerMetrics;
+Logger logger;
+HeapMonitor heapMonitor;
+MetricsServer metricsServer;
+PresenceTracker presence;
+
+// Per-batch scratch memory for attendance uploads, reset after every flush
+StaticStringArena<BATCH_ARENA_SIZE> batchArena;
 
 // System state
 enum SystemState {
@@ -65,10 +83,30 @@ int eventLoadRetries = 0;
 const int MAX_EVENT_RETRIES = 3;
 bool stopScanRequested = false;
 
+// Function prototypes; the Arduino IDE would generate these, but the host
+// build compiles the sketch as plain C++
+bool initializeHardware();
+void updateHardware();
+void updateSystemState();
+unsigned long long getCurrentTimestamp();
+bool connectToWiFi();
+bool loadEvents();
+void handleEnterPress();
+void startScanning();
+void stopScanning();
+void performScan();
+void recordAckLatency(const PresenceEvent* changes, int count, uint32_t sendMillis, unsigned long serializeUs,
+                      unsigned long uploadStart, long serverMs);
+bool recordAttendanceBatch();
+void setError(const String& message);
+void updateLEDStates();
+void testSimpleConnection();
+
 void setup() {
   Serial.begin(115200);
-  Serial.println("\n=== ESP32 Attendance Scanner ===");
-  Serial.println("Version: 3.0.0");
+  logger.begin();
+  LOG_INFO("=== ESP32 Attendance Scanner ===");
+  LOG_INFO("Version: 3.0.0");
   
   // Initialize hardware
   if (!initializeHardware()) {
@@ -80,7 +118,7 @@ void setup() {
   currentState = STATE_WIFI_CONNECTING;
   display.showWiFiConnecting(WIFI_SSID);
   
-  Serial.println("System initialized successfully");
+  LOG_INFO("System initialized successfully");
 }
 
 void loop() {
@@ -88,44 +126,85 @@ void loop() {
   static unsigned long lastWiFiCheck = 0;
   if (millis() - lastWiFiCheck > 5000) { // Check every 5 seconds
     if (WiFi.status() != WL_CONNECTED && currentState != STATE_WIFI_CONNECTING) {
-      Serial.println("⚠️ WiFi disconnected! Attempting to reconnect...");
+      LOG_WARN("WiFi disconnected! Attempting to reconnect...");
       currentState = STATE_WIFI_CONNECTING;
       display.showLoading("WiFi reconnecting...");
     }
     lastWiFiCheck = millis();
   }
   
+  // Serial console commands: 'h' prints heap telemetry, 't' dumps the
+  // span ring as Chrome trace JSON, 'r' starts/stops an advertisement
+  // capture and 'c' dumps it
+  if (Serial.available() > 0) {
+    int command = Serial.read();
+    if (command == 'h') {
+      heapMonitor.sample();
+      heapMonitor.report();
+    }
+#if TRACE_ENABLED
+    if (command == 't') {
+      logger.flush();
+      traceBuffer.dumpChromeJson(Serial);
+    }
+#endif
+#if CAPTURE_ENABLED
+    if (command == 'r') {
+      if (captureBuffer.isRecording()) {
+        captureBuffer.stop();
+      } else {
+        captureBuffer.start();
+      }
+    }
+    if (command == 'c') {
+      if (captureBuffer.isRecording()) {
+        captureBuffer.stop();
+      }
+      logger.flush();
+      captureBuffer.dump(Serial);
+    }
+#endif
+  }
+  
+  // Menu and error screens only wait for a button: run them at low clock
+  power.setIdleMode(currentState == STATE_EVENT_SELECTION || currentState == STATE_ERROR);
+  
   // Update hardware
   updateHardware();
+  power.markResponsive();
   
   // Update system state
   updateSystemState();
+  heapMonitor.update();
   
-  // Small delay
-  delay(10);
+  // Light sleep when idle, otherwise wait for the next button edge or 10ms
+  power.wait(10);
 }
 
 bool initializeHardware() {
-  Serial.println("Initializing hardware...");
+  LOG_INFO("Initializing hardware...");
   
   // Initialize display
   if (!display.begin()) {
-    Serial.println("Failed to initialize display");
+    LOG_ERROR("Failed to initialize display");
     return false;
   }
   
   // Initialize buttons
   if (!buttons.begin()) {
-    Serial.println("Failed to initialize buttons");
+    LOG_ERROR("Failed to initialize buttons");
     return false;
   }
   
   // Initialize LEDs
   if (!leds.begin()) {
-    Serial.println("Failed to initialize LEDs");
+    LOG_ERROR("Failed to initialize LEDs");
     return false;
   }
   
+  // Initialize power management
+  power.begin();
+  
   // Initialize backend
   backend.begin();
   backend.setBaseURL(BACKEND_URL);
@@ -133,14 +212,17 @@ bool initializeHardware() {
   
   // Initialize BLE scanner
   if (!bleScanner.begin()) {
-    Serial.println("Failed to initialize BLE scanner");
+    LOG_ERROR("Failed to initialize BLE scanner");
     return false;
   }
   
   // Initialize event manager
   events.begin();
   
-  Serial.println("Hardware initialization complete");
+  // Baseline heap once every subsystem holds its buffers
+  heapMonitor.begin();
+  
+  LOG_INFO("Hardware initialization complete");
   return true;
 }
 
@@ -157,22 +239,9 @@ void updateHardware() {
     display.navigateDown();
   }
   
-  // ENTER handling: edge-triggered + optional long-press in scanning
-  if (currentState == STATE_SCANNING) {
-    static bool stopTriggered = false;
-    // Use edge event to start measuring hold, reduce accidental repeats
-    if (buttons.pollEnterEvent()) {
-      // Edge occurred; held logic continues below
-    }
-    if (!stopTriggered && buttons.isEnterHeld(600)) {
-      stopTriggered = true;
-      Serial.println("Long-press ENTER detected (>=0.6s). Stopping scan.");
-      handleEnterPress();
-    }
-    if (!buttons.isEnterPressed()) {
-      stopTriggered = false; // reset when released
-    }
-  } else if (buttons.pollEnterEvent()) {
+  // ENTER is edge-triggered in every state; while scanning a press queued
+  // during the scan or upload sets stopScanRequested, so none is lost
+  if (buttons.pollEnterEvent()) {
     handleEnterPress();
   }
   
@@ -189,6 +258,7 @@ void updateSystemState() {
       if (connectToWiFi()) {
         currentState = STATE_WIFI_CONNECTED;
         display.showWiFiConnected(WiFi.localIP().toString());
+        metricsServer.begin();
         delay(2000);
         currentState = STATE_LOADING_EVENTS;
         display.showLoading("Loading events...");
@@ -239,7 +309,7 @@ unsigned long long getCurrentTimestamp() {
   
   if (now < 1000000000) {
     // Time not synced yet - this is bad!
-    Serial.println("WARNING: Time not synced, using millis() - attendance may fail!");
+    LOG_WARN("Time not synced, using millis() - attendance may fail!");
     return millis(); // Fallback but will cause backend errors
   }
   
@@ -259,7 +329,7 @@ bool connectToWiFi() {
   lastAttempt = millis();
   attempts++;
   
-  Serial.println("WiFi attempt " + String(attempts) + ": Connecting to " + String(WIFI_SSID));
+  LOG_INFO("WiFi attempt %d: Connecting to %s", attempts, WIFI_SSID);
   
   WiFi.mode(WIFI_STA);
   WiFi.disconnect(true, true);
@@ -276,14 +346,14 @@ bool connectToWiFi() {
   while (WiFi.status() != WL_CONNECTED && waitAttempts < 20) {
     delay(500);
     waitAttempts++;
-    Serial.print(".");
+    LOG_VERBOSE("WiFi status %d after %d ms", (int)WiFi.status(), waitAttempts * 500);
   }
   
   if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("\nWiFi connected: " + WiFi.localIP().toString());
+    LOG_INFO("WiFi connected: %s", WiFi.localIP().toString().c_str());
     
     // Configure time sync with NTP
-    Serial.println("Syncing time with NTP...");
+    LOG_INFO("Syncing time with NTP...");
     configTime(0, 0, "pool.ntp.org", "time.nist.gov");
     
     // Wait up to 5 seconds for time to be set
@@ -296,16 +366,16 @@ bool connectToWiFi() {
     }
     
     if (now > 1000000000) {
-      Serial.println("Time synced: " + String(ctime(&now)));
+      LOG_INFO("Time synced: %lu", (unsigned long)now);
     } else {
-      Serial.println("Warning: Time sync failed, timestamps may be incorrect");
+      LOG_WARN("Time sync failed, timestamps may be incorrect");
     }
     
     return true;
   } else {
-    Serial.println("\nWiFi connection failed");
+    LOG_WARN("WiFi connection failed");
     if (attempts >= 5) {
-      Serial.println("Max WiFi attempts reached, starting AP mode");
+      LOG_WARN("Max WiFi attempts reached, starting AP mode");
       WiFi.softAP("ESP32-Scanner", "attendance123");
       return true; // AP mode counts as "connected" for our purposes
     }
@@ -314,30 +384,30 @@ bool connectToWiFi() {
 }
 
 bool loadEvents() {
-  Serial.println("Loading events from backend...");
+  LOG_INFO("Loading events from backend...");
   
   if (!backend.isConnected()) {
-    Serial.println("Backend not connected");
+    LOG_ERROR("Backend not connected");
     return false;
   }
   
   // Test backend connection first
-  Serial.println("Testing backend health...");
+  LOG_DEBUG("Testing backend health...");
   if (backend.healthCheck()) {
-    Serial.println("Backend health check passed");
+    LOG_INFO("Backend health check passed");
   } else {
-    Serial.println("Backend health check failed: " + backend.getLastError());
+    LOG_WARN("Backend health check failed: %s", backend.getLastError().c_str());
   }
   
   // Test simple HTTP connection
-  Serial.println("Testing simple HTTP connection...");
+  LOG_DEBUG("Testing simple HTTP connection...");
   testSimpleConnection();
   
   if (events.loadFromBackend(backend)) {
-    Serial.println("Events loaded successfully: " + String(events.getEventCount()) + " events");
+    LOG_INFO("Events loaded successfully: %d events", events.getEventCount());
     return true;
   } else {
-    Serial.println("Failed to load events: " + backend.getLastError());
+    LOG_ERROR("Failed to load events: %s", backend.getLastError().c_str());
     return false;
   }
 }
@@ -349,7 +419,7 @@ void handleEnterPress() {
       if (events.selectEvent(display.getSelectedIndex())) {
         selectedEventId = events.getSelectedEventId();
         selectedEventName = events.getSelectedEventName();
-        Serial.println("Event selected: " + selectedEventName);
+        LOG_INFO("Event selected: %s", selectedEventName.c_str());
         startScanning();  // Immediately start scanning
       }
       break;
@@ -362,7 +432,7 @@ void handleEnterPress() {
     case STATE_SCANNING:
       // Set flag to stop scanning and return to event menu
       stopScanRequested = true;
-      Serial.println("Stop scan requested by user");
+      LOG_INFO("Stop scan requested by user");
       break;
       
     case STATE_ERROR:
@@ -384,21 +454,31 @@ void startScanning() {
   stopScanRequested = false;
   
   // Activate event in backend
-  Serial.println("Activating event in backend...");
+  LOG_INFO("Activating event in backend...");
   display.showLoading("Activating event...");
   
   if (!backend.activateEvent(selectedEventId)) {
-    Serial.println("Warning: Failed to activate event");
-    Serial.println("Error: " + backend.getLastError());
+    LOG_WARN("Failed to activate event: %s", backend.getLastError().c_str());
     // Continue anyway - event might already be active
   } else {
-    Serial.println("Event activated successfully!");
+    LOG_INFO("Event activated successfully!");
   }
   
   delay(500); // Brief pause to show activation message
   
+  // Sessions start over with the new registration table. stopScanning()
+  // sends or discards the last event's changes; anything still queued was
+  // cut off by a reconnect, and its table is already gone
+  int discarded = presence.reset();
+  if (discarded > 0) {
+    scannerMetrics.presenceDiscarded += discarded;
+    LOG_WARN("Discarded %d presence change(s) of an interrupted scan", discarded);
+  }
+  scannerMetrics.studentsPresent = 0;
+  scannerMetrics.uploadPending = 0;
+  
   // Load registered devices for this event
-  Serial.println("Loading registered devices for event...");
+  LOG_INFO("Loading registered devices for event...");
   display.showLoading("Loading registered devices...");
   
   if (!events.loadRegisteredDevices(backend)) {
@@ -407,48 +487,59 @@ void startScanning() {
   }
   
   int deviceCount = events.getRegisteredDeviceCount();
-  Serial.println("Found " + String(deviceCount) + " registered devices");
+  LOG_INFO("Found %d registered devices", deviceCount);
   
   if (deviceCount == 0) {
-    Serial.println("Warning: No registered devices for this event");
+    LOG_WARN("No registered devices for this event");
     display.showLoading("Warning: No devices!");
     delay(2000);
   }
   
   currentState = STATE_SCANNING;
   display.showScanning(selectedEventName);
-  Serial.println("=== SCANNING ACTIVATED ===");
-  Serial.println("Event: " + selectedEventName);
-  Serial.println("Event ID: " + selectedEventId);
-  Serial.println("Registered devices: " + String(deviceCount));
-  Serial.println("Looking for devices with 'ATT-' prefix");
-  Serial.println("Hold ENTER (≥0.8s) to stop scanning");
+  LOG_INFO("=== SCANNING ACTIVATED ===");
+  LOG_INFO("Event: %s", selectedEventName.c_str());
+  LOG_INFO("Event ID: %s", selectedEventId.c_str());
+  LOG_INFO("Registered devices: %d", deviceCount);
+  LOG_INFO("Looking for devices with 'ATT-' prefix");
+  LOG_INFO("Press ENTER to stop scanning");
 }
 
 void stopScanning() {
-  Serial.println("=== STOPPING SCAN ===");
-  Serial.println("Deactivating event and returning to menu");
+  LOG_INFO("=== STOPPING SCAN ===");
+  LOG_INFO("Deactivating event and returning to menu");
   
   // Show loading screen
   display.showLoading("Stopping scan...");
   display.update();
   
+  // Close every open session so the backend gets check-out times, while
+  // the event is still active
+  presence.departAll(millis());
+  if (presence.getPendingCount() > 0 && !recordAttendanceBatch()) {
+    // Their ordinals index this event's registration table, which the
+    // next event selection clears, so they cannot be sent later
+    int discarded = presence.reset();
+    scannerMetrics.presenceDiscarded += discarded;
+    LOG_WARN("Discarded %d presence change(s) that could not be uploaded", discarded);
+  }
+  scannerMetrics.studentsPresent = 0;
+  
   // Deactivate event on backend (deactivates ALL events)
-  Serial.println("Deactivating event on backend...");
+  LOG_INFO("Deactivating event on backend...");
   String response;
   if (backend.makeRequest("deactivate-events", "POST", "", response)) {
-    Serial.println("✅ Event deactivated successfully");
+    LOG_INFO("Event deactivated successfully");
     
     // Parse response
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, response);
     if (!error && doc["success"]) {
       int deactivatedCount = doc["deactivatedCount"] | 0;
-      Serial.println("   Deactivated " + String(deactivatedCount) + " event(s)");
+      LOG_INFO("   Deactivated %d event(s)", deactivatedCount);
     }
   } else {
-    Serial.println("⚠️ Warning: Failed to deactivate event on backend");
-    Serial.println("   Error: " + backend.getLastError());
+    LOG_WARN("Failed to deactivate event on backend: %s", backend.getLastError().c_str());
     // Continue anyway - user wants to stop scanning
   }
   
@@ -470,8 +561,8 @@ void stopScanning() {
     delay(10);
   }
   
-  Serial.println("=== SCAN STOPPED ===");
-  Serial.println("Select an event to begin scanning");
+  LOG_INFO("=== SCAN STOPPED ===");
+  LOG_INFO("Select an event to begin scanning");
 }
 
 void performScan() {
@@ -489,10 +580,11 @@ void performScan() {
   }
   
   lastScan = millis();
-  Serial.println("Performing BLE scan for event: " + selectedEventName);
+  TRACE_SCOPE("scan.cycle");
+  LOG_DEBUG("Performing BLE scan for event: %s", selectedEventName.c_str());
   
-  // Scan for BLE devices
-  std::vector<ScannedDevice> devices = bleScanner.scan();
+  // Scan for BLE devices; registration is resolved during the scan
+  SightingView sightings = bleScanner.scan();
   
   // Check if stop was requested during scan
   if (stopScanRequested) {
@@ -500,123 +592,171 @@ void performScan() {
     return;
   }
   
-  if (devices.size() > 0) {
-    Serial.println("Found " + String(devices.size()) + " BLE devices");
-    
-    // Collect registered devices for batch processing
-    std::vector<ScannedDevice> registeredDevicesList;
-    
-    for (const auto& device : devices) {
-      Serial.println("Checking device: " + device.name + " (UUID: " + device.uuid + ")");
-      
-      if (isDeviceRegistered(device)) {
-        registeredDevicesList.push_back(device);
-        Serial.println("Device is registered for this event!");
-      } else {
-        Serial.println("Device not registered for this event");
-      }
-    }
-    
-    Serial.println("Registered devices found: " + String(registeredDevicesList.size()) + "/" + String(devices.size()));
-    
-    // OPTIMIZED: Batch record all attendance in ONE network call
-    if (registeredDevicesList.size() > 0) {
-      recordAttendanceBatch(registeredDevicesList);
-    }
-  } else {
-    Serial.println("No BLE devices found in this scan");
+  LOG_DEBUG("Found %d BLE devices", (int)sightings.size());
+  
+  // Every scan feeds the tracker, empty ones included, so departures are
+  // noticed; only arrivals and departures are uploaded
+  int changes = presence.update(sightings, millis());
+  scannerMetrics.studentsPresent = presence.getPresentCount();
+  if (changes > 0) {
+    LOG_INFO("Presence: %d change(s), %d present", changes, scannerMetrics.studentsPresent);
+  }
+  
+  // Changes left over from a failed upload are retried with the next scan
+  if (presence.getPendingCount() > 0) {
+    recordAttendanceBatch();
   }
   
   // Update display with scan results
-  display.updateScanResults(devices.size());
+  display.updateScanResults(sightings.size());
 }
 
-bool isDeviceRegistered(const ScannedDevice& device) {
-  return events.isDeviceRegistered(selectedEventId, device.uuid);
+// Splits detection-to-acknowledgement time into queueing (detection until
+// the batch is sent), serialization, network and server time. Server time
+// comes from the backend's serverMs; without it the whole round trip counts
+// as network. Detection is when the tracker noticed the change.
+void recordAckLatency(const PresenceEvent* changes, int count, uint32_t sendMillis, unsigned long serializeUs,
+                      unsigned long uploadStart, long serverMs) {
+  uint32_t ackMillis = millis();
+  uint32_t roundTripMs = ackMillis - uploadStart;
+  if (serverMs >= 0 && (uint32_t)serverMs <= roundTripMs) {
+    scannerMetrics.serverLatency.record((uint32_t)serverMs);
+    scannerMetrics.networkLatency.record(roundTripMs - (uint32_t)serverMs);
+  } else {
+    serverMs = -1;
+    scannerMetrics.networkLatency.record(roundTripMs);
+  }
+  
+  uint32_t oldest = 0;
+  for (int i = 0; i < count; i++) {
+    uint32_t latency = ackMillis - changes[i].detectedMs;
+    scannerMetrics.ackLatency.record(latency);
+    if (latency > oldest) {
+      oldest = latency;
+    }
+  }
+  
+  LOG_INFO("Detection to ack: max %lu ms (queued %lu ms, serialize %lu us, network %lu ms, server %ld ms)",
+           (unsigned long)oldest, (unsigned long)(oldest - (ackMillis - sendMillis)), serializeUs,
+           (unsigned long)(serverMs >= 0 ? roundTripMs - serverMs : roundTripMs), serverMs);
 }
 
-// OPTIMIZED: Batch record attendance (single network call!)
-void recordAttendanceBatch(const std::vector<ScannedDevice>& devices) {
-  Serial.println("\n=== Batch Recording Attendance ===");
-  Serial.println("Recording " + String(devices.size()) + " devices in ONE request...");
+// Uploads queued presence changes, as many per request as fit in the batch
+// arena, until the outbox is empty or a request fails. Returns true when
+// everything was acknowledged; what is left is retried after the next scan.
+bool recordAttendanceBatch() {
+  TRACE_SCOPE("upload.batch");
+  LOG_INFO("=== Batch Recording Attendance ===");
+  LOG_INFO("Recording %d presence change(s)...", presence.getPendingCount());
   
   // Show loading screen
-  display.showLoading("Recording " + String(devices.size()) + " student(s)...");
+  display.showLoading("Recording " + String(presence.getPendingCount()) + " update(s)...");
   display.update();
   delay(50); // Give display time to refresh
   
-  // Create batch records array
-  JsonDocument doc;
-  JsonArray records = doc["records"].to<JsonArray>();
-  
-  for (const auto& device : devices) {
-    JsonObject record = records.add<JsonObject>();
-    record["eventId"] = selectedEventId;
-    record["bleUuid"] = device.uuid;
-    record["deviceName"] = device.name;
-    record["rssi"] = device.rssi;
-    record["timestamp"] = getCurrentTimestamp(); // Use proper Unix timestamp
-    record["scannerSource"] = "ESP32-Scanner-01"; // Changed from scannerId to match backend
-  }
-  
-  // Serialize to string
-  String body;
-  serializeJson(doc, body);
-  
-  Serial.println("Request body size: " + String(body.length()) + " bytes");
-  
-  // Use backend client to send (it has proper HTTPS setup)
-  String response;
-  if (backend.makeRequest("batch-checkin", "POST", body, response)) {
+  int recorded = 0;
+  bool ok = true;
+  while (ok && presence.getPendingCount() > 0) {
+    const PresenceEvent* changes = presence.getPending();
+    
+    // Serialize straight from the outbox into the batch arena; each record
+    // carries the time its change applies to
+    uint32_t sendMillis = millis();
+    unsigned long serializeStart = micros();
+    size_t capacity = batchArena.getCapacity() - batchArena.getUsed();
+    char* body = (char*)batchArena.allocate(capacity, 1);
+    size_t bodyLength = 0;
+    int count = 0;
+    if (body) {
+      bodyLength = BackendClient::buildPresenceBody(changes, presence.getPendingCount(),
+                                                    events.getRegisteredDeviceTable(),
+                                                    events.getRegisteredDeviceCount(),
+                                                    selectedEventId.c_str(), "ESP32-Scanner-01",
+                                                    getCurrentTimestamp(), sendMillis, body, capacity, count);
+    }
+    unsigned long serializeUs = micros() - serializeStart;
+    if (bodyLength == 0) {
+      batchArena.reset();
+      LOG_ERROR("Presence batch could not be built (arena full or registration table changed)");
+      scannerMetrics.uploadsFailed++;
+      display.showLoading("Error: Batch too large");
+      ok = false;
+      break;
+    }
+    
+    LOG_DEBUG("Request body size: %u bytes, %d record(s)", (unsigned)bodyLength, count);
+    scannerMetrics.serializeLatency.record(serializeUs);
+    for (int i = 0; i < count; i++) {
+      scannerMetrics.queueLatency.record(sendMillis - changes[i].detectedMs);
+    }
+    scannerMetrics.uploadPending = presence.getPendingCount();
+    leds.setBacklog(scannerMetrics.uploadPending);
+    
+    // Use backend client to send (it has proper HTTPS setup)
+    String response;
+    unsigned long uploadStart = millis();
+    leds.setUploading(true);
+    bool sent = backend.makeRequest("batch-checkin", "POST", body, bodyLength, response);
+    leds.setUploading(false);
+    scannerMetrics.lastUploadMs = millis() - uploadStart;
+    batchArena.reset();
+    
+    if (!sent) {
+      LOG_ERROR("Batch recording failed: %s", backend.getLastError().c_str());
+      scannerMetrics.uploadsFailed++;
+      display.showLoading("Error: Network failed");
+      ok = false;
+      break;
+    }
+    
     JsonDocument responseDoc;
+    TRACE_BEGIN("json.batch");
     DeserializationError error = deserializeJson(responseDoc, response);
-    
-    if (!error) {
-      int successful = responseDoc["successful"] | 0;
-      int failed = responseDoc["failed"] | 0;
-      
-      Serial.println("✅ Batch attendance recorded!");
-      Serial.println("   Successful: " + String(successful));
-      Serial.println("   Failed: " + String(failed));
-      
-      // Show success feedback
-      display.showAttendanceRecorded(String(successful) + " student(s)");
-      display.update();
-      delay(1500); // Show success message for 1.5 seconds
-    } else {
-      Serial.println("❌ Failed to parse response");
-      display.showLoading("Error: Bad response");
-      display.update();
-      delay(1500);
+    TRACE_END("json.batch");
+    if (error) {
+      // A 2xx means the backend stored the batch; sending it again would
+      // record every change twice, so only the counts are lost
+      LOG_WARN("Failed to parse batch response; %d change(s) taken as recorded", count);
+      presence.acknowledge(count);
+      continue;
     }
-  } else {
-    Serial.println("❌ Batch recording failed");
-    Serial.println("   Error: " + backend.getLastError());
     
-    // Show error feedback
-    display.showLoading("Error: Network failed");
-    display.update();
-    delay(1500);
+    // Records the backend refused are not retried; sending them again
+    // would be refused the same way
+    int successful = responseDoc["successful"] | 0;
+    int failed = responseDoc["failed"] | 0;
+    scannerMetrics.recordsUploaded += successful;
+    scannerMetrics.recordsRejected += failed;
+    scannerMetrics.uploadsSucceeded++;
+    recorded += successful;
+    
+    LOG_INFO("Batch attendance recorded: %d successful, %d failed", successful, failed);
+    recordAckLatency(changes, count, sendMillis, serializeUs, uploadStart, responseDoc["serverMs"] | -1);
+    presence.acknowledge(count);
+  }
+  scannerMetrics.uploadPending = presence.getPendingCount();
+  leds.setBacklog(scannerMetrics.uploadPending);
+  
+  // Show success or error feedback for 1.5 seconds
+  if (ok) {
+    display.showAttendanceRecorded(String(recorded) + " update(s)");
   }
+  display.update();
+  delay(1500);
   
   // Return to scanning screen
   display.showScanning(selectedEventName);
   display.update();
   
-  Serial.println("=== Batch Recording Complete ===\n");
-}
-
-// Legacy: Single device recording (kept for compatibility)
-void recordAttendance(const ScannedDevice& device) {
-  std::vector<ScannedDevice> singleDevice = {device};
-  recordAttendanceBatch(singleDevice);
+  LOG_DEBUG("=== Batch Recording Complete ===");
+  return ok;
 }
 
 void setError(const String& message) {
   errorMessage = message;
   currentState = STATE_ERROR;
   display.showError(message);
-  Serial.println("Error: " + message);
+  LOG_ERROR("%s", message.c_str());
 }
 
 void updateLEDStates() {
@@ -640,6 +780,9 @@ void updateLEDStates() {
       leds.setSystemState(false, false);
       break;
   }
+  
+  leds.setOnline(WiFi.status() == WL_CONNECTED);
+  leds.setBacklog(scannerMetrics.uploadPending);
 }
 
 void testSimpleConnection() {
@@ -650,15 +793,15 @@ void testSimpleConnection() {
   http.addHeader("Content-Type", "application/json");
   http.addHeader("x-api-key", API_KEY);
   
-  Serial.println("Testing direct HTTP connection...");
+  LOG_DEBUG("Testing direct HTTP connection...");
   int httpCode = http.GET();
-  Serial.println("HTTP Code: " + String(httpCode));
+  LOG_DEBUG("HTTP Code: %d", httpCode);
   
   if (httpCode > 0) {
     String response = http.getString();
-    Serial.println("Response: " + response);
+    LOG_VERBOSE("Response: %s", response.c_str());
   } else {
-    Serial.println("HTTP request failed with code: " + String(httpCode));
+    LOG_WARN("HTTP request failed with code: %d", httpCode);
   }
   
   http.end();
@@ -0,0 +1,109 @@
+#include "address_cache.h"
+
+static const uint8_t ENTRY_VALID = 0x01;
+static const uint8_t ENTRY_REFERENCED = 0x02;
+static const uint8_t ENTRY_ATTENDANCE = 0x04;
+
+AddressCache::AddressCache() {
+  evictions = 0;
+  invalidations = 0;
+  clear();
+}
+
+void AddressCache::clear() {
+  memset(entries, 0, sizeof(entries));
+  memset(hand, 0, sizeof(hand));
+}
+
+uint32_t AddressCache::hashPayload(const uint8_t* payload, size_t length) {
+  uint32_t hash = 0x811C9DC5u ^ (uint32_t)length;
+  size_t pos = 0;
+  for (; pos + 4 <= length; pos += 4) {
+    uint32_t word;
+    memcpy(&word, payload + pos, 4);
+    hash = (hash ^ word) * 0x9E3779B1u;
+    hash ^= hash >> 15;
+  }
+  uint32_t tail = 0;
+  for (; pos < length; pos++) {
+    tail = (tail << 8) | payload[pos];
+  }
+  hash = (hash ^ tail) * 0x9E3779B1u;
+  return hash ^ (hash >> 16);
+}
+
+int AddressCache::setFor(const uint8_t* address) {
+  // Mix all six bytes; random addresses differ mostly in the low ones
+  uint32_t low;
+  uint16_t high;
+  memcpy(&low, address, 4);
+  memcpy(&high, address + 4, 2);
+  uint32_t hash = low ^ ((uint32_t)high * 0x85EBCA6Bu);
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6Bu;
+  hash ^= hash >> 13;
+  hash *= 0xC2B2AE35u;
+  hash ^= hash >> 16;
+  return (int)(hash & (SETS - 1));
+}
+
+bool AddressCache::lookup(const uint8_t* address, uint32_t payloadHash, AddressVerdict& verdict) {
+  Entry* set = entries[setFor(address)];
+  for (int way = 0; way < ADDRESS_CACHE_WAYS; way++) {
+    Entry& entry = set[way];
+    if ((entry.flags & ENTRY_VALID) && entry.payloadHash == payloadHash &&
+        memcmp(entry.address, address, 6) == 0) {
+      entry.flags |= ENTRY_REFERENCED;
+      verdict.attendance = (entry.flags & ENTRY_ATTENDANCE) != 0;
+      verdict.uuidHash = entry.uuidHash;
+      verdict.ordinal = entry.ordinal;
+      return true;
+    }
+  }
+  return false;
+}
+
+void AddressCache::insert(const uint8_t* address, uint32_t payloadHash, const AddressVerdict& verdict) {
+  int setIndex = setFor(address);
+  Entry* set = entries[setIndex];
+
+  // Reuse the entry of this address if its payload changed, else a free way
+  int target = -1;
+  for (int way = 0; way < ADDRESS_CACHE_WAYS; way++) {
+    if ((set[way].flags & ENTRY_VALID) && memcmp(set[way].address, address, 6) == 0) {
+      target = way;
+      invalidations++;
+      break;
+    }
+    if (target < 0 && !(set[way].flags & ENTRY_VALID)) {
+      target = way;
+    }
+  }
+
+  // CLOCK: skip entries referenced since the hand last passed, clearing
+  // their bit; terminates within two sweeps
+  if (target < 0) {
+    while (set[hand[setIndex]].flags & ENTRY_REFERENCED) {
+      set[hand[setIndex]].flags &= ~ENTRY_REFERENCED;
+      hand[setIndex] = (hand[setIndex] + 1) % ADDRESS_CACHE_WAYS;
+    }
+    target = hand[setIndex];
+    hand[setIndex] = (hand[setIndex] + 1) % ADDRESS_CACHE_WAYS;
+    evictions++;
+  }
+
+  Entry& entry = set[target];
+  entry.payloadHash = payloadHash;
+  entry.uuidHash = verdict.uuidHash;
+  entry.ordinal = verdict.ordinal;
+  memcpy(entry.address, address, 6);
+  entry.flags = ENTRY_VALID | (verdict.attendance ? ENTRY_ATTENDANCE : 0);
+}
+
+unsigned long AddressCache::getEvictions() const {
+  return evictions;
+}
+
+unsigned long AddressCache::getInvalidations() const {
+  return invalidations;
+}
@@ -0,0 +1,59 @@
+#ifndef ADDRESS_CACHE_H
+#define ADDRESS_CACHE_H
+
+#include <Arduino.h>
+#include "hardware_config.h"
+
+// What the attendance filter decided about one advertiser, so the next
+// advertisement with the same address and payload skips parsing,
+// extraction and the registration lookup.
+struct AddressVerdict {
+  bool attendance;    // Passed the payload part of the attendance filter
+  uint32_t uuidHash;  // hashDeviceUuid() of the extracted UUID
+  int16_t ordinal;    // Registered device index, -1 if not registered
+};
+
+// Set-associative cache keyed by the 48-bit address and a hash of the raw
+// payload. Each set holds ADDRESS_CACHE_WAYS entries and evicts with a
+// CLOCK hand. A rotated random address is simply a new key; the same
+// address with a new payload replaces its old entry. Only touched from
+// the BLE callback, and cleared while no scan is running.
+class AddressCache {
+public:
+  AddressCache();
+
+  void clear();
+
+  // Fills `verdict` and returns true when this address and payload are cached
+  bool lookup(const uint8_t* address, uint32_t payloadHash, AddressVerdict& verdict);
+  void insert(const uint8_t* address, uint32_t payloadHash, const AddressVerdict& verdict);
+  
+  // Key hash of a raw advertisement payload; a word at a time, since it
+  // runs for every advertisement
+  static uint32_t hashPayload(const uint8_t* payload, size_t length);
+
+  // Hits and misses are counted in ScannerMetrics by the caller
+  unsigned long getEvictions() const;
+  unsigned long getInvalidations() const;  // Same address, new payload
+
+private:
+  static const int SETS = ADDRESS_CACHE_SIZE / ADDRESS_CACHE_WAYS;
+
+  struct Entry {
+    uint32_t payloadHash;
+    uint32_t uuidHash;
+    int16_t ordinal;
+    uint8_t address[6];
+    uint8_t flags;
+  };
+
+  Entry entries[SETS][ADDRESS_CACHE_WAYS];
+  uint8_t hand[SETS];
+
+  unsigned long evictions;
+  unsigned long invalidations;
+
+  static int setFor(const uint8_t* address);
+};
+
+#endif // ADDRESS_CACHE_H
@@ -1,4 +1,8 @@
 #include "backend_client.h"
+#include "trace.h"
+#include "log.h"
+#include "heap_monitor.h"
+#include "scanner_metrics.h"
 
 // Global instance defined in ESP32_Scanner_TFT.ino
 
@@ -52,9 +56,9 @@ BackendClient::BackendClient() {
 }
 
 void BackendClient::begin() {
-  Serial.println("Backend Client initialized");
-  Serial.println("Base URL: " + baseURL);
-  Serial.println("API Key: " + String(apiKey.length() > 0 ? "Set" : "Not set"));
+  LOG_INFO("Backend Client initialized");
+  LOG_INFO("Base URL: %s", baseURL.c_str());
+  LOG_INFO("API Key: %s", apiKey.length() > 0 ? "Set" : "Not set");
 }
 
 void BackendClient::setBaseURL(const String& url) {
@@ -72,14 +76,16 @@ void BackendClient::setTimeout(unsigned long timeoutMs) {
   timeout = timeoutMs;
 }
 
-bool BackendClient::getEvents(Event* events, int& count, int maxCount) {
+bool BackendClient::getEvents(Event* events, int& count, int maxCount, StringArena& arena) {
   String response;
   if (!makeRequest("events", "GET", "", response)) {
     return false;
   }
   
+  TRACE_BEGIN("json.events");
   JsonDocument doc;
   DeserializationError error = deserializeJson(doc, response);
+  TRACE_END("json.events");
   if (error) {
     lastError = "Failed to parse events response: " + String(error.c_str());
     return false;
@@ -96,46 +102,49 @@ bool BackendClient::getEvents(Event* events, int& count, int maxCount) {
   for (JsonObject eventObj : eventsArray) {
     if (count >= maxCount) break;
     
-    events[count].id = eventObj["id"].as<String>();
-    events[count].name = eventObj["name"].as<String>();
-    events[count].description = eventObj["description"].as<String>();
+    events[count].id = arena.copy(eventObj["id"].as<const char*>());
+    events[count].name = arena.copy(eventObj["name"].as<const char*>());
+    events[count].description = arena.copy(eventObj["description"].as<const char*>());
     events[count].isActive = eventObj["isActive"].as<bool>();
     // Backend returns startTime/endTime; map to local fields
-    events[count].startDate = eventObj["startTime"].as<String>();
-    events[count].endDate = eventObj["endTime"].as<String>();
+    events[count].startDate = arena.copy(eventObj["startTime"].as<const char*>());
+    events[count].endDate = arena.copy(eventObj["endTime"].as<const char*>());
     
     count++;
   }
   
-  Serial.println("Loaded " + String(count) + " events from backend");
+  LOG_INFO("Loaded %d events from backend (arena %u/%u bytes)",
+           count, (unsigned)arena.getUsed(), (unsigned)arena.getCapacity());
   return true;
 }
 
-bool BackendClient::getActiveEvents(Event* events, int& count, int maxCount) {
+bool BackendClient::getActiveEvents(Event* events, int& count, int maxCount, StringArena& arena) {
   String response;
-  Serial.println("Requesting active events from backend...");
+  LOG_INFO("Requesting active events from backend...");
   
   if (!makeRequest("active-events", "GET", "", response)) {
-    Serial.println("Failed to make request: " + lastError);
+    LOG_ERROR("Failed to make request: %s", lastError.c_str());
     return false;
   }
   
-  Serial.println("Response received: " + response);
+  LOG_DEBUG("Response received: %u bytes", (unsigned)response.length());
   
+  TRACE_BEGIN("json.events");
   JsonDocument doc;
   DeserializationError error = deserializeJson(doc, response);
+  TRACE_END("json.events");
   if (error) {
     lastError = "Failed to parse active events response: " + String(error.c_str());
-    Serial.println("JSON Parse Error: " + String(error.c_str()));
-    Serial.println("Raw response: " + response);
+    LOG_ERROR("JSON Parse Error: %s", error.c_str());
+    LOG_VERBOSE("Raw response: %s", response.c_str());
     return false;
   }
   
   if (!doc.containsKey("events")) {
     lastError = "No events array in response";
-    Serial.println("No 'events' key in response. Available keys:");
+    LOG_ERROR("No 'events' key in response. Available keys:");
     for (JsonPair pair : doc.as<JsonObject>()) {
-      Serial.println("  " + String(pair.key().c_str()));
+      LOG_ERROR("  %s", pair.key().c_str());
     }
     return false;
   }
@@ -143,28 +152,28 @@ bool BackendClient::getActiveEvents(Event* events, int& count, int maxCount) {
   JsonArray eventsArray = doc["events"];
   count = 0;
   
-  Serial.println("Found " + String(eventsArray.size()) + " events in response");
+  LOG_DEBUG("Found %u events in response", (unsigned)eventsArray.size());
   
   for (JsonObject eventObj : eventsArray) {
     if (count >= maxCount) break;
     
-    events[count].id = eventObj["id"].as<String>();
-    events[count].name = eventObj["name"].as<String>();
-    events[count].description = eventObj["description"].as<String>();
+    events[count].id = arena.copy(eventObj["id"].as<const char*>());
+    events[count].name = arena.copy(eventObj["name"].as<const char*>());
+    events[count].description = arena.copy(eventObj["description"].as<const char*>());
     events[count].isActive = eventObj["isActive"].as<bool>();
-    events[count].startDate = eventObj["startDate"].as<String>();
-    events[count].endDate = eventObj["endDate"].as<String>();
+    events[count].startDate = arena.copy(eventObj["startDate"].as<const char*>());
+    events[count].endDate = arena.copy(eventObj["endDate"].as<const char*>());
     
-    Serial.println("Event " + String(count) + ": " + events[count].name + " (ID: " + events[count].id + ")");
+    LOG_DEBUG("Event %d: %s (ID: %s)", count, events[count].name, events[count].id);
     count++;
   }
   
-  Serial.println("Loaded " + String(count) + " active events from backend");
+  LOG_INFO("Loaded %d active events from backend", count);
   return true;
 }
 
 bool BackendClient::activateEvent(const String& eventId) {
-  Serial.println("Activating event: " + eventId);
+  LOG_INFO("Activating event: %s", eventId.c_str());
   
   // Create JSON body
   JsonDocument doc;
@@ -173,34 +182,33 @@ bool BackendClient::activateEvent(const String& eventId) {
   String body;
   serializeJson(doc, body);
   
-  Serial.println("Request body: " + body);
+  LOG_DEBUG("Request body: %s", body.c_str());
   
   // Make request to activate-event endpoint
   String response;
   if (!makeRequest("activate-event", "POST", body, response)) {
-    Serial.println("Failed to activate event: " + lastError);
+    LOG_ERROR("Failed to activate event: %s", lastError.c_str());
     return false;
   }
   
-  Serial.println("Activate event response: " + response);
+  LOG_VERBOSE("Activate event response: %s", response.c_str());
   
   // Parse response
   JsonDocument responseDoc;
   DeserializationError error = deserializeJson(responseDoc, response);
   if (error) {
     lastError = "Failed to parse activate event response: " + String(error.c_str());
-    Serial.println("JSON Parse Error: " + String(error.c_str()));
+    LOG_ERROR("JSON Parse Error: %s", error.c_str());
     return false;
   }
   
   // Check if successful
   if (responseDoc["success"].as<bool>()) {
-    Serial.println("Event activated successfully!");
-    Serial.println("Event name: " + responseDoc["event"]["name"].as<String>());
+    LOG_INFO("Event activated successfully: %s", responseDoc["event"]["name"].as<const char*>());
     return true;
   } else {
     lastError = "Event activation failed: " + responseDoc["error"].as<String>();
-    Serial.println(lastError);
+    LOG_ERROR("%s", lastError.c_str());
     return false;
   }
 }
@@ -239,10 +247,177 @@ bool BackendClient::recordAttendance(const JsonDocument& record) {
     return false;
   }
   
-  Serial.println("Attendance recorded successfully");
+  LOG_INFO("Attendance recorded successfully");
   return true;
 }
 
+// Append `str` as a JSON string literal; returns false when out of space
+static bool appendJsonString(char* out, size_t outSize, size_t& pos, const char* str) {
+  if (pos >= outSize) {
+    return false;
+  }
+  out[pos++] = '"';
+  for (const char* p = str; *p; p++) {
+    char c = *p;
+    if (c == '"' || c == '\\') {
+      if (pos + 2 > outSize) {
+        return false;
+      }
+      out[pos++] = '\\';
+      out[pos++] = c;
+    } else if ((unsigned char)c < 0x20) {
+      if (pos + 7 > outSize) { // snprintf also writes a terminator
+        return false;
+      }
+      pos += snprintf(out + pos, outSize - pos, "\\u%04x", c);
+    } else {
+      if (pos + 1 > outSize) {
+        return false;
+      }
+      out[pos++] = c;
+    }
+  }
+  if (pos >= outSize) {
+    return false;
+  }
+  out[pos++] = '"';
+  return true;
+}
+
+static bool appendRaw(char* out, size_t outSize, size_t& pos, const char* str) {
+  size_t len = strlen(str);
+  if (pos + len > outSize) {
+    return false;
+  }
+  memcpy(out + pos, str, len);
+  pos += len;
+  return true;
+}
+
+size_t BackendClient::buildBatchCheckinBody(const SightingView& sightings, const char* const* deviceUuids,
+                                            const char* eventId, const char* scannerSource,
+                                            unsigned long long nowEpochMs, uint32_t nowMillis,
+                                            char* out, size_t outSize) {
+  // Hand-written instead of a JsonDocument so building a batch touches no heap
+  size_t pos = 0;
+  char number[24];
+  bool first = true;
+  
+  if (!out || outSize == 0 || !appendRaw(out, outSize, pos, "{\"records\":[")) {
+    return 0;
+  }
+  
+  for (int i = 0; i < sightings.size(); i++) {
+    if (!sightings.isRegistered(i)) {
+      continue;
+    }
+    
+    // millis() age of the sighting, applied to the wall clock
+    uint32_t age = nowMillis - sightings.timestamp[i];
+    snprintf(number, sizeof(number), "%llu", nowEpochMs > age ? nowEpochMs - age : 0ULL);
+    
+    bool ok = appendRaw(out, outSize, pos, first ? "{\"eventId\":" : ",{\"eventId\":") &&
+              appendJsonString(out, outSize, pos, eventId) &&
+              appendRaw(out, outSize, pos, ",\"bleUuid\":") &&
+              appendJsonString(out, outSize, pos, deviceUuids[sightings.ordinal[i]]) &&
+              appendRaw(out, outSize, pos, ",\"rssi\":");
+    if (ok) {
+      char rssi[8];
+      snprintf(rssi, sizeof(rssi), "%d", sightings.rssi[i]);
+      ok = appendRaw(out, outSize, pos, rssi) &&
+           appendRaw(out, outSize, pos, ",\"timestamp\":") &&
+           appendRaw(out, outSize, pos, number) &&
+           appendRaw(out, outSize, pos, ",\"scannerSource\":") &&
+           appendJsonString(out, outSize, pos, scannerSource) &&
+           appendRaw(out, outSize, pos, "}");
+    }
+    if (!ok) {
+      return 0;
+    }
+    first = false;
+  }
+  
+  // Keep room for the terminator so the body can be logged as a C string
+  if (!appendRaw(out, outSize, pos, "]}") || pos >= outSize) {
+    return 0;
+  }
+  out[pos] = '\0';
+  return pos;
+}
+
+static const char* const PRESENCE_NAMES[] = { "arrival", "departure", "dwell" };
+
+size_t BackendClient::buildPresenceBody(const PresenceEvent* changes, int count,
+                                        const char* const* deviceUuids, int deviceCount,
+                                        const char* eventId, const char* scannerSource,
+                                        unsigned long long nowEpochMs, uint32_t nowMillis,
+                                        char* out, size_t outSize, int& written) {
+  size_t pos = 0;
+  char number[24];
+  written = 0;
+  
+  // Two bytes stay free for "]}" and one for the terminator
+  if (!out || outSize < 3 || !appendRaw(out, outSize - 3, pos, "{\"records\":[")) {
+    return 0;
+  }
+  // Ordinals index the table the changes were tracked against; once it
+  // has been cleared or reloaded they would name the wrong device
+  if (!deviceUuids) {
+    return 0;
+  }
+  for (int i = 0; i < count; i++) {
+    if (changes[i].ordinal < 0 || changes[i].ordinal >= deviceCount) {
+      return 0;
+    }
+  }
+  size_t limit = outSize - 3;
+  
+  for (int i = 0; i < count; i++) {
+    const PresenceEvent& change = changes[i];
+    size_t recordStart = pos;
+    
+    uint32_t age = nowMillis - change.timeMs;
+    snprintf(number, sizeof(number), "%llu", nowEpochMs > age ? nowEpochMs - age : 0ULL);
+    
+    bool ok = appendRaw(out, limit, pos, written == 0 ? "{\"eventId\":" : ",{\"eventId\":") &&
+              appendJsonString(out, limit, pos, eventId) &&
+              appendRaw(out, limit, pos, ",\"bleUuid\":") &&
+              appendJsonString(out, limit, pos, deviceUuids[change.ordinal]) &&
+              appendRaw(out, limit, pos, ",\"rssi\":");
+    if (ok) {
+      char rssi[8];
+      snprintf(rssi, sizeof(rssi), "%d", change.rssi);
+      ok = appendRaw(out, limit, pos, rssi) &&
+           appendRaw(out, limit, pos, ",\"timestamp\":") &&
+           appendRaw(out, limit, pos, number) &&
+           appendRaw(out, limit, pos, ",\"scannerSource\":") &&
+           appendJsonString(out, limit, pos, scannerSource) &&
+           appendRaw(out, limit, pos, ",\"presence\":\"") &&
+           appendRaw(out, limit, pos, PRESENCE_NAMES[change.change]) &&
+           appendRaw(out, limit, pos, "\"");
+    }
+    if (ok && change.change != PRESENCE_ARRIVAL) {
+      snprintf(number, sizeof(number), "%lu", (unsigned long)change.dwellMs);
+      ok = appendRaw(out, limit, pos, ",\"dwellMs\":") && appendRaw(out, limit, pos, number);
+    }
+    ok = ok && appendRaw(out, limit, pos, "}");
+    if (!ok) {
+      // Drop the partial record; the rest goes in the next body
+      pos = recordStart;
+      break;
+    }
+    written++;
+  }
+  
+  if (written == 0) {
+    return 0;
+  }
+  memcpy(out + pos, "]}", 2);
+  pos += 2;
+  out[pos] = '\0';
+  return pos;
+}
+
 bool BackendClient::isDeviceRegistered(const String& eventId, const String& bleUuid) {
   // Use HTTP /registered-devices?eventId=... and check if bleUuid exists in list
   String endpoint = "registered-devices?eventId=" + eventId;
@@ -287,13 +462,21 @@ String BackendClient::getLastError() {
 }
 
 bool BackendClient::makeRequest(const String& endpoint, const String& method, const String& body, String& response) {
+  return makeRequest(endpoint, method, body.c_str(), body.length(), response);
+}
+
+bool BackendClient::makeRequest(const String& endpoint, const String& method, const char* body, size_t bodyLength, String& response) {
+  TRACE_SCOPE("http.request");
+  HeapScope heapScope(HEAP_BACKEND);
   if (!isConnected()) {
     lastError = "WiFi not connected";
     return false;
   }
   
   String url = buildURL(endpoint);
-  Serial.println("Making " + method + " request to: " + url);
+  LOG_INFO("Making %s request to: %s", method.c_str(), url.c_str());
+  unsigned long requestStart = millis();
+  scannerMetrics.httpRequests++;
   
   // Use HTTPClient for both HTTP and HTTPS
   HTTPClient client;
@@ -301,13 +484,14 @@ bool BackendClient::makeRequest(const String& endpoint, const String& method, co
   
   // For HTTPS, set up secure client
   if (url.startsWith("https://")) {
-    Serial.println("Using HTTPS connection");
+    LOG_DEBUG("Using HTTPS connection");
     secureClient = new WiFiClientSecure;
     secureClient->setInsecure(); // Skip certificate verification
+    scannerMetrics.tlsHandshakes++;
     
-    Serial.println("WiFi Status: " + String(WiFi.status()));
-    Serial.println("WiFi RSSI: " + String(WiFi.RSSI()) + " dBm");
-    Serial.println("Free Heap: " + String(ESP.getFreeHeap()) + " bytes");
+    LOG_DEBUG("WiFi status %d, RSSI %d dBm, free heap %lu bytes, largest block %lu",
+              (int)WiFi.status(), (int)WiFi.RSSI(), (unsigned long)ESP.getFreeHeap(),
+              (unsigned long)ESP.getMaxAllocHeap());
     
     client.begin(*secureClient, url);
   } else {
@@ -319,12 +503,12 @@ bool BackendClient::makeRequest(const String& endpoint, const String& method, co
   client.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
   setHeaders(client);
   
-  Serial.println("Sending request...");
+  LOG_DEBUG("Sending request...");
   int httpCode = 0;
   if (method == "GET") {
     httpCode = client.GET();
   } else if (method == "POST") {
-    httpCode = client.POST(body);
+    httpCode = client.POST((uint8_t*)body, bodyLength);
   } else {
     lastError = "Unsupported HTTP method: " + method;
     client.end();
@@ -332,17 +516,27 @@ bool BackendClient::makeRequest(const String& endpoint, const String& method, co
     return false;
   }
   
-  Serial.println("HTTP Code: " + String(httpCode));
+  LOG_DEBUG("HTTP Code: %d", httpCode);
+  if (httpCode <= 0) {
+    scannerMetrics.httpErrors++;
+    if (secureClient) {
+      scannerMetrics.tlsFailures++;
+    }
+  }
   
   if (httpCode > 0) {
+    TRACE_BEGIN("http.body");
     response = client.getString();
-    Serial.println("Response: " + response);
+    TRACE_END("http.body");
+    scannerMetrics.requestLatency.record(millis() - requestStart);
+    LOG_DEBUG("Response: %u bytes", (unsigned)response.length());
+    LOG_VERBOSE("Response body: %s", response.c_str());
     bool success = (httpCode >= 200 && httpCode < 300);
     if (!success) {
       lastError = "HTTP " + String(httpCode) + ": " + response;
-      Serial.println("Request failed: " + lastError);
+      LOG_ERROR("Request failed: %s", lastError.c_str());
     } else {
-      Serial.println("Request successful");
+      LOG_DEBUG("Request successful");
     }
     client.end();
     if (secureClient) delete secureClient;
@@ -351,7 +545,10 @@ bool BackendClient::makeRequest(const String& endpoint, const String& method, co
     client.end();
     if (secureClient) delete secureClient;
     lastError = "HTTP request failed: " + String(httpCode);
-    Serial.println("Request failed: " + lastError);
+    // Connection/TLS failures usually mean the handshake could not allocate
+    HeapSample heap = heapMonitor.sample();
+    LOG_ERROR("Request failed: %s (heap free %lu, largest block %lu, low-water %lu)", lastError.c_str(),
+              (unsigned long)heap.freeBytes, (unsigned long)heap.largestBlock, (unsigned long)heap.minFreeBytes);
     return false;
   }
 }
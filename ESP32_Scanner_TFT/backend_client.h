@@ -7,14 +7,17 @@
 #include <ArduinoHttpClient.h>
 #include <ArduinoJson.h>
 #include "common_types.h"
+#include "string_arena.h"
+#include "sighting_buffer.h"
 
+// Text fields are borrowed from the caller (event arena / scan results)
 struct AttendanceRecord {
-  String eventId;
-  String bleUuid;
-  String deviceName;
+  const char* eventId;
+  const char* bleUuid;
+  const char* deviceName;
   int rssi;
   unsigned long timestamp;
-  String scannerId;
+  const char* scannerId;
 };
 
 class BackendClient {
@@ -36,15 +39,36 @@ public:
   void setAPIKey(const String& key);
   void setTimeout(unsigned long timeoutMs);
   
-  // Event management
-  bool getEvents(Event* events, int& count, int maxCount);
-  bool getActiveEvents(Event* events, int& count, int maxCount);
+  // Event management (event text is copied into the given arena)
+  bool getEvents(Event* events, int& count, int maxCount, StringArena& arena);
+  bool getActiveEvents(Event* events, int& count, int maxCount, StringArena& arena);
   bool activateEvent(const String& eventId);
   
   // Attendance recording
   bool recordAttendance(const AttendanceRecord& record);
   bool recordAttendance(const JsonDocument& record);
   
+  // Writes the /batch-checkin body for the registered rows of a scan
+  // straight into `out`. Each record is stamped with its detection time:
+  // `nowEpochMs` is the wall clock at millis() == `nowMillis`. Returns the
+  // body length, or 0 if it does not fit.
+  static size_t buildBatchCheckinBody(const SightingView& sightings, const char* const* deviceUuids,
+                                      const char* eventId, const char* scannerSource,
+                                      unsigned long long nowEpochMs, uint32_t nowMillis,
+                                      char* out, size_t outSize);
+  
+  // Writes the /batch-checkin body for queued presence changes, as many as
+  // fit in `out`, oldest first; `written` gets the number included. Records
+  // are stamped with the time the change applies to and carry a "presence"
+  // field, plus "dwellMs" for departures and dwell summaries. Returns the
+  // body length, or 0 if not even one record fits or a change's ordinal is
+  // not in the `deviceCount`-entry UUID table.
+  static size_t buildPresenceBody(const PresenceEvent* changes, int count,
+                                  const char* const* deviceUuids, int deviceCount,
+                                  const char* eventId, const char* scannerSource,
+                                  unsigned long long nowEpochMs, uint32_t nowMillis,
+                                  char* out, size_t outSize, int& written);
+  
   // Device registration check
   bool isDeviceRegistered(const String& eventId, const String& bleUuid);
   
@@ -57,6 +81,7 @@ public:
   
   // HTTP request (public for EventManager to use)
   bool makeRequest(const String& endpoint, const String& method, const String& body, String& response);
+  bool makeRequest(const String& endpoint, const String& method, const char* body, size_t bodyLength, String& response);
 };
 
 // Global backend client instance
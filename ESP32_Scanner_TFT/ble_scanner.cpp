@@ -1,6 +1,33 @@
 #include "ble_scanner.h"
+#include "event_manager.h"
+#include "scanner_metrics.h"
+#include "trace.h"
+#include "capture.h"
+#include "log.h"
+#include "heap_monitor.h"
 #include <Arduino.h>
 
+// Copy `len` bytes into a fixed buffer, trimming surrounding whitespace
+// the way String::trim() did. Returns the resulting length.
+static size_t copyTrimmed(const char* src, size_t len, char* out, size_t outSize) {
+  if (outSize == 0) {
+    return 0;
+  }
+  while (len > 0 && isspace((unsigned char)src[0])) {
+    src++;
+    len--;
+  }
+  while (len > 0 && isspace((unsigned char)src[len - 1])) {
+    len--;
+  }
+  if (len >= outSize) {
+    len = outSize - 1;
+  }
+  memcpy(out, src, len);
+  out[len] = '\0';
+  return len;
+}
+
 // Global instance defined in ESP32_Scanner_TFT.ino
 
 // Callback implementation
@@ -23,6 +50,7 @@ BLEScanner::BLEScanner() {
   totalScans = 0;
   totalDevicesFound = 0;
   lastDedupeReset = millis();
+  cacheGeneration = 0;
   callbacks = nullptr;
 }
 
@@ -35,7 +63,7 @@ bool BLEScanner::begin() {
     return true;
   }
   
-  Serial.println("Initializing BLE Scanner...");
+  LOG_INFO("Initializing BLE Scanner...");
   
   // Initialize BLE
   BLEDevice::init("ESP32-Scanner");
@@ -43,7 +71,7 @@ bool BLEScanner::begin() {
   // Create scan object
   pBLEScan = BLEDevice::getScan();
   if (!pBLEScan) {
-    Serial.println("Failed to create BLE scan object");
+    LOG_ERROR("Failed to create BLE scan object");
     return false;
   }
   
@@ -57,7 +85,7 @@ bool BLEScanner::begin() {
   pBLEScan->setWindow(99);
   
   initialized = true;
-  Serial.println("BLE Scanner initialized successfully");
+  LOG_INFO("BLE Scanner initialized successfully");
   return true;
 }
 
@@ -69,26 +97,32 @@ void BLEScanner::end() {
     }
     BLEDevice::deinit(false);
     initialized = false;
-    Serial.println("BLE Scanner deinitialized");
+    LOG_INFO("BLE Scanner deinitialized");
   }
 }
 
-std::vector<ScannedDevice> BLEScanner::scan() {
+SightingView BLEScanner::scan() {
+  TRACE_SCOPE("ble.scan");
+  HeapScope heapScope(HEAP_SCANNER);
   if (!initialized) {
-    return std::vector<ScannedDevice>();
+    sightings.clear();
+    return sightings.view();
   }
   
   // Allow early cancel from main program
   extern bool stopScanRequested;
   
-  // Reset deduplication for this scan window (per-scan dedupe)
-  recentDevices.clear();
+  // Clear previous results; this also resets per-scan deduplication
+  sightings.clear();
   lastDedupeReset = millis();
   
-  // Clear previous results
-  foundDevices.clear();
+  // Cached ordinals index the registration table; drop them when it changes
+  if (events.getRegistrationGeneration() != cacheGeneration) {
+    addressCache.clear();
+    cacheGeneration = events.getRegistrationGeneration();
+  }
   
-  Serial.println("Starting BLE scan (cancelable) for " + String(scanDuration) + "ms...");
+  LOG_DEBUG("Starting BLE scan (cancelable) for %lums...", scanDuration);
   
   // Start scan (non-blocking) so we can cancel early
   pBLEScan->start(scanDuration / 1000, true); // non-blocking
@@ -98,7 +132,7 @@ std::vector<ScannedDevice> BLEScanner::scan() {
   unsigned long scanStart = millis();
   while (millis() - scanStart < scanDuration) {
     if (stopScanRequested) {
-      Serial.println("Scan cancel requested by user - stopping early");
+      LOG_INFO("Scan cancel requested by user - stopping early");
       break;
     }
     delay(50);
@@ -109,11 +143,11 @@ std::vector<ScannedDevice> BLEScanner::scan() {
   pBLEScan->stop();
   
   // Update statistics
-  totalDevicesFound += foundDevices.size();
+  totalDevicesFound += sightings.size();
   
-  Serial.println("BLE scan completed. Found " + String(foundDevices.size()) + " devices");
+  LOG_DEBUG("BLE scan completed. Found %d devices", sightings.size());
   
-  return foundDevices;
+  return sightings.view();
 }
 
 void BLEScanner::setScanDuration(unsigned long duration) {
@@ -129,6 +163,7 @@ void BLEScanner::setActiveScan(bool active) {
 
 void BLEScanner::setUUIDFilter(const String& prefix) {
   uuidFilter = prefix;
+  addressCache.clear();
 }
 
 int BLEScanner::getTotalScans() {
@@ -139,6 +174,14 @@ int BLEScanner::getTotalDevicesFound() {
   return totalDevicesFound;
 }
 
+unsigned long BLEScanner::getDroppedSightings() {
+  return sightings.getDroppedCount();
+}
+
+const AddressCache& BLEScanner::getAddressCache() {
+  return addressCache;
+}
+
 void BLEScanner::resetStatistics() {
   totalScans = 0;
   totalDevicesFound = 0;
@@ -147,21 +190,132 @@ void BLEScanner::resetStatistics() {
 void BLEScanner::resetDeduplication() {
   // Reset deduplication every 5 minutes
   if (millis() - lastDedupeReset > 300000) {
-    recentDevices.clear();
+    sightings.clear();
     lastDedupeReset = millis();
-    Serial.println("BLE deduplication reset");
+    LOG_DEBUG("BLE deduplication reset");
   }
 }
 
-bool BLEScanner::shouldIncludeDevice(BLEAdvertisedDevice& device) {
-  // Check RSSI threshold first (performance)
-  if (device.getRSSI() < -80) { // -80 dBm threshold
-    return false;
+// True if `data` starts with "ATT-" once leading whitespace is trimmed, as
+// extractUUID() would see it
+static bool hasAttendancePrefix(const uint8_t* data, size_t length) {
+  while (length > 0 && isspace(data[0])) {
+    data++;
+    length--;
   }
+  return length >= 4 && memcmp(data, "ATT-", 4) == 0;
+}
+
+PayloadScreen BLEScanner::screenPayload(const uint8_t* payload, size_t length) {
+  // Same walk and last-field-wins rule as parseAdvertisement(), but only
+  // the fields an attendance ID can come from are looked at
+  const uint8_t* manufacturer = nullptr;
+  size_t manufacturerLength = 0;
+  const uint8_t* serviceData = nullptr;
+  size_t serviceDataLength = 0;
+  size_t pos = 0;
+  while (pos < length) {
+    uint8_t len = payload[pos];
+    if (len == 0 || pos + 1 + len > length) {
+      break;
+    }
+    uint8_t type = payload[pos + 1];
+    if (type == 0x08 || type == 0x09) {
+      // A name may be the ID itself or match the name filter
+      return PAYLOAD_CANDIDATE;
+    }
+    if (type == 0xFF) {
+      manufacturer = payload + pos + 2;
+      manufacturerLength = len - 1;
+    } else if (type == 0x16 && len - 1 >= 2) {
+      serviceData = payload + pos + 4;
+      serviceDataLength = len - 3;
+    }
+    pos += 1 + len;
+  }
+  
+  if (!manufacturer && !serviceData) {
+    return PAYLOAD_NO_CARRIER;
+  }
+  // Manufacturer data is a 2-byte company ID, then the ID
+  bool manufacturerFits = manufacturer && manufacturerLength >= 2 + 4;
+  bool serviceDataFits = serviceData && serviceDataLength >= 4;
+  if (!manufacturerFits && !serviceDataFits) {
+    return PAYLOAD_TOO_SHORT;
+  }
+  if ((manufacturerFits && hasAttendancePrefix(manufacturer + 2, manufacturerLength - 2)) ||
+      (serviceDataFits && hasAttendancePrefix(serviceData, serviceDataLength))) {
+    return PAYLOAD_CANDIDATE;
+  }
+  return PAYLOAD_NO_PREFIX;
+}
+
+void BLEScanner::parseAdvertisement(BLEAdvertisedDevice& device, AdvertisementFields& fields) {
+  // 0000FFF0-0000-1000-8000-00805F9B34FB as it appears on air
+  static const uint8_t ATTENDANCE_SERVICE_128[16] = {
+    0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x00
+  };
+  memset(&fields, 0, sizeof(fields));
   
-  // Extract UUID up front (manufacturer data preferred)
-  String uuid = extractUUID(device);
-  if (uuid.length() == 0) {
+  // AD structures: [len][type][data...]; a later field replaces an earlier
+  // one of the same type, as in the BLE library
+  const uint8_t* payload = device.getPayload();
+  size_t length = device.getPayloadLength();
+  size_t pos = 0;
+  while (pos < length) {
+    uint8_t len = payload[pos];
+    if (len == 0 || pos + 1 + len > length) {
+      break;
+    }
+    uint8_t type = payload[pos + 1];
+    const uint8_t* field = payload + pos + 2;
+    size_t fieldLength = len - 1;
+    
+    switch (type) {
+      case 0x08: // Shortened local name
+      case 0x09: // Complete local name
+        fields.name = field;
+        fields.nameLength = fieldLength;
+        break;
+      case 0x02: // 16-bit service UUIDs
+      case 0x03:
+        for (size_t i = 0; i + 1 < fieldLength; i += 2) {
+          if (field[i] == 0xF0 && field[i + 1] == 0xFF) {
+            fields.hasAttendanceService = true;
+          }
+        }
+        break;
+      case 0x06: // 128-bit service UUIDs
+      case 0x07:
+        for (size_t i = 0; i + 15 < fieldLength; i += 16) {
+          if (memcmp(field + i, ATTENDANCE_SERVICE_128, 16) == 0) {
+            fields.hasAttendanceService = true;
+          }
+        }
+        break;
+      case 0x16: // Service data, 16-bit UUID first
+        if (fieldLength >= 2) {
+          if (field[0] == 0xF0 && field[1] == 0xFF) {
+            fields.hasAttendanceService = true;
+          }
+          fields.serviceData = field + 2;
+          fields.serviceDataLength = fieldLength - 2;
+        }
+        break;
+      case 0xFF: // Manufacturer specific data
+        fields.manufacturerData = field;
+        fields.manufacturerLength = fieldLength;
+        break;
+      default:
+        break;
+    }
+    pos += 1 + len;
+  }
+}
+
+bool BLEScanner::isAttendanceAdvertisement(const AdvertisementFields& fields, const char* uuid) {
+  // UUID is extracted up front by the caller (manufacturer data preferred)
+  if (uuid[0] == '\0') {
     return false;
   }
   
@@ -169,97 +323,123 @@ bool BLEScanner::shouldIncludeDevice(BLEAdvertisedDevice& device) {
   // - We detect our service UUID, OR
   // - Device name matches filter, OR
   // - Extracted UUID starts with our prefix (manufacturer data path)
-  bool hasServiceUuid = false;
-  if (device.haveServiceUUID()) {
-    BLEUUID serviceUuid("0000FFF0-0000-1000-8000-00805F9B34FB");
-    hasServiceUuid = device.isAdvertisingService(serviceUuid);
-  }
+  bool hasServiceUuid = fields.hasAttendanceService;
   
   bool nameMatches = false;
-  String name = String(device.getName().c_str());
-  if (name.length() > 0 && uuidFilter.length() > 0) {
-    nameMatches = name.startsWith(uuidFilter);
+  if (uuidFilter.length() > 0) {
+    nameMatches = fields.nameLength >= uuidFilter.length() &&
+                  memcmp(fields.name, uuidFilter.c_str(), uuidFilter.length()) == 0;
   }
   
-  bool uuidMatches = uuid.startsWith("ATT-");
-  if (!hasServiceUuid && !nameMatches && !uuidMatches) {
+  bool uuidMatches = strncmp(uuid, "ATT-", 4) == 0;
+  return hasServiceUuid || nameMatches || uuidMatches;
+}
+
+bool BLEScanner::shouldIncludeDevice(BLEAdvertisedDevice& device, bool attendance, uint32_t hash, int16_t ordinal) {
+  // Check RSSI threshold first (performance)
+  // Weak but plausible signals pass; PresenceTracker applies hysteresis
+  if (device.getRSSI() < RSSI_FLOOR_DBM) {
     return false;
   }
   
-  // Check deduplication by extracted UUID
-  if (recentDevices.find(uuid) != recentDevices.end()) {
+  if (!attendance) {
+    return false;
+  }
+  scannerMetrics.advertisementsMatched++;
+  
+  // Check deduplication by extracted UUID hash and registered ordinal
+  if (sightings.find(hash, ordinal) >= 0) {
     return false;
   }
-  recentDevices.insert(uuid);
   
   return true;
 }
 
-String BLEScanner::extractUUID(BLEAdvertisedDevice& device) {
+size_t BLEScanner::extractUUID(const AdvertisementFields& fields, char* out, size_t outSize) {
   // First, try to get UUID from manufacturer data (react-native-ble-advertiser format)
-  if (device.haveManufacturerData()) {
-    try {
-      std::string manufacturerData = device.getManufacturerData();
-      
-      if (manufacturerData.length() >= 2) {
-        // Skip first 2 bytes (company ID: 0xFFFF)
-        // Convert remaining bytes to string (user ID)
-        String uuid = "";
-        for (size_t i = 2; i < manufacturerData.length(); i++) {
-          uuid += (char)manufacturerData[i];
-        }
-        uuid.trim();
-        
-        // Check if it looks like our UUID format (ATT-USER-XXXXXXXX)
-        if (uuid.length() > 0 && uuid.startsWith("ATT-")) {
-          Serial.println("Extracted UUID from manufacturer data: " + uuid);
-          return uuid;
-        }
-      }
-    } catch (...) {
-      // If manufacturer data extraction fails, fall through
+  if (fields.manufacturerData && fields.manufacturerLength >= 2) {
+    // Skip first 2 bytes (company ID: 0xFFFF); the rest is the user ID
+    size_t len = copyTrimmed((const char*)fields.manufacturerData + 2, fields.manufacturerLength - 2, out, outSize);
+    
+    // Check if it looks like our UUID format (ATT-USER-XXXXXXXX)
+    if (len > 0 && strncmp(out, "ATT-", 4) == 0) {
+      LOG_VERBOSE("Extracted UUID from manufacturer data: %s", out);
+      return len;
     }
   }
   
   // Second, try to get UUID from service data (backup method)
-  if (device.haveServiceData()) {
-    try {
-      std::string serviceData = device.getServiceData();
-      
-      if (serviceData.length() > 0) {
-        String uuid = "";
-        for (size_t i = 0; i < serviceData.length(); i++) {
-          uuid += (char)serviceData[i];
-        }
-        uuid.trim();
-        
-        if (uuid.length() > 0 && uuid.startsWith("ATT-")) {
-          Serial.println("Extracted UUID from service data: " + uuid);
-          return uuid;
-        }
-      }
-    } catch (...) {
-      // Fall through to device name
+  if (fields.serviceData && fields.serviceDataLength > 0) {
+    size_t len = copyTrimmed((const char*)fields.serviceData, fields.serviceDataLength, out, outSize);
+    
+    if (len > 0 && strncmp(out, "ATT-", 4) == 0) {
+      LOG_VERBOSE("Extracted UUID from service data: %s", out);
+      return len;
     }
   }
   
   // Fallback: use device name as UUID (primary method for Classic BT compatibility)
-  String name = String(device.getName().c_str());
-  name.trim();
-  return name;
+  if (!fields.name) {
+    out[0] = '\0';
+    return 0;
+  }
+  return copyTrimmed((const char*)fields.name, fields.nameLength, out, outSize);
 }
 
 void BLEScanner::onDeviceFound(BLEAdvertisedDevice& device) {
-  if (shouldIncludeDevice(device)) {
-    ScannedDevice scannedDevice;
-    scannedDevice.uuid = extractUUID(device);
-    scannedDevice.name = String(device.getName().c_str());
-    scannedDevice.rssi = device.getRSSI();
-    scannedDevice.address = String(device.getAddress().toString().c_str());
-    scannedDevice.timestamp = millis();
+  TRACE_SCOPE("ble.result");
+  scannerMetrics.advertisementsSeen++;
+  CAPTURE_ADVERTISEMENT(device);
+  
+  // Most traffic in a busy room is headphones, watches and beacons; turn
+  // them away on the raw bytes before hashing or parsing anything
+  switch (screenPayload(device.getPayload(), device.getPayloadLength())) {
+    case PAYLOAD_CANDIDATE:
+      break;
+    case PAYLOAD_NO_CARRIER:
+      scannerMetrics.rejectedNoCarrier++;
+      return;
+    case PAYLOAD_TOO_SHORT:
+      scannerMetrics.rejectedTooShort++;
+      return;
+    case PAYLOAD_NO_PREFIX:
+      scannerMetrics.rejectedNoPrefix++;
+      return;
+  }
+  
+  // A phone repeats the same advertisement many times a second; after the
+  // first one its verdict and ordinal come from the address cache
+  BLEAddress deviceAddress = device.getAddress();
+  const uint8_t* address = *deviceAddress.getNative();
+  uint32_t payloadHash = AddressCache::hashPayload(device.getPayload(), device.getPayloadLength());
+  AddressVerdict verdict;
+  if (addressCache.lookup(address, payloadHash, verdict)) {
+    scannerMetrics.addressCacheHits++;
+  } else {
+    scannerMetrics.addressCacheMisses++;
     
-    foundDevices.push_back(scannedDevice);
+    // Extract once into a stack buffer; nothing on the BLE callback path
+    // touches the heap
+    AdvertisementFields fields;
+    parseAdvertisement(device, fields);
+    char uuid[DEVICE_UUID_SIZE];
+    size_t uuidLength = extractUUID(fields, uuid, sizeof(uuid));
+    verdict.attendance = isAttendanceAdvertisement(fields, uuid);
+    verdict.uuidHash = hashDeviceUuid(uuid, uuidLength);
+    // Resolve registration once here so the main loop only reads ordinals
+    verdict.ordinal = verdict.attendance ? (int16_t)events.findRegisteredDevice(uuid, verdict.uuidHash) : -1;
+    addressCache.insert(address, payloadHash, verdict);
+  }
+  
+  if (shouldIncludeDevice(device, verdict.attendance, verdict.uuidHash, verdict.ordinal)) {
+    int rssi = device.getRSSI();
+    
+    if (sightings.add(verdict.uuidHash, verdict.ordinal, (int8_t)rssi, millis(), address) < 0) {
+      LOG_WARN("Sighting buffer full, device dropped");
+      return;
+    }
     
-    Serial.println("Found BLE device: " + scannedDevice.name + " (RSSI: " + String(scannedDevice.rssi) + ")");
+    LOG_VERBOSE("Found BLE device: %08lx, ordinal %d (RSSI: %d)", (unsigned long)verdict.uuidHash,
+                verdict.ordinal, rssi);
   }
 }
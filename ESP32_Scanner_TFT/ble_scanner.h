@@ -4,10 +4,18 @@
 #include <BLEDevice.h>
 #include <BLEScan.h>
 #include <BLEAdvertisedDevice.h>
-#include <vector>
-#include <set>
 #include "hardware_config.h"
 #include "common_types.h"
+#include "sighting_buffer.h"
+#include "address_cache.h"
+
+// Outcome of the raw-payload screen that runs before any parsing
+enum PayloadScreen {
+  PAYLOAD_CANDIDATE,   // May carry an attendance ID; goes on to the full filter
+  PAYLOAD_NO_CARRIER,  // No manufacturer data, service data or name
+  PAYLOAD_TOO_SHORT,   // Manufacturer or service data too short for "ATT-"
+  PAYLOAD_NO_PREFIX    // Manufacturer and service data do not start with "ATT-"
+};
 
 class BLEScanner {
 private:
@@ -21,10 +29,15 @@ private:
   int totalScans;
   int totalDevicesFound;
   
-  // Deduplication
-  std::set<String> recentDevices;
+  // Per-scan results; deduplication uses the buffer's hash index
+  SightingBuffer sightings;
   unsigned long lastDedupeReset;
   
+  // Filter verdicts per advertiser, kept across scans until the
+  // registration table or the name filter changes
+  AddressCache addressCache;
+  uint32_t cacheGeneration;
+  
   // Callback for scan results
   class MyAdvertisedDeviceCallbacks : public BLEAdvertisedDeviceCallbacks {
   public:
@@ -36,7 +49,19 @@ private:
   };
   
   MyAdvertisedDeviceCallbacks* callbacks;
-  std::vector<ScannedDevice> foundDevices;
+  
+  // Fields of one advertisement, pointing into its raw payload. The BLE
+  // library's getters return std::string copies, so the callback walks the
+  // AD structures itself and stays off the heap.
+  struct AdvertisementFields {
+    const uint8_t* manufacturerData;
+    size_t manufacturerLength;
+    const uint8_t* serviceData;      // After the 16-bit service UUID
+    size_t serviceDataLength;
+    const uint8_t* name;
+    size_t nameLength;
+    bool hasAttendanceService;       // 0xFFF0 listed or carrying service data
+  };
   
 public:
   BLEScanner();
@@ -45,8 +70,8 @@ public:
   bool begin();
   void end();
   
-  // Scanning
-  std::vector<ScannedDevice> scan();
+  // Scanning (the returned view is valid until the next scan)
+  SightingView scan();
   void setScanDuration(unsigned long duration);
   void setActiveScan(bool active);
   void setUUIDFilter(const String& prefix);
@@ -54,13 +79,23 @@ public:
   // Statistics
   int getTotalScans();
   int getTotalDevicesFound();
+  unsigned long getDroppedSightings();
+  const AddressCache& getAddressCache();
   void resetStatistics();
   
 private:
   void resetDeduplication();
-  bool shouldIncludeDevice(BLEAdvertisedDevice& device);
-  String extractUUID(BLEAdvertisedDevice& device);
+  static PayloadScreen screenPayload(const uint8_t* payload, size_t length);
+  static void parseAdvertisement(BLEAdvertisedDevice& device, AdvertisementFields& fields);
+  // Payload-only part of the filter; its result is what the cache keeps
+  bool isAttendanceAdvertisement(const AdvertisementFields& fields, const char* uuid);
+  // Per-advertisement part: signal strength and per-scan dedupe
+  bool shouldIncludeDevice(BLEAdvertisedDevice& device, bool attendance, uint32_t hash, int16_t ordinal);
+  size_t extractUUID(const AdvertisementFields& fields, char* out, size_t outSize);
   void onDeviceFound(BLEAdvertisedDevice& device);
+  
+  // Host microbenchmarks time the private per-advertisement steps
+  friend class ScannerBenchmark;
 };
 
 // Global BLE scanner instance
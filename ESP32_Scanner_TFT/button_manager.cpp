@@ -1,191 +1,243 @@
 #include "button_manager.h"
+#include "log.h"
+#include <driver/gpio.h>
 
 // Global instance defined in ESP32_Scanner_TFT.ino
 
+// Shared with the ISRs, which run without an object
+static QueueHandle_t buttonQueue = NULL;
+static volatile unsigned long droppedEdges = 0;
+
+const uint8_t ButtonManager::pins[BTN_COUNT] = { BUTTON_UP, BUTTON_DOWN, BUTTON_ENTER };
+const char* const ButtonManager::names[BTN_COUNT] = { "UP", "DOWN", "ENTER" };
+
 ButtonManager::ButtonManager() {
-  upPressed = false;
-  downPressed = false;
-  enterPressed = false;
-  
-  upLastState = HIGH;
-  downLastState = HIGH;
-  enterLastState = HIGH;
-  
-  upLastDebounceTime = 0;
-  downLastDebounceTime = 0;
-  enterLastDebounceTime = 0;
+  for (int i = 0; i < BTN_COUNT; i++) {
+    pressed[i] = false;
+    lastChangeMs[i] = 0;
+    pendingEvents[i] = 0;
+    pressStartMs[i] = 0;
+    lastRepeatMs[i] = 0;
+  }
   debounceDelay = 70; // slightly stronger debounce
   enterPressedAtMs = 0;
-  
-  upEventPending = false;
-  downEventPending = false;
-  enterEventPending = false;
-  upPressStartMs = 0;
-  downPressStartMs = 0;
-  upLastRepeatMs = 0;
-  downLastRepeatMs = 0;
   repeatStartDelayMs = 400; // start repeating after 400ms hold
   repeatIntervalMs = 120;   // then repeat every 120ms
 }
 
 bool ButtonManager::begin() {
-  Serial.println("Initializing buttons...");
-  
+  LOG_INFO("Initializing buttons...");
+
+  buttonQueue = xQueueCreate(BUTTON_QUEUE_LENGTH, sizeof(ButtonEdge));
+  if (!buttonQueue) {
+    LOG_ERROR("Failed to create button queue");
+    return false;
+  }
+
   // Configure button pins with internal pullup
   // BUTTON_UP now uses a pull-up-capable GPIO; enable internal pull-up
   pinMode(BUTTON_UP, INPUT_PULLUP);
   pinMode(BUTTON_DOWN, INPUT_PULLUP);
   pinMode(BUTTON_ENTER, INPUT_PULLUP);
-  
-  Serial.println("Buttons initialized successfully");
+
+  attachInterrupt(digitalPinToInterrupt(BUTTON_UP), onUpEdge, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(BUTTON_DOWN), onDownEdge, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(BUTTON_ENTER), onEnterEdge, CHANGE);
+
+  LOG_INFO("Buttons initialized successfully");
   return true;
 }
 
+// ISRs only timestamp the edge and queue it. The pin is passed as a
+// constant so nothing here reads flash while the cache may be disabled.
+void IRAM_ATTR ButtonManager::onUpEdge() {
+  queueEdge(BTN_UP, BUTTON_UP);
+}
+
+void IRAM_ATTR ButtonManager::onDownEdge() {
+  queueEdge(BTN_DOWN, BUTTON_DOWN);
+}
+
+void IRAM_ATTR ButtonManager::onEnterEdge() {
+  queueEdge(BTN_ENTER, BUTTON_ENTER);
+}
+
+void IRAM_ATTR ButtonManager::queueEdge(uint8_t button, uint8_t pin) {
+  ButtonEdge edge;
+  edge.button = button;
+  edge.level = digitalRead(pin);
+  edge.timeMs = millis();
+
+  BaseType_t woken = pdFALSE;
+  if (xQueueSendFromISR(buttonQueue, &edge, &woken) != pdTRUE) {
+    droppedEdges++;
+  }
+  if (woken) {
+    portYIELD_FROM_ISR();
+  }
+}
+
 void ButtonManager::update() {
+  if (!buttonQueue) {
+    return;
+  }
+
+  // Replay queued edges at the time they happened. The first edge of a
+  // press is accepted immediately; bounces inside the debounce window after
+  // it are ignored.
+  ButtonEdge edge;
+  while (xQueueReceive(buttonQueue, &edge, 0) == pdTRUE) {
+    if (edge.button >= BTN_COUNT) {
+      continue;
+    }
+    if (edge.timeMs - lastChangeMs[edge.button] < debounceDelay) {
+      continue;
+    }
+    applyLevel(edge.button, edge.level == BUTTON_PRESSED, edge.timeMs);
+  }
+
   unsigned long now = millis();
-  
-  // Read button states
-  bool upReading = readButton(BUTTON_UP);
-  bool downReading = readButton(BUTTON_DOWN);
-  bool enterReading = readButton(BUTTON_ENTER);
-  
-  // Check for state changes
-  if (upReading != upLastState) {
-    upLastDebounceTime = now;
-  }
-  
-  if (downReading != downLastState) {
-    downLastDebounceTime = now;
-  }
-  
-  if (enterReading != enterLastState) {
-    enterLastDebounceTime = now;
-  }
-  
-  // Debounce each button independently
-  bool upStable = (now - upLastDebounceTime) > debounceDelay;
-  bool downStable = (now - downLastDebounceTime) > debounceDelay;
-  bool enterStable = (now - enterLastDebounceTime) > debounceDelay;
-  
-  bool prevUpPressed = upPressed;
-  bool prevDownPressed = downPressed;
-  bool prevEnterPressed = enterPressed;
-  
-  if (upStable) {
-    upPressed = (upReading == BUTTON_PRESSED);
-  }
-  if (downStable) {
-    downPressed = (downReading == BUTTON_PRESSED);
-  }
-  if (enterStable) {
-    enterPressed = (enterReading == BUTTON_PRESSED);
-  }
-  
-  // Track enter press start time for long-press detection
-  if (enterPressed && !prevEnterPressed) {
-    enterPressedAtMs = now;
-    enterEventPending = true; // edge event
-    #if BUTTON_DEBUG
-    Serial.println("[BTN] ENTER pressed");
-    #endif
-  } else if (!enterPressed && prevEnterPressed) {
-    #if BUTTON_DEBUG
-    Serial.println("[BTN] ENTER released");
-    #endif
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    // Once the pin has settled, trust its level; this catches a release
+    // whose edge fell inside the bounce window or was dropped
+    if (now - lastChangeMs[i] >= debounceDelay) {
+      bool level = (readButton(pins[i]) == BUTTON_PRESSED);
+      if (level != pressed[i]) {
+        applyLevel(i, level, now);
+      }
+    }
+    updateRepeat(i, now);
   }
-  
-  // Edge-triggered navigation events with auto-repeat
-  // UP
-  if (upPressed && !prevUpPressed) {
-    upEventPending = true;         // initial click
-    upPressStartMs = now;
-    upLastRepeatMs = now;
-    #if BUTTON_DEBUG
-    Serial.println("[BTN] UP pressed");
-    #endif
-  } else if (upPressed && prevUpPressed) {
-    if (now - upPressStartMs >= repeatStartDelayMs && now - upLastRepeatMs >= repeatIntervalMs) {
-      upEventPending = true;       // repeat event
-      upLastRepeatMs = now;
-      #if BUTTON_DEBUG
-      Serial.println("[BTN] UP repeat");
-      #endif
+}
+
+void ButtonManager::applyLevel(uint8_t button, bool isPressed, unsigned long atMs) {
+  if (pressed[button] == isPressed) {
+    return;
+  }
+  pressed[button] = isPressed;
+  lastChangeMs[button] = atMs;
+
+  if (isPressed) {
+    if (pendingEvents[button] < 4) {
+      pendingEvents[button]++; // initial click
+    }
+    pressStartMs[button] = atMs;
+    lastRepeatMs[button] = atMs;
+    if (button == BTN_ENTER) {
+      enterPressedAtMs = atMs; // long-press measured from the real press
     }
-  } else if (!upPressed && prevUpPressed) {
-    #if BUTTON_DEBUG
-    Serial.println("[BTN] UP released");
-    #endif
   }
-  
-  // DOWN
-  if (downPressed && !prevDownPressed) {
-    downEventPending = true;       // initial click
-    downPressStartMs = now;
-    downLastRepeatMs = now;
-    #if BUTTON_DEBUG
-    Serial.println("[BTN] DOWN pressed");
-    #endif
-  } else if (downPressed && prevDownPressed) {
-    if (now - downPressStartMs >= repeatStartDelayMs && now - downLastRepeatMs >= repeatIntervalMs) {
-      downEventPending = true;     // repeat event
-      downLastRepeatMs = now;
-      #if BUTTON_DEBUG
-      Serial.println("[BTN] DOWN repeat");
-      #endif
+
+  #if BUTTON_DEBUG
+  LOG_DEBUG("[BTN] %s %s", names[button], isPressed ? "pressed" : "released");
+  #endif
+}
+
+void ButtonManager::updateRepeat(uint8_t button, unsigned long now) {
+  // ENTER is edge-only; long-press is read through isEnterHeld()
+  if (button == BTN_ENTER || !pressed[button]) {
+    return;
+  }
+  if (now - pressStartMs[button] >= repeatStartDelayMs && now - lastRepeatMs[button] >= repeatIntervalMs) {
+    if (pendingEvents[button] < 4) {
+      pendingEvents[button]++; // repeat event
     }
-  } else if (!downPressed && prevDownPressed) {
+    lastRepeatMs[button] = now;
     #if BUTTON_DEBUG
-    Serial.println("[BTN] DOWN released");
+    LOG_DEBUG("[BTN] %s repeat", names[button]);
     #endif
   }
-  
-  // Update last states
-  upLastState = upReading;
-  downLastState = downReading;
-  enterLastState = enterReading;
+}
+
+void ButtonManager::waitForInput(unsigned long timeoutMs) {
+  if (!buttonQueue) {
+    delay(timeoutMs);
+    return;
+  }
+  ButtonEdge edge;
+  xQueuePeek(buttonQueue, &edge, pdMS_TO_TICKS(timeoutMs));
 }
 
 bool ButtonManager::isUpPressed() {
-  return upPressed;
+  return pressed[BTN_UP];
 }
 
 bool ButtonManager::isDownPressed() {
-  return downPressed;
+  return pressed[BTN_DOWN];
 }
 
 bool ButtonManager::isEnterPressed() {
-  return enterPressed;
+  return pressed[BTN_ENTER];
 }
 
 bool ButtonManager::isEnterHeld(unsigned long requiredHoldMs) {
-  if (!enterPressed) return false;
+  if (!pressed[BTN_ENTER]) return false;
   return (millis() - enterPressedAtMs) >= requiredHoldMs;
 }
 
-bool ButtonManager::pollUpEvent() {
-  if (upEventPending) {
-    upEventPending = false;
-    return true;
+bool ButtonManager::isBusy() {
+  for (int i = 0; i < BTN_COUNT; i++) {
+    if (pressed[i] || pendingEvents[i] > 0) {
+      return true;
+    }
   }
-  return false;
+  return buttonQueue && uxQueueMessagesWaiting(buttonQueue) > 0;
 }
 
-bool ButtonManager::pollDownEvent() {
-  if (downEventPending) {
-    downEventPending = false;
-    return true;
+unsigned long ButtonManager::getLastActivityMs() {
+  // Compare ages, not timestamps, so the result survives millis() rollover
+  unsigned long now = millis();
+  unsigned long latest = lastChangeMs[0];
+  for (int i = 1; i < BTN_COUNT; i++) {
+    if (now - lastChangeMs[i] < now - latest) {
+      latest = lastChangeMs[i];
+    }
   }
-  return false;
+  return latest;
 }
 
-bool ButtonManager::pollEnterEvent() {
-  if (enterEventPending) {
-    enterEventPending = false;
+void ButtonManager::enableWakeup() {
+  for (int i = 0; i < BTN_COUNT; i++) {
+    detachInterrupt(digitalPinToInterrupt(pins[i]));
+    gpio_wakeup_enable((gpio_num_t)pins[i], GPIO_INTR_LOW_LEVEL);
+  }
+}
+
+void ButtonManager::disableWakeup() {
+  for (int i = 0; i < BTN_COUNT; i++) {
+    gpio_wakeup_disable((gpio_num_t)pins[i]);
+  }
+  // The press that woke us has no queued edge; update() picks it up from
+  // the pin level once the debounce window has passed
+  attachInterrupt(digitalPinToInterrupt(BUTTON_UP), onUpEdge, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(BUTTON_DOWN), onDownEdge, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(BUTTON_ENTER), onEnterEdge, CHANGE);
+}
+
+bool ButtonManager::pollEvent(uint8_t button) {
+  if (pendingEvents[button] > 0) {
+    pendingEvents[button]--;
     return true;
   }
   return false;
 }
 
+bool ButtonManager::pollUpEvent() {
+  return pollEvent(BTN_UP);
+}
+
+bool ButtonManager::pollDownEvent() {
+  return pollEvent(BTN_DOWN);
+}
+
+bool ButtonManager::pollEnterEvent() {
+  return pollEvent(BTN_ENTER);
+}
+
+unsigned long ButtonManager::getDroppedEdges() {
+  return droppedEdges;
+}
+
 bool ButtonManager::readButton(int pin) {
   return digitalRead(pin);
-}
\ No newline at end of file
+}
@@ -8,55 +8,87 @@
 #define BUTTON_DEBUG 1
 #endif
 
+// Raw pin edge captured by the GPIO interrupt
+struct ButtonEdge {
+  uint8_t button;     // ButtonManager::ButtonId
+  uint8_t level;      // Pin level right after the edge
+  uint32_t timeMs;    // millis() at the edge
+};
+
+// Buttons are sampled by edge interrupts into a queue, so presses made while
+// the main loop is blocked (HTTP, BLE scan) are kept with their timestamps.
+// Debounce and auto-repeat run in update(), never in the ISR.
 class ButtonManager {
+public:
+  enum ButtonId {
+    BTN_UP,
+    BTN_DOWN,
+    BTN_ENTER,
+    BTN_COUNT
+  };
+
 private:
-  bool upPressed;
-  bool downPressed;
-  bool enterPressed;
-  
-  bool upLastState;
-  bool downLastState;
-  bool enterLastState;
-  
-  // Per-button debounce
-  unsigned long upLastDebounceTime;
-  unsigned long downLastDebounceTime;
-  unsigned long enterLastDebounceTime;
+  // Debounced state per button
+  bool pressed[BTN_COUNT];
+  unsigned long lastChangeMs[BTN_COUNT];  // Last accepted (debounced) edge
   unsigned long debounceDelay;
   unsigned long enterPressedAtMs;
-  
-  // Edge-triggered navigation events with auto-repeat
-  bool upEventPending;
-  bool downEventPending;
-  bool enterEventPending;
-  unsigned long upPressStartMs;
-  unsigned long downPressStartMs;
-  unsigned long upLastRepeatMs;
-  unsigned long downLastRepeatMs;
+
+  // Navigation events waiting to be polled, including auto-repeats
+  uint8_t pendingEvents[BTN_COUNT];
+  unsigned long pressStartMs[BTN_COUNT];
+  unsigned long lastRepeatMs[BTN_COUNT];
   unsigned long repeatStartDelayMs; // initial delay before repeat
   unsigned long repeatIntervalMs;   // repeat rate
-  
+
+  static const uint8_t pins[BTN_COUNT];
+  static const char* const names[BTN_COUNT];
+
 public:
   ButtonManager();
   bool begin();
   void update();
-  
+
+  // Sleeps until a button edge arrives or the timeout passes; use instead
+  // of delay() so input is handled as soon as it happens
+  void waitForInput(unsigned long timeoutMs);
+
   // Button state queries
   bool isUpPressed();
   bool isDownPressed();
   bool isEnterPressed();
   bool isEnterHeld(unsigned long requiredHoldMs);
-  
+
   // One-shot navigation events (includes auto-repeat)
   bool pollUpEvent();   // returns true once per click/repeat
   bool pollDownEvent(); // returns true once per click/repeat
   bool pollEnterEvent(); // returns true once per press (edge)
-  
+
+  // True while any button is down or has an unpolled event
+  bool isBusy();
+  unsigned long getLastActivityMs();
+
+  // Light-sleep wake on any button press; the edge ISRs are detached while
+  // armed because the wake trigger is level based
+  void enableWakeup();
+  void disableWakeup();
+
+  // Edges lost because the queue was full (state is resynced from the pins)
+  unsigned long getDroppedEdges();
+
 private:
+  static void IRAM_ATTR onUpEdge();
+  static void IRAM_ATTR onDownEdge();
+  static void IRAM_ATTR onEnterEdge();
+  static void IRAM_ATTR queueEdge(uint8_t button, uint8_t pin);
+
+  void applyLevel(uint8_t button, bool isPressed, unsigned long atMs);
+  void updateRepeat(uint8_t button, unsigned long now);
+  bool pollEvent(uint8_t button);
   bool readButton(int pin);
 };
 
 // Global button manager instance
 extern ButtonManager buttons;
 
-#endif // BUTTON_MANAGER_H
\ No newline at end of file
+#endif // BUTTON_MANAGER_H
@@ -0,0 +1,103 @@
+#include "capture.h"
+#include "log.h"
+
+static void putU32(uint8_t* out, uint32_t value) {
+  out[0] = (uint8_t)value;
+  out[1] = (uint8_t)(value >> 8);
+  out[2] = (uint8_t)(value >> 16);
+  out[3] = (uint8_t)(value >> 24);
+}
+
+size_t encodeCaptureHeader(uint8_t* out, uint32_t records, uint32_t recordBytes) {
+  memcpy(out, CAPTURE_MAGIC, 4);
+  out[4] = CAPTURE_VERSION;
+  out[5] = CAPTURE_HEADER_SIZE;
+  out[6] = 0;
+  out[7] = 0;
+  putU32(out + 8, records);
+  putU32(out + 12, recordBytes);
+  return CAPTURE_HEADER_SIZE;
+}
+
+size_t encodeCaptureRecord(uint8_t* out, uint32_t deltaUs, const uint8_t* address, int8_t rssi,
+                           const uint8_t* payload, size_t length) {
+  if (length > CAPTURE_MAX_PAYLOAD) {
+    length = CAPTURE_MAX_PAYLOAD;
+  }
+  putU32(out, deltaUs);
+  memcpy(out + 4, address, 6);
+  out[10] = (uint8_t)rssi;
+  out[11] = (uint8_t)length;
+  memcpy(out + CAPTURE_RECORD_HEADER, payload, length);
+  return CAPTURE_RECORD_HEADER + length;
+}
+
+#if CAPTURE_ENABLED
+
+CaptureBuffer captureBuffer;
+
+CaptureBuffer::CaptureBuffer() {
+  used = 0;
+  records = 0;
+  recording = false;
+  lastUs = 0;
+  dropped = 0;
+}
+
+void CaptureBuffer::start() {
+  recording = false;
+  used = 0;
+  records = 0;
+  dropped = 0;
+  lastUs = micros();
+  recording = true;
+  LOG_INFO("Capture started (%u bytes)", (unsigned)CAPTURE_BUFFER_SIZE);
+}
+
+void CaptureBuffer::stop() {
+  recording = false;
+  LOG_INFO("Capture stopped: %u records, %u bytes, %lu dropped",
+           (unsigned)records, (unsigned)used, dropped);
+}
+
+bool CaptureBuffer::isRecording() {
+  return recording;
+}
+
+void CaptureBuffer::record(const uint8_t* address, int8_t rssi, const uint8_t* payload, size_t length) {
+  if (!recording) {
+    return;
+  }
+  if (length > CAPTURE_MAX_PAYLOAD) {
+    length = CAPTURE_MAX_PAYLOAD;
+  }
+  if (used + CAPTURE_RECORD_HEADER + length > sizeof(data)) {
+    dropped++;
+    return;
+  }
+  uint32_t now = micros();
+  used += encodeCaptureRecord(data + used, now - lastUs, address, rssi, payload, length);
+  records++;
+  lastUs = now;
+}
+
+uint32_t CaptureBuffer::getRecords() {
+  return records;
+}
+
+size_t CaptureBuffer::getUsed() {
+  return used;
+}
+
+unsigned long CaptureBuffer::getDropped() {
+  return dropped;
+}
+
+void CaptureBuffer::dump(Print& out) {
+  uint8_t header[CAPTURE_HEADER_SIZE];
+  encodeCaptureHeader(header, records, (uint32_t)used);
+  out.write(header, sizeof(header));
+  out.write(data, used);
+}
+
+#endif // CAPTURE_ENABLED
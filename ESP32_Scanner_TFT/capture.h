@@ -0,0 +1,76 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include "hardware_config.h"
+
+// Binary capture of raw advertisements, for replaying real lecture-hall
+// traffic through BLEScanner off-device (host/ble_replay).
+//
+// File: 16-byte header, then one record per advertisement. All fields are
+// little endian.
+//   header: "BCAP" | u8 version | u8 header size | u16 0 | u32 records | u32 record bytes
+//   record: u32 us since previous record | u8 address[6] | i8 rssi | u8 length | payload
+#define CAPTURE_MAGIC          "BCAP"
+#define CAPTURE_VERSION        1
+#define CAPTURE_HEADER_SIZE    16
+#define CAPTURE_RECORD_HEADER  12
+#define CAPTURE_MAX_PAYLOAD    62
+
+// Encode into `out`, which must hold CAPTURE_HEADER_SIZE or
+// CAPTURE_RECORD_HEADER + length bytes; both return the bytes written
+size_t encodeCaptureHeader(uint8_t* out, uint32_t records, uint32_t recordBytes);
+size_t encodeCaptureRecord(uint8_t* out, uint32_t deltaUs, const uint8_t* address, int8_t rssi,
+                           const uint8_t* payload, size_t length);
+
+// Enable to record every advertisement the scanner receives into RAM. Send
+// 'r' over Serial to start or stop recording and 'c' to dump the capture
+// (header and records, raw binary). Disabled, CAPTURE_ADVERTISEMENT
+// compiles to nothing.
+#ifndef CAPTURE_ENABLED
+#define CAPTURE_ENABLED 0
+#endif
+
+#if CAPTURE_ENABLED
+
+// Written only from the BLE callback; the main loop stops recording before
+// it dumps. Recording stops when the buffer is full, keeping the start of
+// the session intact.
+class CaptureBuffer {
+private:
+  uint8_t data[CAPTURE_BUFFER_SIZE];
+  volatile size_t used;
+  volatile uint32_t records;
+  volatile bool recording;
+  uint32_t lastUs;
+  unsigned long dropped;
+
+public:
+  CaptureBuffer();
+
+  void start();
+  void stop();
+  bool isRecording();
+
+  void record(const uint8_t* address, int8_t rssi, const uint8_t* payload, size_t length);
+
+  uint32_t getRecords();
+  size_t getUsed();
+  unsigned long getDropped();
+
+  // Writes the capture file; recording must be stopped
+  void dump(Print& out);
+};
+
+extern CaptureBuffer captureBuffer;
+
+#define CAPTURE_ADVERTISEMENT(device) \
+  captureBuffer.record(*(device).getAddress().getNative(), (int8_t)(device).getRSSI(), \
+                       (device).getPayload(), (device).getPayloadLength())
+
+#else
+
+#define CAPTURE_ADVERTISEMENT(device) do {} while (0)
+
+#endif // CAPTURE_ENABLED
+
+#endif // CAPTURE_H
@@ -1,21 +1,48 @@
 #ifndef COMMON_TYPES_H
 #define COMMON_TYPES_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest device UUID kept from an advertisement (including terminator)
+#define DEVICE_UUID_SIZE 41
+
+// Text fields point into the EventManager's per-load arena and stay valid
+// until the next event reload.
 struct Event {
-  String id;
-  String name;
-  String description;
-  bool isActive;
-  String startDate;
-  String endDate;
+  const char* id = "";
+  const char* name = "";
+  const char* description = "";
+  bool isActive = false;
+  const char* startDate = "";
+  const char* endDate = "";
 };
 
-struct ScannedDevice {
-  String uuid;
-  String name;
-  int rssi;
-  String address;
-  unsigned long timestamp;
+// A change in a registered device's presence, as uploaded to /batch-checkin
+enum PresenceChange {
+  PRESENCE_ARRIVAL,
+  PRESENCE_DEPARTURE,
+  PRESENCE_DWELL      // Periodic summary while present, see PRESENCE_DWELL_REPORT_MS
 };
 
+struct PresenceEvent {
+  uint32_t timeMs;      // millis() the change applies to: arrival, or last seen for a departure
+  uint32_t detectedMs;  // millis() when the tracker noticed it
+  uint32_t dwellMs;     // Time present so far; 0 for arrivals
+  int16_t ordinal;      // Registered device index
+  int8_t rssi;          // Smoothed RSSI, dBm
+  uint8_t change;       // PresenceChange
+};
+
+// FNV-1a hash used to key device UUIDs in the scan buffer and the
+// registered-device index
+inline uint32_t hashDeviceUuid(const char* uuid, size_t len) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (uint8_t)uuid[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
 #endif // COMMON_TYPES_H
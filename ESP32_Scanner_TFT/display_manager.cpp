@@ -1,36 +1,101 @@
 #include "display_manager.h"
+#include "scanner_metrics.h"
+#include "trace.h"
+#include "log.h"
+#include "heap_monitor.h"
 #include <WiFi.h>
 
 // Global instance defined in ESP32_Scanner_TFT.ino
 
 DisplayManager::DisplayManager() : tft(TFT_CS, TFT_DC, TFT_RST) {
+  canvas = nullptr;
+  gfx = &tft;
+  flushTask = nullptr;
+  flushBusy = false;
+  flushX = flushY = flushW = flushH = 0;
+  frameDeferred = false;
   selectedIndex = 0;
   maxItems = 0;
   needsRefresh = true;
   lastUpdate = 0;
+  events = nullptr;
   eventCount = 0;
+  listScrollTop = 0;
+  drawnSelectedIndex = -1;
   currentState = STATE_LOADING;
   statusMessage = "";
   scanCount = 0;
+  scanPage = SCAN_PAGE_STATUS;
+  drawnScanPage = SCAN_PAGE_STATUS;
+  lastDashboardUpdate = 0;
+  lastAdvertisementsSeen = 0;
+  lastAdvertisementsMatched = 0;
+  advertisementRate = 0;
+  matchRate = 0;
+  drawnState = STATE_LOADING;
+  screenDirty = true;
+  listDirty = true;
+  listCleared = false;
+  animFrame = 0;
+  lastFrameMicros = 0;
+  maxFrameMicros = 0;
+  frameCount = 0;
+  lastFlushMicros = 0;
+  budgetOverruns = 0;
+  droppedFrames = 0;
 }
 
 bool DisplayManager::begin() {
-  Serial.println("Initializing TFT display...");
+  LOG_INFO("Initializing TFT display...");
   
   // Initialize TFT display
   tft.initR(INITR_BLACKTAB);
   tft.setRotation(1);         // Landscape orientation
   tft.fillScreen(COLOR_BLACK);
+  screenDirty = true;
+  
+  // Off-screen frame plus flush task; fall back to direct drawing if
+  // either cannot be created
+  canvas = new FrameCanvas(tft.width(), tft.height());
+  if (canvas && canvas->getBuffer()) {
+    BaseType_t created = xTaskCreatePinnedToCore(flushTaskEntry, "tft_flush", DISPLAY_FLUSH_TASK_STACK, this,
+                                                 DISPLAY_FLUSH_TASK_PRIORITY, &flushTask, DISPLAY_FLUSH_TASK_CORE);
+    if (created == pdPASS) {
+      gfx = canvas;
+    }
+  }
+  if (gfx != canvas) {
+    delete canvas;
+    canvas = nullptr;
+    LOG_WARN("Frame buffer unavailable, drawing directly to the panel");
+  }
   
-  Serial.println("TFT Display initialized successfully");
+  LOG_INFO("TFT Display initialized successfully");
   return true;
 }
 
 void DisplayManager::update() {
   unsigned long now = millis();
   
+  // The dashboard redraws on its own cadence
+  if (currentState == STATE_SCANNING && scanPage == SCAN_PAGE_DASHBOARD &&
+      now - lastDashboardUpdate >= DASHBOARD_REFRESH_MS) {
+    needsRefresh = true;
+  }
+  
   // Update display every 100ms to avoid flickering
   if (needsRefresh && (now - lastUpdate >= 100)) {
+    // The canvas is owned by the flush task until it finishes; skip this
+    // frame and let its changes go out with the next one
+    if (flushBusy) {
+      if (!frameDeferred) {
+        droppedFrames++;
+        frameDeferred = true;
+      }
+      return;
+    }
+    frameDeferred = false;
+    
     refresh();
     needsRefresh = false;
     lastUpdate = now;
@@ -38,6 +103,11 @@ void DisplayManager::update() {
 }
 
 void DisplayManager::navigateUp() {
+  if (currentState == STATE_SCANNING) {
+    scanPage = scanPage == SCAN_PAGE_STATUS ? SCAN_PAGE_DASHBOARD : SCAN_PAGE_STATUS;
+    needsRefresh = true;
+    return;
+  }
   if (selectedIndex > 0) {
     selectedIndex--;
     needsRefresh = true;
@@ -45,6 +115,10 @@ void DisplayManager::navigateUp() {
 }
 
 void DisplayManager::navigateDown() {
+  if (currentState == STATE_SCANNING) {
+    navigateUp(); // Two pages: both directions toggle
+    return;
+  }
   if (selectedIndex < maxItems - 1) {
     selectedIndex++;
     needsRefresh = true;
@@ -75,15 +149,13 @@ void DisplayManager::showLoading(const String& message) {
 
 void DisplayManager::showEventList(const Event* events, int count) {
   currentState = STATE_EVENT_LIST;
-  eventCount = count;
-  maxItems = count;
+  this->events = events;
+  eventCount = count < MAX_EVENTS ? count : MAX_EVENTS;
+  maxItems = eventCount;
   selectedIndex = 0;
+  listScrollTop = 0;
   
-  // Copy events
-  for (int i = 0; i < count && i < MAX_EVENTS; i++) {
-    this->events[i] = events[i];
-  }
-  
+  listDirty = true;
   needsRefresh = true;
 }
 
@@ -111,6 +183,71 @@ void DisplayManager::updateScanResults(int deviceCount) {
   needsRefresh = true;
 }
 
+unsigned long DisplayManager::getLastFrameMicros() {
+  return lastFrameMicros;
+}
+
+unsigned long DisplayManager::getMaxFrameMicros() {
+  return maxFrameMicros;
+}
+
+unsigned long DisplayManager::getFrameCount() {
+  return frameCount;
+}
+
+unsigned long DisplayManager::getLastFlushMicros() {
+  return lastFlushMicros;
+}
+
+unsigned long DisplayManager::getDroppedFrames() {
+  return droppedFrames;
+}
+
+unsigned long DisplayManager::getBudgetOverruns() {
+  return budgetOverruns;
+}
+
+bool DisplayManager::isFlushing() {
+  return flushBusy;
+}
+
+void DisplayManager::flushTaskEntry(void* param) {
+  DisplayManager* self = (DisplayManager*)param;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    self->flushRegion();
+  }
+}
+
+void DisplayManager::flushRegion() {
+  TRACE_SCOPE("display.flush");
+  unsigned long start = micros();
+  const uint16_t* buffer = canvas->getBuffer();
+  int16_t stride = canvas->width();
+  
+  // One address window for the whole rectangle, then stream it row by row
+  tft.startWrite();
+  tft.setAddrWindow(flushX, flushY, flushW, flushH);
+  for (int16_t row = 0; row < flushH; row++) {
+    tft.writePixels((uint16_t*)buffer + (flushY + row) * stride + flushX, flushW);
+  }
+  tft.endWrite();
+  
+  lastFlushMicros = micros() - start;
+  if (lastFrameMicros + lastFlushMicros > DISPLAY_FRAME_BUDGET_US) {
+    budgetOverruns++;
+  }
+  flushBusy = false;
+}
+
+void DisplayManager::startFlush() {
+  if (!canvas || !canvas->takeDirty(flushX, flushY, flushW, flushH)) {
+    return;
+  }
+  flushBusy = true;
+  xTaskNotifyGive(flushTask);
+}
+
 void DisplayManager::showAttendanceRecorded(const String& deviceName) {
   // Show a brief message that attendance was recorded
   statusMessage = "Recorded: " + deviceName;
@@ -118,6 +255,31 @@ void DisplayManager::showAttendanceRecorded(const String& deviceName) {
 }
 
 void DisplayManager::refresh() {
+  TRACE_SCOPE("display.render");
+  HeapScope heapScope(HEAP_DISPLAY);
+  unsigned long frameStart = micros();
+  
+  // Only a state change clears the panel; within a screen, widgets redraw
+  // their own rectangles when their content changes
+  if (currentState != drawnState ||
+      (currentState == STATE_SCANNING && scanPage != drawnScanPage)) {
+    screenDirty = true;
+  }
+  if (screenDirty) {
+    layoutScreen();
+    clearScreen();
+    for (int i = 0; i < WIDGET_COUNT; i++) {
+      widgets[i].invalidate();
+    }
+    listDirty = true;
+    listCleared = true;
+    drawnState = currentState;
+    drawnScanPage = scanPage;
+    screenDirty = false;
+  }
+  
+  animFrame = (animFrame + 1) % 4;
+  
   switch (currentState) {
     case STATE_WIFI_CONNECTING:
       drawWiFiConnecting();
@@ -135,198 +297,280 @@ void DisplayManager::refresh() {
       drawEventSelected();
       break;
     case STATE_SCANNING:
-      drawScanningScreen();
+      if (scanPage == SCAN_PAGE_DASHBOARD) {
+        drawDashboard();
+      } else {
+        drawScanningScreen();
+      }
       break;
     case STATE_ERROR:
       drawErrorScreen();
       break;
   }
+  
+  for (int i = 0; i < WIDGET_COUNT; i++) {
+    widgets[i].draw(*gfx);
+  }
+  
+  lastFrameMicros = micros() - frameStart;
+  if (lastFrameMicros > maxFrameMicros) {
+    maxFrameMicros = lastFrameMicros;
+  }
+  frameCount++;
+  
+  startFlush();
 }
 
 void DisplayManager::clearScreen() {
-  tft.fillScreen(COLOR_BLACK);
+  gfx->fillScreen(COLOR_BLACK);
+  
+  // Line under title is static for every screen
+  gfx->drawLine(LEFT_MARGIN, TITLE_Y + 8, SCREEN_WIDTH - RIGHT_MARGIN, TITLE_Y + 8, COLOR_WHITE);
 }
 
-void DisplayManager::drawTitle(const String& title) {
-  tft.setTextColor(COLOR_WHITE);
-  tft.setTextSize(1);
-  tft.setCursor(LEFT_MARGIN, TITLE_Y);
-  tft.print(title);
+void DisplayManager::placeLine(WidgetSlot slot, int16_t y, int16_t height, uint8_t size, uint16_t color) {
+  widgets[slot].place(0, y, tft.width(), height, LEFT_MARGIN, y, size);
+  widgets[slot].setColors(color, COLOR_BLACK);
+}
+
+void DisplayManager::layoutScreen() {
+  for (int i = WIDGET_LINE1; i <= WIDGET_LINE6; i++) {
+    widgets[i].hide();
+  }
+  placeLine(WIDGET_TITLE, TITLE_Y, 8, 1, COLOR_WHITE);
+  placeLine(WIDGET_STATUS, STATUS_Y, tft.height() - STATUS_Y, 1, COLOR_YELLOW);
   
-  // Draw line under title
-  tft.drawLine(LEFT_MARGIN, TITLE_Y + 8, SCREEN_WIDTH - RIGHT_MARGIN, TITLE_Y + 8, COLOR_WHITE);
+  // Message lines get two text rows so long messages can wrap
+  switch (currentState) {
+    case STATE_WIFI_CONNECTING:
+      placeLine(WIDGET_LINE1, 40, 16, 1, COLOR_CYAN);
+      placeLine(WIDGET_LINE2, 56, 8, 1, COLOR_CYAN);
+      break;
+    case STATE_WIFI_CONNECTED:
+      placeLine(WIDGET_LINE1, 40, 16, 1, COLOR_GREEN);
+      placeLine(WIDGET_LINE2, 60, 8, 1, COLOR_CYAN);
+      break;
+    case STATE_LOADING:
+      placeLine(WIDGET_LINE1, 40, 16, 1, COLOR_CYAN);
+      placeLine(WIDGET_LINE2, 56, 8, 1, COLOR_CYAN);
+      placeLine(WIDGET_LINE3, 70, 8, 1, COLOR_GREEN);
+      placeLine(WIDGET_LINE4, 85, 8, 1, COLOR_CYAN);
+      break;
+    case STATE_EVENT_LIST:
+      break;
+    case STATE_EVENT_SELECTED:
+      placeLine(WIDGET_LINE1, 40, 16, 1, COLOR_GREEN);
+      placeLine(WIDGET_LINE2, 60, 16, 1, COLOR_CYAN);
+      break;
+    case STATE_SCANNING:
+      if (scanPage == SCAN_PAGE_DASHBOARD) {
+        for (int i = 0; i < 6; i++) {
+          placeLine((WidgetSlot)(WIDGET_LINE1 + i), MENU_START_Y + i * LINE_HEIGHT, 8, 1, COLOR_CYAN);
+        }
+        break;
+      }
+      placeLine(WIDGET_LINE1, 40, 16, 2, COLOR_GREEN);
+      widgets[WIDGET_LINE1].place(0, 40, tft.width(), 16, LEFT_MARGIN + 20, 40, 2);
+      placeLine(WIDGET_LINE2, 65, 8, 1, COLOR_CYAN);
+      placeLine(WIDGET_LINE3, 80, 15, 1, COLOR_WHITE);
+      placeLine(WIDGET_LINE4, 95, 8, 1, COLOR_YELLOW);
+      break;
+    case STATE_ERROR:
+      placeLine(WIDGET_LINE1, 40, 16, 1, COLOR_RED);
+      placeLine(WIDGET_LINE2, 60, 8, 1, COLOR_CYAN);
+      break;
+  }
+}
+
+void DisplayManager::drawTitle(const String& title) {
+  widgets[WIDGET_TITLE].setText(title);
 }
 
 void DisplayManager::drawStatus(const String& status) {
-  tft.setTextColor(COLOR_YELLOW);
-  tft.setTextSize(1);
-  tft.setCursor(LEFT_MARGIN, STATUS_Y);
-  tft.print(status);
+  widgets[WIDGET_STATUS].setText(status);
+}
+
+String DisplayManager::animationDots() {
+  static const char* const dots[] = {".", "..", "...", "...."};
+  return dots[animFrame];
 }
 
 void DisplayManager::drawWiFiConnecting() {
-  clearScreen();
   drawTitle("WiFi Connection");
-  
-  tft.setTextColor(COLOR_CYAN);
-  tft.setTextSize(1);
-  tft.setCursor(LEFT_MARGIN, 40);
-  tft.print(statusMessage);
-  
-  // Draw connecting animation
-  static int animFrame = 0;
-  animFrame = (animFrame + 1) % 4;
-  
-  String dots = "";
-  for (int i = 0; i < animFrame + 1; i++) {
-    dots += ".";
-  }
-  
-  tft.setCursor(LEFT_MARGIN, 55);
-  tft.print("Connecting" + dots);
-  
+  widgets[WIDGET_LINE1].setText(statusMessage);
+  widgets[WIDGET_LINE2].setText("Connecting" + animationDots());
   drawStatus("Please wait");
 }
 
 void DisplayManager::drawWiFiConnected() {
-  clearScreen();
   drawTitle("WiFi Connected");
-  
-  tft.setTextColor(COLOR_GREEN);
-  tft.setTextSize(1);
-  tft.setCursor(LEFT_MARGIN, 40);
-  tft.print(statusMessage);
-  
-  tft.setTextColor(COLOR_CYAN);
-  tft.setCursor(LEFT_MARGIN, 60);
-  tft.print("Loading events...");
-  
+  widgets[WIDGET_LINE1].setText(statusMessage);
+  widgets[WIDGET_LINE2].setText("Loading events...");
   drawStatus("Connected");
 }
 
 void DisplayManager::drawLoadingScreen() {
-  clearScreen();
   drawTitle("Loading");
+  widgets[WIDGET_LINE1].setText(statusMessage);
+  widgets[WIDGET_LINE2].setText("Loading" + animationDots());
   
-  tft.setTextColor(COLOR_CYAN);
-  tft.setTextSize(1);
-  tft.setCursor(LEFT_MARGIN, 40);
-  tft.print(statusMessage);
+  // Show WiFi status
+  bool connected = WiFi.status() == WL_CONNECTED;
+  widgets[WIDGET_LINE3].setColors(connected ? COLOR_GREEN : COLOR_RED, COLOR_BLACK);
+  widgets[WIDGET_LINE3].setText(connected ? "WiFi: Connected" : "WiFi: Disconnected");
+  widgets[WIDGET_LINE4].setText(connected ? "IP: " + WiFi.localIP().toString() : String(""));
   
-  // Draw loading animation (spinning dots)
-  static int animFrame = 0;
-  animFrame = (animFrame + 1) % 4;
+  drawStatus("Please wait");
+}
+
+void DisplayManager::drawEventList() {
+  drawTitle("Select Event");
+  drawStatus("UP/DOWN: Navigate, ENTER: Select");
   
-  String dots = "";
-  for (int i = 0; i < animFrame + 1; i++) {
-    dots += ".";
+  // Keep the selection inside the MAX_MENU_ITEMS-row window
+  int oldTop = listScrollTop;
+  if (selectedIndex < listScrollTop) {
+    listScrollTop = selectedIndex;
+  } else if (selectedIndex >= listScrollTop + MAX_MENU_ITEMS) {
+    listScrollTop = selectedIndex - MAX_MENU_ITEMS + 1;
   }
+  int shift = listScrollTop - oldTop;
   
-  tft.setCursor(LEFT_MARGIN, 55);
-  tft.print("Loading" + dots);
+  if (!listDirty && shift == 0 && selectedIndex == drawnSelectedIndex) {
+    return;
+  }
   
-  // Show WiFi status
-  tft.setTextColor(WiFi.status() == WL_CONNECTED ? COLOR_GREEN : COLOR_RED);
-  tft.setCursor(LEFT_MARGIN, 70);
-  tft.print("WiFi: " + String(WiFi.status() == WL_CONNECTED ? "Connected" : "Disconnected"));
+  int listTop = MENU_START_Y - 2;
+  int listHeight = MAX_MENU_ITEMS * LINE_HEIGHT;
   
-  if (WiFi.status() == WL_CONNECTED) {
-    tft.setTextColor(COLOR_CYAN);
-    tft.setCursor(LEFT_MARGIN, 85);
-    tft.print("IP: " + WiFi.localIP().toString());
+  if (!listDirty && shift != 0 && abs(shift) < MAX_MENU_ITEMS && canvas) {
+    // Scroll: move the rows already rendered, then draw the ones that
+    // came into view plus the old and new highlight
+    canvas->scrollRows(listTop, listHeight, -shift * LINE_HEIGHT);
+    int first = shift > 0 ? listScrollTop + MAX_MENU_ITEMS - shift : listScrollTop;
+    for (int i = first; i < first + abs(shift); i++) {
+      drawEventRow(i);
+    }
+    drawEventRow(drawnSelectedIndex);
+    drawEventRow(selectedIndex);
+  } else if (!listDirty && shift == 0) {
+    // Selection moved within the window: only two rows change
+    drawEventRow(drawnSelectedIndex);
+    drawEventRow(selectedIndex);
+  } else {
+    // New list, new screen, or a jump larger than the window
+    if (!listCleared) {
+      gfx->fillRect(0, listTop, gfx->width(), listHeight, COLOR_BLACK);
+    }
+    for (int i = listScrollTop; i < listScrollTop + MAX_MENU_ITEMS; i++) {
+      drawEventRow(i);
+    }
   }
   
-  drawStatus("Please wait");
+  listDirty = false;
+  listCleared = false;
+  drawnSelectedIndex = selectedIndex;
+  drawListScrollbar();
 }
 
-void DisplayManager::drawEventList() {
-  clearScreen();
-  drawTitle("Select Event");
+void DisplayManager::drawEventRow(int index) {
+  // Rows outside the window (or past the end of the list) are not drawn
+  if (index < listScrollTop || index >= listScrollTop + MAX_MENU_ITEMS || index >= eventCount) {
+    return;
+  }
   
-  // Draw event list
-  for (int i = 0; i < eventCount && i < MAX_EVENTS; i++) {
-    int y = MENU_START_Y + (i * LINE_HEIGHT);
-    
-    if (i == selectedIndex) {
-      // Highlight selected item
-      tft.fillRect(LEFT_MARGIN, y - 2, SCREEN_WIDTH - LEFT_MARGIN - RIGHT_MARGIN, LINE_HEIGHT, COLOR_BLUE);
-      tft.setTextColor(COLOR_WHITE);
-    } else {
-      tft.setTextColor(COLOR_CYAN);
-    }
-    
-    tft.setCursor(LEFT_MARGIN + 5, y);
-    tft.print(events[i].name);
+  int y = MENU_START_Y + ((index - listScrollTop) * LINE_HEIGHT);
+  int rowWidth = SCREEN_WIDTH - LEFT_MARGIN - RIGHT_MARGIN;
+  
+  if (index == selectedIndex) {
+    // Highlight selected item
+    gfx->fillRect(LEFT_MARGIN, y - 2, rowWidth, LINE_HEIGHT, COLOR_BLUE);
+    gfx->setTextColor(COLOR_WHITE);
+  } else {
+    gfx->fillRect(LEFT_MARGIN, y - 2, rowWidth, LINE_HEIGHT, COLOR_BLACK);
+    gfx->setTextColor(COLOR_CYAN);
   }
   
-  drawStatus("UP/DOWN: Navigate, ENTER: Select");
+  // Clip long names to the row instead of wrapping into the next one
+  const char* name = events[index].name;
+  size_t maxChars = (rowWidth - 5) / 6;
+  size_t length = strlen(name);
+  gfx->setTextSize(1);
+  gfx->setCursor(LEFT_MARGIN + 5, y);
+  gfx->write((const uint8_t*)name, length < maxChars ? length : maxChars);
 }
 
-void DisplayManager::drawEventSelected() {
-  clearScreen();
-  drawTitle("Event Selected");
-  
-  tft.setTextColor(COLOR_GREEN);
-  tft.setTextSize(1);
-  tft.setCursor(LEFT_MARGIN, 40);
-  tft.print(statusMessage);
+void DisplayManager::drawListScrollbar() {
+  if (eventCount <= MAX_MENU_ITEMS) {
+    return;
+  }
   
-  tft.setTextColor(COLOR_CYAN);
-  tft.setCursor(LEFT_MARGIN, 60);
-  tft.print("Press ENTER to start scanning");
+  // Thin track in the right margin with a thumb sized to the window
+  int trackX = SCREEN_WIDTH - RIGHT_MARGIN + 1;
+  int trackY = MENU_START_Y - 2;
+  int trackHeight = MAX_MENU_ITEMS * LINE_HEIGHT;
+  int thumbHeight = max(4, trackHeight * MAX_MENU_ITEMS / eventCount);
+  int thumbY = trackY + (trackHeight - thumbHeight) * listScrollTop / (eventCount - MAX_MENU_ITEMS);
   
+  gfx->fillRect(trackX, trackY, 2, trackHeight, COLOR_BLACK);
+  gfx->fillRect(trackX, thumbY, 2, thumbHeight, COLOR_CYAN);
+}
+
+void DisplayManager::drawEventSelected() {
+  drawTitle("Event Selected");
+  widgets[WIDGET_LINE1].setText(statusMessage);
+  widgets[WIDGET_LINE2].setText("Press ENTER to start scanning");
   drawStatus("Ready to scan");
 }
 
 void DisplayManager::drawScanningScreen() {
-  clearScreen();
   drawTitle("Scanning");
+  widgets[WIDGET_LINE1].setText("Scan" + animationDots());
+  widgets[WIDGET_LINE2].setText("Devices found: " + String(scanCount));
+  widgets[WIDGET_LINE3].setText(statusMessage);
+  widgets[WIDGET_LINE4].setText("Looking for ATT- devices");
+  drawStatus("ENTER: Stop scanning");
+}
+
+void DisplayManager::drawDashboard() {
+  unsigned long now = millis();
   
-  // Draw scanning animation
-  static int animFrame = 0;
-  animFrame = (animFrame + 1) % 4;
-  
-  tft.setTextColor(COLOR_GREEN);
-  tft.setTextSize(2);
-  tft.setCursor(LEFT_MARGIN + 20, 40);
-  
-  String dots = "";
-  for (int i = 0; i < animFrame + 1; i++) {
-    dots += ".";
+  // Rates over the last dashboard period; other refreshes reuse them
+  unsigned long elapsed = now - lastDashboardUpdate;
+  if (elapsed >= DASHBOARD_REFRESH_MS) {
+    uint32_t seen = scannerMetrics.advertisementsSeen;
+    uint32_t matched = scannerMetrics.advertisementsMatched;
+    if (lastDashboardUpdate != 0) {
+      advertisementRate = (seen - lastAdvertisementsSeen) * 1000.0f / elapsed;
+      matchRate = (matched - lastAdvertisementsMatched) * 1000.0f / elapsed;
+    }
+    lastAdvertisementsSeen = seen;
+    lastAdvertisementsMatched = matched;
+    lastDashboardUpdate = now;
   }
-  tft.print("Scan" + dots);
   
-  // Draw device count
-  tft.setTextColor(COLOR_CYAN);
-  tft.setTextSize(1);
-  tft.setCursor(LEFT_MARGIN, 65);
-  tft.print("Devices found: " + String(scanCount));
-  
-  // Draw event info
-  tft.setTextColor(COLOR_WHITE);
-  tft.setCursor(LEFT_MARGIN, 80);
-  tft.print(statusMessage);
-  
-  // Draw scanning status
-  tft.setTextColor(COLOR_YELLOW);
-  tft.setCursor(LEFT_MARGIN, 95);
-  tft.print("Looking for ATT- devices");
-  
-  drawStatus("ENTER: Stop scanning");
+  // Fixed label columns so only the changing digits are redrawn
+  char line[WIDGET_TEXT_SIZE];
+  drawTitle("Dashboard");
+  snprintf(line, sizeof(line), "Adv/s:   %7.1f", advertisementRate);
+  widgets[WIDGET_LINE1].setText(line);
+  snprintf(line, sizeof(line), "Match/s: %7.1f", matchRate);
+  widgets[WIDGET_LINE2].setText(line);
+  snprintf(line, sizeof(line), "Present: %5d", scannerMetrics.studentsPresent);
+  widgets[WIDGET_LINE3].setText(line);
+  snprintf(line, sizeof(line), "Pending: %5d", scannerMetrics.uploadPending);
+  widgets[WIDGET_LINE4].setText(line);
+  snprintf(line, sizeof(line), "Upload:  %5lu ms", (unsigned long)scannerMetrics.lastUploadMs);
+  widgets[WIDGET_LINE5].setText(line);
+  snprintf(line, sizeof(line), "Heap: %3luK max %3luK",
+           (unsigned long)(ESP.getFreeHeap() / 1024), (unsigned long)(ESP.getMaxAllocHeap() / 1024));
+  widgets[WIDGET_LINE6].setText(line);
+  drawStatus("UP/DOWN: Page ENTER: Stop");
 }
 
 void DisplayManager::drawErrorScreen() {
-  clearScreen();
   drawTitle("Error");
-  
-  tft.setTextColor(COLOR_RED);
-  tft.setTextSize(1);
-  tft.setCursor(LEFT_MARGIN, 40);
-  tft.print(statusMessage);
-  
-  tft.setTextColor(COLOR_CYAN);
-  tft.setCursor(LEFT_MARGIN, 60);
-  tft.print("Press ENTER to retry");
-  
+  widgets[WIDGET_LINE1].setText(statusMessage);
+  widgets[WIDGET_LINE2].setText("Press ENTER to retry");
   drawStatus("System error");
-}
\ No newline at end of file
+}
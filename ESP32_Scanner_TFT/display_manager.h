@@ -3,18 +3,31 @@
 
 #include "hardware_config.h"
 #include "common_types.h"
+#include "display_widget.h"
+#include "frame_canvas.h"
 
 class DisplayManager {
 private:
   Adafruit_ST7735 tft;
+  
+  // Frames are drawn into the canvas and pushed to the panel by a
+  // background task; without a canvas, drawing goes straight to the panel
+  FrameCanvas* canvas;
+  Adafruit_GFX* gfx;
+  TaskHandle_t flushTask;
+  volatile bool flushBusy;
+  int16_t flushX, flushY, flushW, flushH;
+  bool frameDeferred;
   int selectedIndex;
   int maxItems;
   bool needsRefresh;
   unsigned long lastUpdate;
   
-  // Event list
-  Event events[MAX_EVENTS];
+  // Event list (borrowed from EventManager; only the rows in view are drawn)
+  const Event* events;
   int eventCount;
+  int listScrollTop;       // Index of the first visible row
+  int drawnSelectedIndex;  // Highlighted row currently on screen, -1 = none
   
   // Display states
   enum DisplayState {
@@ -31,6 +44,49 @@ private:
   String statusMessage;
   int scanCount;
   
+  // Pages while scanning, switched with UP/DOWN
+  enum ScanPage {
+    SCAN_PAGE_STATUS,
+    SCAN_PAGE_DASHBOARD
+  };
+  ScanPage scanPage;
+  ScanPage drawnScanPage;
+  
+  // Dashboard rates, recomputed every DASHBOARD_REFRESH_MS
+  unsigned long lastDashboardUpdate;
+  uint32_t lastAdvertisementsSeen;
+  uint32_t lastAdvertisementsMatched;
+  float advertisementRate;
+  float matchRate;
+  
+  // Retained layout: each screen fills these labels and only the ones
+  // whose content changed are redrawn
+  enum WidgetSlot {
+    WIDGET_TITLE,
+    WIDGET_LINE1,
+    WIDGET_LINE2,
+    WIDGET_LINE3,
+    WIDGET_LINE4,
+    WIDGET_LINE5,
+    WIDGET_LINE6,
+    WIDGET_STATUS,
+    WIDGET_COUNT
+  };
+  TextWidget widgets[WIDGET_COUNT];
+  DisplayState drawnState;
+  bool screenDirty;   // Full clear needed (state change or first frame)
+  bool listDirty;     // Every visible event row needs redrawing
+  bool listCleared;   // List area is already blank (just after a full clear)
+  int animFrame;
+  
+  // Frame statistics
+  unsigned long lastFrameMicros;
+  unsigned long maxFrameMicros;
+  unsigned long frameCount;
+  volatile unsigned long lastFlushMicros;
+  volatile unsigned long budgetOverruns;
+  unsigned long droppedFrames;
+  
 public:
   DisplayManager();
   bool begin();
@@ -54,14 +110,32 @@ public:
   void updateScanResults(int deviceCount);
   void showAttendanceRecorded(const String& deviceName);
   
+  // Frame statistics
+  unsigned long getLastFrameMicros();
+  unsigned long getMaxFrameMicros();
+  unsigned long getFrameCount();
+  unsigned long getLastFlushMicros();
+  unsigned long getDroppedFrames();
+  unsigned long getBudgetOverruns();
+  bool isFlushing();
+  
 private:
+  static void flushTaskEntry(void* param);
+  void flushRegion();
+  void startFlush();
   void refresh();
   void clearScreen();
+  void layoutScreen();
+  void placeLine(WidgetSlot slot, int16_t y, int16_t height, uint8_t size, uint16_t color);
   void drawTitle(const String& title);
   void drawStatus(const String& status);
+  String animationDots();
   void drawEventList();
+  void drawEventRow(int index);
+  void drawListScrollbar();
   void drawEventSelected();
   void drawScanningScreen();
+  void drawDashboard();
   void drawErrorScreen();
   void drawLoadingScreen();
   void drawWiFiConnecting();
@@ -0,0 +1,160 @@
+#include "display_widget.h"
+
+TextWidget::TextWidget() {
+  x = y = w = h = 0;
+  cursorX = cursorY = 0;
+  textSize = 1;
+  color = COLOR_WHITE;
+  background = COLOR_BLACK;
+  text[0] = '\0';
+  dirty = false;
+  needsClear = false;
+  drawnWidth = 0;
+  drawnHeight = 0;
+  keptChars = 0;
+}
+
+void TextWidget::place(int16_t boundsX, int16_t boundsY, int16_t boundsW, int16_t boundsH,
+                       int16_t textX, int16_t textY, uint8_t size) {
+  x = boundsX;
+  y = boundsY;
+  w = boundsW;
+  h = boundsH;
+  cursorX = textX;
+  cursorY = textY;
+  textSize = size;
+  dirty = true;
+  needsClear = true;
+  drawnWidth = boundsW;
+  drawnHeight = boundsH;
+  keptChars = 0;
+}
+
+void TextWidget::hide() {
+  h = 0;
+  text[0] = '\0';
+  dirty = false;
+}
+
+void TextWidget::setText(const char* value) {
+  if (!value) {
+    value = "";
+  }
+  if (strncmp(text, value, sizeof(text) - 1) == 0) {
+    return;
+  }
+  
+  // Characters shared with what is on the panel do not need redrawing
+  uint8_t common = 0;
+  while (common < keptChars && text[common] == value[common]) {
+    common++;
+  }
+  keptChars = common;
+  
+  strncpy(text, value, sizeof(text) - 1);
+  text[sizeof(text) - 1] = '\0';
+  dirty = true;
+  needsClear = true;
+}
+
+void TextWidget::setText(const String& value) {
+  setText(value.c_str());
+}
+
+void TextWidget::setColors(uint16_t foreground, uint16_t backgroundColor) {
+  if (foreground != color || backgroundColor != background) {
+    keptChars = 0;
+    if (backgroundColor != background) {
+      // The whole rectangle changes color, not just the old text
+      drawnWidth = w;
+      drawnHeight = h;
+    }
+    color = foreground;
+    background = backgroundColor;
+    dirty = true;
+    needsClear = true;
+  }
+}
+
+void TextWidget::invalidate() {
+  dirty = h > 0;
+  needsClear = false;
+  drawnWidth = 0;
+  drawnHeight = 0;
+  keptChars = 0;
+}
+
+bool TextWidget::isDirty() const {
+  return dirty;
+}
+
+size_t TextWidget::visibleLength(Adafruit_GFX& gfx, int16_t& width, int16_t& height) const {
+  // Text wraps to x = 0 on the next line; only count what fits inside the
+  // bounds so nothing is ever drawn outside the rectangle we clear
+  int charWidth = 6 * textSize;
+  int lineHeight = 8 * textSize;
+  int lines = (y + h - cursorY) / lineHeight;
+  if (lines < 1) {
+    lines = 1;
+  }
+  size_t firstLine = (gfx.width() - cursorX) / charWidth;
+  size_t maxChars = firstLine + (lines - 1) * (gfx.width() / charWidth);
+  size_t length = strlen(text);
+  if (length > maxChars) {
+    length = maxChars;
+  }
+
+  if (length <= firstLine) {
+    width = length * charWidth;
+    height = length > 0 ? lineHeight : 0;
+  } else {
+    // Wrapped text: treat the whole bounds as covered
+    width = w;
+    height = h;
+  }
+  return length;
+}
+
+bool TextWidget::draw(Adafruit_GFX& gfx) {
+  if (!dirty || h <= 0) {
+    return false;
+  }
+  dirty = false;
+
+  int16_t width, height;
+  size_t length = visibleLength(gfx, width, height);
+  int charWidth = 6 * textSize;
+  int lineHeight = 8 * textSize;
+
+  // Partial update only when old and new text both sit on a single line
+  size_t keep = keptChars;
+  if (drawnHeight > lineHeight || height > lineHeight || keep > length) {
+    keep = 0;
+  }
+  int16_t keepWidth = keep * charWidth;
+
+  // Clear only what the previous text covered past the unchanged prefix
+  if (needsClear && drawnWidth > keepWidth && drawnHeight > 0) {
+    if (drawnWidth >= w) {
+      gfx.fillRect(x, y, w, h, background);
+      keep = 0;
+      keepWidth = 0;
+    } else {
+      gfx.fillRect(cursorX + keepWidth, cursorY, drawnWidth - keepWidth, drawnHeight, background);
+    }
+  }
+  needsClear = false;
+  drawnWidth = width;
+  drawnHeight = height;
+  keptChars = length < 255 ? length : 255;
+
+  if (length <= keep) {
+    return true;
+  }
+
+  gfx.setTextSize(textSize);
+  gfx.setTextColor(color);
+  gfx.setCursor(cursorX + keepWidth, cursorY);
+  gfx.write((const uint8_t*)text + keep, length - keep);
+  return true;
+}
@@ -0,0 +1,47 @@
+#ifndef DISPLAY_WIDGET_H
+#define DISPLAY_WIDGET_H
+
+#include "hardware_config.h"
+
+// A text label that owns a screen rectangle. Setting the same text or
+// colors again is a no-op, so callers can re-apply their whole layout on
+// every refresh and only labels that actually changed reach the panel.
+class TextWidget {
+private:
+  int16_t x, y, w, h;          // Bounds cleared on redraw
+  int16_t cursorX, cursorY;    // Text origin inside the bounds
+  uint8_t textSize;
+  uint16_t color;
+  uint16_t background;
+  char text[WIDGET_TEXT_SIZE];
+  bool dirty;
+  bool needsClear;             // Old text is still on the panel
+  int16_t drawnWidth;          // Extent of the text currently on the panel
+  int16_t drawnHeight;
+  uint8_t keptChars;           // Leading characters unchanged since last draw
+
+  size_t visibleLength(Adafruit_GFX& gfx, int16_t& width, int16_t& height) const;
+
+public:
+  TextWidget();
+
+  // Layout; a zero height hides the widget
+  void place(int16_t boundsX, int16_t boundsY, int16_t boundsW, int16_t boundsH,
+             int16_t textX, int16_t textY, uint8_t size);
+  void hide();
+
+  // Content; each marks the widget dirty only when something changed
+  void setText(const char* value);
+  void setText(const String& value);
+  void setColors(uint16_t foreground, uint16_t backgroundColor);
+
+  // Force a redraw after the screen underneath was cleared
+  void invalidate();
+  bool isDirty() const;
+
+  // Clears the previous text extent and redraws if dirty; returns true
+  // if anything was sent to the panel
+  bool draw(Adafruit_GFX& gfx);
+};
+
+#endif // DISPLAY_WIDGET_H
@@ -1,4 +1,7 @@
 #include "event_manager.h"
+#include "trace.h"
+#include "log.h"
+#include "heap_monitor.h"
 #include <ArduinoJson.h>
 
 // Global instance defined in ESP32_Scanner_TFT.ino
@@ -8,37 +11,44 @@ EventManager::EventManager() {
   selectedEventIndex = -1;
   selectedEventId = "";
   selectedEventName = "";
+  registeredDevices = nullptr;
+  registeredHashes = nullptr;
+  registeredIndex = nullptr;
+  registeredIndexMask = 0;
+  registeredDeviceCount = 0;
   devicesLoaded = false;
+  registrationGeneration = 0;
 }
 
 void EventManager::begin() {
   clearEvents();
   clearRegisteredDevices();
-  Serial.println("Event Manager initialized");
+  LOG_INFO("Event Manager initialized");
 }
 
 bool EventManager::loadFromBackend(BackendClient& backend) {
+  HeapScope heapScope(HEAP_EVENTS);
   if (!backend.isConnected()) {
-    Serial.println("Backend not connected, cannot load events");
+    LOG_ERROR("Backend not connected, cannot load events");
     return false;
   }
   
   clearEvents();
   
-  Event tempEvents[MAX_EVENTS];
+  // Parse straight into the event table; text is copied into eventArena
   int count = 0;
-  
-  if (!backend.getEvents(tempEvents, count, MAX_EVENTS)) {
-    Serial.println("Failed to load events from backend: " + backend.getLastError());
+  if (!backend.getEvents(events, count, MAX_EVENTS, eventArena)) {
+    LOG_ERROR("Failed to load events from backend: %s", backend.getLastError().c_str());
+    clearEvents();
     return false;
   }
+  eventCount = count;
   
-  // Add events to manager
-  for (int i = 0; i < count; i++) {
-    addEvent(tempEvents[i]);
+  LOG_INFO("Loaded %d events from backend", eventCount);
+  if (eventArena.getOverflowCount() > 0) {
+    LOG_WARN("Event arena overflowed %lu time(s), some text truncated",
+             eventArena.getOverflowCount());
   }
-  
-  Serial.println("Loaded " + String(eventCount) + " events from backend");
   return true;
 }
 
@@ -62,7 +72,7 @@ void EventManager::addTestEvents() {
   testEvent2.endDate = "2024-12-31";
   addEvent(testEvent2);
   
-  Serial.println("Added " + String(eventCount) + " test events");
+  LOG_INFO("Added %d test events", eventCount);
 }
 
 bool EventManager::loadActiveEvents(BackendClient& backend) {
@@ -71,7 +81,7 @@ bool EventManager::loadActiveEvents(BackendClient& backend) {
 
 bool EventManager::selectEvent(int index) {
   if (index < 0 || index >= eventCount) {
-    Serial.println("Invalid event index: " + String(index));
+    LOG_ERROR("Invalid event index: %d", index);
     return false;
   }
   
@@ -82,18 +92,18 @@ bool EventManager::selectEvent(int index) {
   // Clear previously loaded devices when selecting a new event
   clearRegisteredDevices();
   
-  Serial.println("Selected event: " + selectedEventName + " (ID: " + selectedEventId + ")");
+  LOG_INFO("Selected event: %s (ID: %s)", selectedEventName.c_str(), selectedEventId.c_str());
   return true;
 }
 
 bool EventManager::selectEventById(const String& eventId) {
   for (int i = 0; i < eventCount; i++) {
-    if (events[i].id == eventId) {
+    if (strcmp(events[i].id, eventId.c_str()) == 0) {
       return selectEvent(i);
     }
   }
   
-  Serial.println("Event not found: " + eventId);
+  LOG_ERROR("Event not found: %s", eventId.c_str());
   return false;
 }
 
@@ -126,7 +136,7 @@ Event* EventManager::getEvent(int index) {
 
 Event* EventManager::getEventById(const String& eventId) {
   for (int i = 0; i < eventCount; i++) {
-    if (events[i].id == eventId) {
+    if (strcmp(events[i].id, eventId.c_str()) == 0) {
       return &events[i];
     }
   }
@@ -134,73 +144,160 @@ Event* EventManager::getEventById(const String& eventId) {
 }
 
 bool EventManager::loadRegisteredDevices(BackendClient& backend) {
+  HeapScope heapScope(HEAP_EVENTS);
   if (selectedEventId.length() == 0) {
-    Serial.println("No event selected, cannot load registered devices");
+    LOG_ERROR("No event selected, cannot load registered devices");
     return false;
   }
   
-  Serial.println("Loading registered devices for event: " + selectedEventId);
+  LOG_INFO("Loading registered devices for event: %s", selectedEventId.c_str());
   
   // Make request to backend
   String endpoint = "registered-devices?eventId=" + selectedEventId;
   String response;
   
   if (!backend.makeRequest(endpoint, "GET", "", response)) {
-    Serial.println("Failed to load registered devices: " + backend.getLastError());
+    LOG_ERROR("Failed to load registered devices: %s", backend.getLastError().c_str());
     return false;
   }
   
-  // Parse JSON response
+  return parseRegisteredDevices(response.c_str(), response.length());
+}
+
+bool EventManager::parseRegisteredDevices(const char* json, size_t length) {
+  TRACE_BEGIN("json.devices");
   JsonDocument doc;
-  DeserializationError error = deserializeJson(doc, response);
+  DeserializationError error = deserializeJson(doc, json, length);
+  TRACE_END("json.devices");
   if (error) {
-    Serial.println("Failed to parse registered devices response: " + String(error.c_str()));
+    LOG_ERROR("Failed to parse registered devices response: %s", error.c_str());
     return false;
   }
   
   if (!doc.containsKey("deviceUuids")) {
-    Serial.println("No deviceUuids in response");
+    LOG_ERROR("No deviceUuids in response");
     return false;
   }
   
-  // Clear and load devices
-  registeredDevices.clear();
+  // Clear and load devices: pointer table and strings both come from the arena
+  clearRegisteredDevices();
   JsonArray uuids = doc["deviceUuids"];
   
+  size_t capacity = uuids.size();
+  if (capacity > 0x7FFF) {
+    capacity = 0x7FFF; // ordinals are int16_t
+  }
+  registeredDevices = (const char**)deviceArena.allocate(capacity * sizeof(const char*));
+  registeredHashes = (uint32_t*)deviceArena.allocate(capacity * sizeof(uint32_t));
+  if (capacity > 0 && (!registeredDevices || !registeredHashes)) {
+    LOG_ERROR("Registered device table does not fit (%u devices, arena %u bytes)",
+              (unsigned)capacity, (unsigned)deviceArena.getCapacity());
+    return false;
+  }
+  
   for (JsonVariant uuid : uuids) {
-    registeredDevices.push_back(uuid.as<String>());
+    const char* value = uuid.as<const char*>();
+    if (!value || value[0] == '\0') {
+      continue;
+    }
+    if ((size_t)registeredDeviceCount >= capacity) {
+      break;
+    }
+    size_t len = strlen(value);
+    const char* copy = deviceArena.copy(value, len);
+    if (copy[0] == '\0') {
+      LOG_WARN("Device arena full, remaining registrations dropped");
+      break;
+    }
+    registeredHashes[registeredDeviceCount] = hashDeviceUuid(copy, len);
+    registeredDevices[registeredDeviceCount++] = copy;
+  }
+  
+  if (!buildRegisteredIndex()) {
+    LOG_ERROR("Device arena full, cannot build registration index");
+    clearRegisteredDevices();
+    return false;
   }
   
   devicesLoaded = true;
-  Serial.println("Loaded " + String(registeredDevices.size()) + " registered devices for event");
+  LOG_INFO("Loaded %d registered devices for event (arena %u/%u bytes)",
+           registeredDeviceCount, (unsigned)deviceArena.getUsed(), (unsigned)deviceArena.getCapacity());
   
   // Print registered devices for debugging
-  for (const auto& uuid : registeredDevices) {
-    Serial.println("  - " + uuid);
+  for (int i = 0; i < registeredDeviceCount; i++) {
+    LOG_VERBOSE("  - %s", registeredDevices[i]);
   }
   
   return true;
 }
 
 int EventManager::getRegisteredDeviceCount() {
-  return registeredDevices.size();
+  return registeredDeviceCount;
 }
 
-bool EventManager::isDeviceRegistered(const String& eventId, const String& bleUuid) {
+bool EventManager::isDeviceRegistered(const String& eventId, const char* bleUuid) {
   // If devices haven't been loaded yet, we can't verify
   if (!devicesLoaded) {
-    Serial.println("Warning: Registered devices not loaded yet for event " + eventId);
+    LOG_WARN("Registered devices not loaded yet for event %s", eventId.c_str());
     return false;
   }
   
-  // Check if bleUuid is in the registered devices list
-  for (const auto& uuid : registeredDevices) {
-    if (uuid == bleUuid) {
-      return true;
+  return findRegisteredDevice(bleUuid, hashDeviceUuid(bleUuid, strlen(bleUuid))) >= 0;
+}
+
+int EventManager::findRegisteredDevice(const char* bleUuid, uint32_t hash) {
+  if (!devicesLoaded || !registeredIndex) {
+    return -1;
+  }
+  
+  uint32_t slot = hash & registeredIndexMask;
+  while (registeredIndex[slot] >= 0) {
+    int ordinal = registeredIndex[slot];
+    if (registeredHashes[ordinal] == hash && strcmp(registeredDevices[ordinal], bleUuid) == 0) {
+      return ordinal;
     }
+    slot = (slot + 1) & registeredIndexMask;
+  }
+  return -1;
+}
+
+const char* EventManager::getRegisteredDeviceUuid(int ordinal) {
+  if (ordinal < 0 || ordinal >= registeredDeviceCount) {
+    return "";
+  }
+  return registeredDevices[ordinal];
+}
+
+const char* const* EventManager::getRegisteredDeviceTable() {
+  return registeredDevices;
+}
+
+uint32_t EventManager::getRegistrationGeneration() {
+  return registrationGeneration;
+}
+
+bool EventManager::buildRegisteredIndex() {
+  // Power-of-two table at least twice the device count keeps probes short
+  uint32_t slots = 16;
+  while (slots < (uint32_t)registeredDeviceCount * 2) {
+    slots <<= 1;
   }
   
-  return false;
+  registeredIndex = (int16_t*)deviceArena.allocate(slots * sizeof(int16_t));
+  if (!registeredIndex) {
+    return false;
+  }
+  memset(registeredIndex, 0xFF, slots * sizeof(int16_t)); // all slots = -1
+  registeredIndexMask = slots - 1;
+  
+  for (int i = 0; i < registeredDeviceCount; i++) {
+    uint32_t slot = registeredHashes[i] & registeredIndexMask;
+    while (registeredIndex[slot] >= 0) {
+      slot = (slot + 1) & registeredIndexMask;
+    }
+    registeredIndex[slot] = (int16_t)i;
+  }
+  return true;
 }
 
 bool EventManager::isEventActive(const String& eventId) {
@@ -218,6 +315,7 @@ bool EventManager::isEventValid(const String& eventId) {
 
 void EventManager::clearEvents() {
   eventCount = 0;
+  eventArena.reset();
   selectedEventIndex = -1;
   selectedEventId = "";
   selectedEventName = "";
@@ -225,13 +323,19 @@ void EventManager::clearEvents() {
 }
 
 void EventManager::clearRegisteredDevices() {
-  registeredDevices.clear();
+  deviceArena.reset();
+  registeredDevices = nullptr;
+  registeredHashes = nullptr;
+  registeredIndex = nullptr;
+  registeredIndexMask = 0;
+  registeredDeviceCount = 0;
   devicesLoaded = false;
+  registrationGeneration++;
 }
 
 bool EventManager::addEvent(const Event& event) {
   if (eventCount >= MAX_EVENTS) {
-    Serial.println("Maximum number of events reached");
+    LOG_WARN("Maximum number of events reached");
     return false;
   }
   
@@ -4,6 +4,7 @@
 #include "hardware_config.h"
 #include "backend_client.h"
 #include "common_types.h"
+#include "string_arena.h"
 
 class EventManager {
 private:
@@ -13,9 +14,19 @@ private:
   String selectedEventId;
   String selectedEventName;
   
-  // Cache of registered devices for the selected event
-  std::vector<String> registeredDevices;
+  // Event text lives here; reset wholesale on every reload
+  StaticStringArena<EVENT_ARENA_SIZE> eventArena;
+  
+  // Cache of registered devices for the selected event (UUID table and
+  // strings both live in deviceArena, reset when the selection changes)
+  StaticStringArena<DEVICE_ARENA_SIZE> deviceArena;
+  const char** registeredDevices;
+  uint32_t* registeredHashes;
+  int16_t* registeredIndex;   // Open-addressing table of ordinals, -1 = empty
+  uint32_t registeredIndexMask;
+  int registeredDeviceCount;
   bool devicesLoaded;
+  uint32_t registrationGeneration;  // Bumped whenever the table is cleared
   
 public:
   EventManager();
@@ -34,6 +45,8 @@ public:
   
   // Load registered devices for selected event
   bool loadRegisteredDevices(BackendClient& backend);
+  // Loads a /registered-devices response body ({"deviceUuids": [...]})
+  bool parseRegisteredDevices(const char* json, size_t length);
   int getRegisteredDeviceCount();
   
   // Event access
@@ -43,7 +56,15 @@ public:
   Event* getEventById(const String& eventId);
   
   // Device registration check
-  bool isDeviceRegistered(const String& eventId, const String& bleUuid);
+  bool isDeviceRegistered(const String& eventId, const char* bleUuid);
+  
+  // Ordinal of a registered device (index into the loaded table), or -1.
+  // Safe to call from the BLE callback while a scan is running.
+  int findRegisteredDevice(const char* bleUuid, uint32_t hash);
+  const char* getRegisteredDeviceUuid(int ordinal);
+  const char* const* getRegisteredDeviceTable();
+  // Changes whenever ordinals from findRegisteredDevice() stop being valid
+  uint32_t getRegistrationGeneration();
   
   // Event validation
   bool isEventActive(const String& eventId);
@@ -55,6 +76,7 @@ public:
 private:
   void clearEvents();
   void clearRegisteredDevices();
+  bool buildRegisteredIndex();
   bool addEvent(const Event& event);
 };
 
@@ -0,0 +1,105 @@
+#include "frame_canvas.h"
+
+FrameCanvas::FrameCanvas(uint16_t w, uint16_t h) : GFXcanvas16(w, h) {
+  dirtyX0 = dirtyY0 = 0;
+  dirtyX1 = dirtyY1 = -1;
+}
+
+void FrameCanvas::markDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+  // Clip to the canvas; rotation is never used so width()/height() are raw
+  if (w <= 0 || h <= 0) {
+    return;
+  }
+  int16_t x1 = x + w - 1;
+  int16_t y1 = y + h - 1;
+  if (x < 0) {
+    x = 0;
+  }
+  if (y < 0) {
+    y = 0;
+  }
+  if (x1 >= width()) {
+    x1 = width() - 1;
+  }
+  if (y1 >= height()) {
+    y1 = height() - 1;
+  }
+  if (x > x1 || y > y1) {
+    return;
+  }
+
+  if (dirtyX0 > dirtyX1) {
+    dirtyX0 = x;
+    dirtyY0 = y;
+    dirtyX1 = x1;
+    dirtyY1 = y1;
+    return;
+  }
+  if (x < dirtyX0) {
+    dirtyX0 = x;
+  }
+  if (y < dirtyY0) {
+    dirtyY0 = y;
+  }
+  if (x1 > dirtyX1) {
+    dirtyX1 = x1;
+  }
+  if (y1 > dirtyY1) {
+    dirtyY1 = y1;
+  }
+}
+
+void FrameCanvas::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  markDirty(x, y, 1, 1);
+  GFXcanvas16::drawPixel(x, y, color);
+}
+
+void FrameCanvas::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  markDirty(x, y, 1, h);
+  GFXcanvas16::drawFastVLine(x, y, h, color);
+}
+
+void FrameCanvas::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  markDirty(x, y, w, 1);
+  GFXcanvas16::drawFastHLine(x, y, w, color);
+}
+
+void FrameCanvas::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  markDirty(x, y, w, h);
+  GFXcanvas16::fillRect(x, y, w, h, color);
+}
+
+void FrameCanvas::fillScreen(uint16_t color) {
+  markDirty(0, 0, width(), height());
+  GFXcanvas16::fillScreen(color);
+}
+
+void FrameCanvas::scrollRows(int16_t y, int16_t h, int16_t dy) {
+  uint16_t* buffer = getBuffer();
+  if (!buffer || dy == 0 || abs(dy) >= h || y < 0 || y + h > height()) {
+    return;
+  }
+  
+  int16_t stride = width();
+  int16_t rows = h - abs(dy);
+  int16_t src = dy < 0 ? y - dy : y;
+  memmove(buffer + (src + dy) * stride, buffer + src * stride, (size_t)rows * stride * sizeof(uint16_t));
+  markDirty(0, y, stride, h);
+}
+
+bool FrameCanvas::isDirty() const {
+  return dirtyX0 <= dirtyX1;
+}
+
+bool FrameCanvas::takeDirty(int16_t& x, int16_t& y, int16_t& w, int16_t& h) {
+  if (!isDirty()) {
+    return false;
+  }
+  x = dirtyX0;
+  y = dirtyY0;
+  w = dirtyX1 - dirtyX0 + 1;
+  h = dirtyY1 - dirtyY0 + 1;
+  dirtyX0 = dirtyY0 = 0;
+  dirtyX1 = dirtyY1 = -1;
+  return true;
+}
@@ -0,0 +1,32 @@
+#ifndef FRAME_CANVAS_H
+#define FRAME_CANVAS_H
+
+#include "hardware_config.h"
+
+// In-RAM 16-bit frame that remembers the bounding box of everything drawn
+// since the last takeDirty(), so only that rectangle is sent to the panel.
+class FrameCanvas : public GFXcanvas16 {
+private:
+  int16_t dirtyX0, dirtyY0, dirtyX1, dirtyY1;  // Inclusive, x0 > x1 = clean
+
+  void markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+
+public:
+  FrameCanvas(uint16_t w, uint16_t h);
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+
+  // Move the full-width band [y, y + h) by dy rows inside the buffer
+  // (negative = up). Rows uncovered by the move keep their old pixels.
+  void scrollRows(int16_t y, int16_t h, int16_t dy);
+
+  bool isDirty() const;
+  // Returns the dirty rectangle and marks the canvas clean
+  bool takeDirty(int16_t& x, int16_t& y, int16_t& w, int16_t& h);
+};
+
+#endif // FRAME_CANVAS_H
@@ -21,6 +21,8 @@
 #define BUTTON_ENTER 32  // Enter/Select
 #define BUTTON_DOWN  33  // Down navigation
 
+#define BUTTON_QUEUE_LENGTH 32  // Edges buffered between ISR and main loop
+
 // LED Pins
 #define LED_YELLOW 2   // Device on/standby indicator (D2)
 #define LED_BLUE   15  // Active scanning indicator (D15)
@@ -44,11 +46,31 @@
 #define FONT_SIZE      1
 #define LINE_HEIGHT    12
 #define MAX_MENU_ITEMS 6
+#define WIDGET_TEXT_SIZE 64  // Characters retained per on-screen label
+#define DASHBOARD_REFRESH_MS 1000  // Throughput dashboard update period
+
+// Display Flush Task (frames render into RAM, a background task sends them)
+#define DISPLAY_FLUSH_TASK_STACK    2048
+#define DISPLAY_FLUSH_TASK_PRIORITY 1
+#define DISPLAY_FLUSH_TASK_CORE     0      // Main loop runs on core 1
+#define DISPLAY_FRAME_BUDGET_US     20000  // Render + flush time per frame
+
+// Idle Power Management (event menu and error screen)
+#define IDLE_CPU_FREQ_MHZ     80     // Lowest clock that keeps WiFi running
+#define ACTIVE_CPU_FREQ_MHZ   240
+#define IDLE_SLEEP_AFTER_MS   5000   // No input for this long before light sleep
+#define IDLE_SLEEP_PERIOD_MS  250    // Timer wake; keeps WiFi beacons and LEDs serviced
 
 // Button States (with internal pullup)
 #define BUTTON_PRESSED     LOW
 #define BUTTON_RELEASED    HIGH
 
+// LED Patterns (LEDC PWM at blink rate, so timing needs no loop involvement)
+#define LED_YELLOW_CHANNEL  0   // Channels 0 and 2 sit on separate LEDC timers
+#define LED_BLUE_CHANNEL    2
+#define LED_PWM_RESOLUTION  10
+#define LED_BACKLOG_HIGH    20  // Pending uploads shown as a fast yellow blink
+
 // LED States
 #define LED_ON     HIGH
 #define LED_OFF    LOW
@@ -61,8 +83,68 @@
 #define RIGHT_MARGIN   5
 
 // System Configuration
-#define MAX_EVENTS 10
+#define MAX_EVENTS 200  // Event list is virtualized, see DisplayManager::drawEventList
 #define SCAN_INTERVAL 5000  // 5 seconds
 #define BLE_SCAN_DURATION 1500  // 1.5 seconds for snappier stop response
 
+// Memory Configuration (static arenas, reset on reload/flush)
+#define EVENT_ARENA_SIZE  16384  // Event list text, per event load
+#ifndef DEVICE_ARENA_SIZE
+#define DEVICE_ARENA_SIZE 12288  // Registered device UUIDs, per event selection (host benchmarks override)
+#endif
+#define BATCH_ARENA_SIZE  8192   // Attendance upload body, per batch
+
+// Logging (see log.h)
+#define LOG_BUFFER_SIZE       4096  // Bytes queued for the UART before lines are dropped
+#define LOG_LINE_SIZE         160   // Longest formatted line, including prefix
+#define LOG_DEFAULT_LEVEL     3     // LOG_LEVEL_INFO
+#define LOG_TASK_STACK        2560
+#define LOG_TASK_PRIORITY     0     // Below the loop; drains while it waits
+#define LOG_TASK_CORE         0
+#define LOG_DRAIN_INTERVAL_MS 50
+
+// Heap telemetry (see heap_monitor.h)
+#define HEAP_SAMPLE_INTERVAL_MS 1000
+#define HEAP_REPORT_INTERVAL_MS 60000  // Summary line on the serial console
+
+// Metrics endpoint (see metrics_server.h)
+#ifndef METRICS_PORT
+#define METRICS_PORT          80     // Host builds override this
+#endif
+#define METRICS_TASK_STACK    4096
+#define METRICS_TASK_PRIORITY 1      // Same as the loop, below the BLE host task
+#define METRICS_TASK_CORE     1      // Away from the BLE controller on core 0
+#define METRICS_POLL_MS       100    // Accept poll period
+#define METRICS_CHUNK_SIZE    1024   // Response text buffered per TCP write
+#define METRICS_LINE_SIZE     160    // Longest exposition line
+#define LATENCY_BUCKET_COUNT    10   // Histogram buckets before +Inf
+#define LATENCY_FIRST_BUCKET_MS 25   // Upper bounds 25, 50, 100 ... 12800 ms
+#define SERIALIZE_FIRST_BUCKET_US 50 // Batch body build: 50, 100 ... 25600 us
+
+// Tracing (see trace.h; only used when TRACE_ENABLED is set)
+#define TRACE_BUFFER_EVENTS 1024  // Span events kept in RAM (power of two)
+
+// Advertisement capture (see capture.h; only used when CAPTURE_ENABLED is set)
+#define CAPTURE_BUFFER_SIZE 32768  // About 800 advertisements of ~40 bytes
+
+// Scan Result Buffer (struct-of-arrays, see sighting_buffer.h)
+#define MAX_SIGHTINGS       512   // Unique devices kept per scan window
+#define SIGHTING_INDEX_SIZE 1024  // Dedupe hash slots (power of two, >= 2x MAX_SIGHTINGS)
+
+// Presence tracking (see presence_tracker.h). Advertisements below the
+// floor are ignored; between the floor and the thresholds the smoothed
+// RSSI decides, with hysteresis so a phone at the door does not flicker.
+#define RSSI_FLOOR_DBM           -95
+#define PRESENCE_ENTER_DBM       -80     // Smoothed RSSI at or above: arrived
+#define PRESENCE_EXIT_DBM        -88     // Smoothed RSSI below: left
+#define PRESENCE_EMA_SHIFT       2       // Each scan moves the average 1/4 of the way
+#define PRESENCE_DEPART_MS       60000   // Unseen this long: left, at the time last seen
+#define PRESENCE_DWELL_REPORT_MS 0       // Dwell summary interval while present, 0 = off
+#define PRESENCE_MAX_DEVICES     320     // Registered devices tracked (DEVICE_ARENA_SIZE holds ~300)
+#define PRESENCE_OUTBOX_SIZE     256     // Changes waiting for upload
+
+// Per-address filter verdicts (see address_cache.h), 20 bytes per entry
+#define ADDRESS_CACHE_SIZE 512  // Entries, power of two
+#define ADDRESS_CACHE_WAYS 4    // Entries per set
+
 #endif // HARDWARE_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "heap_monitor.h"
+#include "scanner_metrics.h"
+#include "log.h"
+#include <esp_heap_caps.h>
+
+// Global instance defined in ESP32_Scanner_TFT.ino
+
+const char* const HeapMonitor::names[HEAP_SUBSYSTEM_COUNT] = { "scanner", "events", "backend", "display" };
+
+HeapScope* HeapScope::current = NULL;
+
+static uint32_t allocatedBlocks() {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_INTERNAL);
+  return info.allocated_blocks;
+}
+
+HeapMonitor::HeapMonitor() {
+  memset(&last, 0, sizeof(last));
+  memset(stats, 0, sizeof(stats));
+  lowestLargestBlock = 0;
+  lastSampleMs = 0;
+  lastReportMs = 0;
+}
+
+void HeapMonitor::begin() {
+  sample();
+  lastReportMs = millis();
+  if (last.psramSize > 0) {
+    LOG_INFO("Heap: %lu bytes free, PSRAM %lu/%lu bytes free", (unsigned long)last.freeBytes,
+             (unsigned long)last.psramFree, (unsigned long)last.psramSize);
+  } else {
+    LOG_INFO("Heap: %lu bytes free, no PSRAM", (unsigned long)last.freeBytes);
+  }
+}
+
+void HeapMonitor::update() {
+  unsigned long now = millis();
+  if (now - lastSampleMs >= HEAP_SAMPLE_INTERVAL_MS) {
+    sample();
+  }
+  if (now - lastReportMs >= HEAP_REPORT_INTERVAL_MS) {
+    lastReportMs = now;
+    report();
+  }
+}
+
+HeapSample HeapMonitor::sample() {
+  lastSampleMs = millis();
+  last.timeMs = lastSampleMs;
+  last.freeBytes = ESP.getFreeHeap();
+  last.largestBlock = ESP.getMaxAllocHeap();
+  last.minFreeBytes = ESP.getMinFreeHeap();
+  last.allocatedBlocks = allocatedBlocks();
+  last.fragmentationPercent = last.freeBytes > 0
+    ? (uint8_t)(100 - (uint64_t)last.largestBlock * 100 / last.freeBytes) : 0;
+  last.psramSize = ESP.getPsramSize();
+  last.psramFree = last.psramSize > 0 ? ESP.getFreePsram() : 0;
+
+  if (lowestLargestBlock == 0 || last.largestBlock < lowestLargestBlock) {
+    lowestLargestBlock = last.largestBlock;
+  }
+
+  scannerMetrics.heapFree = last.freeBytes;
+  scannerMetrics.heapLargestBlock = last.largestBlock;
+  scannerMetrics.heapMinFree = last.minFreeBytes;
+  scannerMetrics.psramFree = last.psramFree;
+  return last;
+}
+
+const HeapSample& HeapMonitor::getLastSample() {
+  return last;
+}
+
+uint32_t HeapMonitor::getLowestLargestBlock() {
+  return lowestLargestBlock;
+}
+
+const SubsystemHeapStats& HeapMonitor::getStats(HeapSubsystem subsystem) {
+  return stats[subsystem];
+}
+
+const char* HeapMonitor::getName(HeapSubsystem subsystem) {
+  return subsystem < HEAP_SUBSYSTEM_COUNT ? names[subsystem] : "?";
+}
+
+void HeapMonitor::record(HeapSubsystem subsystem, int32_t bytes, int32_t blocks) {
+  SubsystemHeapStats& s = stats[subsystem];
+  s.scopes++;
+  s.lastBytes = bytes;
+  s.retainedBytes += bytes;
+  if (bytes > s.peakBytes) {
+    s.peakBytes = bytes;
+  }
+  s.lastBlocks = blocks;
+  s.retainedBlocks += blocks;
+}
+
+void HeapMonitor::report() {
+  LOG_INFO("[HEAP] free %lu, largest %lu (min %lu), low-water %lu, frag %u%%, blocks %lu",
+           (unsigned long)last.freeBytes, (unsigned long)last.largestBlock,
+           (unsigned long)lowestLargestBlock, (unsigned long)last.minFreeBytes,
+           last.fragmentationPercent, (unsigned long)last.allocatedBlocks);
+  if (last.psramSize > 0) {
+    LOG_INFO("[HEAP] PSRAM free %lu of %lu", (unsigned long)last.psramFree, (unsigned long)last.psramSize);
+  }
+  for (int i = 0; i < HEAP_SUBSYSTEM_COUNT; i++) {
+    const SubsystemHeapStats& s = stats[i];
+    LOG_INFO("[HEAP] %-8s scopes %lu, retained %ld B / %ld blocks, last %ld B, peak %ld B",
+             names[i], (unsigned long)s.scopes, (long)s.retainedBytes, (long)s.retainedBlocks,
+             (long)s.lastBytes, (long)s.peakBytes);
+  }
+}
+
+HeapScope::HeapScope(HeapSubsystem subsystem) {
+  this->subsystem = subsystem;
+  childBytes = 0;
+  childBlocks = 0;
+  parent = current;
+  current = this;
+  startFree = ESP.getFreeHeap();
+  startBlocks = allocatedBlocks();
+}
+
+HeapScope::~HeapScope() {
+  int32_t bytes = (int32_t)(startFree - ESP.getFreeHeap());
+  int32_t blocks = (int32_t)(allocatedBlocks() - startBlocks);
+  heapMonitor.record(subsystem, bytes - childBytes, blocks - childBlocks);
+  current = parent;
+  if (parent) {
+    parent->childBytes += bytes;
+    parent->childBlocks += blocks;
+  }
+}
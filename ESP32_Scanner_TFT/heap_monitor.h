@@ -0,0 +1,90 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include "hardware_config.h"
+
+// Subsystems heap changes are attributed to
+enum HeapSubsystem {
+  HEAP_SCANNER,
+  HEAP_EVENTS,
+  HEAP_BACKEND,
+  HEAP_DISPLAY,
+  HEAP_SUBSYSTEM_COUNT
+};
+
+// One periodic snapshot of the internal heap (and PSRAM when fitted)
+struct HeapSample {
+  uint32_t timeMs;
+  uint32_t freeBytes;
+  uint32_t largestBlock;       // Biggest single allocation that can succeed
+  uint32_t minFreeBytes;       // Low-water mark since boot
+  uint32_t allocatedBlocks;
+  uint8_t fragmentationPercent; // 100 - largestBlock * 100 / freeBytes
+  uint32_t psramFree;
+  uint32_t psramSize;          // 0 when the board has no PSRAM
+};
+
+// Heap activity inside HeapScopes of one subsystem. Figures are net: bytes
+// and blocks the scope still held when it ended, excluding nested scopes.
+struct SubsystemHeapStats {
+  uint32_t scopes;
+  int32_t lastBytes;
+  int32_t retainedBytes;       // Sum over all scopes; growth means a leak
+  int32_t peakBytes;           // Largest single-scope net growth
+  int32_t lastBlocks;
+  int32_t retainedBlocks;
+};
+
+// Samples the heap every HEAP_SAMPLE_INTERVAL_MS and prints a summary line
+// every HEAP_REPORT_INTERVAL_MS, so memory regressions show up in the
+// console before an allocation fails in the field.
+class HeapMonitor {
+private:
+  HeapSample last;
+  uint32_t lowestLargestBlock;
+  unsigned long lastSampleMs;
+  unsigned long lastReportMs;
+  SubsystemHeapStats stats[HEAP_SUBSYSTEM_COUNT];
+
+  static const char* const names[HEAP_SUBSYSTEM_COUNT];
+
+public:
+  HeapMonitor();
+  void begin();
+  void update();
+
+  HeapSample sample();
+  const HeapSample& getLastSample();
+  uint32_t getLowestLargestBlock();
+
+  const SubsystemHeapStats& getStats(HeapSubsystem subsystem);
+  static const char* getName(HeapSubsystem subsystem);
+  void record(HeapSubsystem subsystem, int32_t bytes, int32_t blocks);
+
+  void report();
+};
+
+// Charges the heap change between construction and destruction to one
+// subsystem. Scopes nest; a parent is charged only what its children were
+// not. Use from the loop task only, other tasks' allocations in the same
+// window are counted too.
+class HeapScope {
+private:
+  HeapSubsystem subsystem;
+  uint32_t startFree;
+  uint32_t startBlocks;
+  int32_t childBytes;
+  int32_t childBlocks;
+  HeapScope* parent;
+
+  static HeapScope* current;
+
+public:
+  explicit HeapScope(HeapSubsystem subsystem);
+  ~HeapScope();
+};
+
+// Global heap monitor instance
+extern HeapMonitor heapMonitor;
+
+#endif // HEAP_MONITOR_H
@@ -0,0 +1,200 @@
+// Allocation-budget test for the steady-state scan loop. Runs the sketch
+// against a canned in-process backend and the host radio, counts the heap
+// allocations of each performScan() cycle and batch upload, and fails
+// when a case goes over its budget. Allocations inside the Arduino, BLE
+// and HTTP stand-ins are reported as library and not budgeted.
+//
+//   alloc_budget [--cycles N] [--trace] [--verbose]
+
+#include "alloc_hooks.h"
+#include "canned_backend.h"
+#include "sketch_runner.h"
+#include "storm_source.h"
+#include "ble_scanner.h"
+#include "log.h"
+#include "host_ble.h"
+#include "host_runtime.h"
+
+#include <Arduino.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Allocations allowed per cycle. The scan path must stay allocation-free.
+// The upload still builds Strings for the URL, headers and display text,
+// and parses the response into a JsonDocument; about 20 allocations today,
+// with headroom for ArduinoJson's pool growth.
+struct Budget {
+  const char* name;
+  unsigned long allocations;
+  unsigned long bytes;
+};
+
+const Budget BUDGETS[] = {
+  { "scan/quiet", 0, 0 },
+  { "scan/beacons", 0, 0 },
+  { "cycle/upload", 32, 4096 },
+  { "upload/batch", 32, 4096 },
+};
+
+const int REGISTERED_PHONES = 20;
+
+struct CaseResult {
+  host::AllocationCounts worst;
+  unsigned long batches;
+};
+
+void keepWorst(host::AllocationCounts& worst, const host::AllocationCounts& counts) {
+  worst.allocations = std::max(worst.allocations, counts.allocations);
+  worst.bytes = std::max(worst.bytes, counts.bytes);
+  worst.frees = std::max(worst.frees, counts.frees);
+  worst.libraryAllocations = std::max(worst.libraryAllocations, counts.libraryAllocations);
+  worst.libraryBytes = std::max(worst.libraryBytes, counts.libraryBytes);
+}
+
+// Worst per-cycle counts of performScan() after `warmup` uncounted cycles
+CaseResult measureScanCycles(int warmup, int cycles, CannedBackend& backend) {
+  CaseResult result;
+  memset(&result, 0, sizeof(result));
+  unsigned long batchesBefore = backend.getBatches();
+  for (int i = 0; i < warmup + cycles; i++) {
+    host::advanceClock(5000000ULL);
+    // Phones already present would upload nothing; start every cycle
+    // with no sessions so each one carries a full batch of arrivals
+    sketch::resetPresence();
+    bool counted = i >= warmup;
+    if (counted) {
+      host::startAllocationCount();
+    }
+    sketch::performScan();
+    if (counted) {
+      keepWorst(result.worst, host::stopAllocationCount());
+    }
+  }
+  result.batches = backend.getBatches() - batchesBefore;
+  return result;
+}
+
+// Worst per-upload counts, with the scans themselves left uncounted
+CaseResult measureUploads(int warmup, int cycles, CannedBackend& backend) {
+  CaseResult result;
+  memset(&result, 0, sizeof(result));
+  unsigned long batchesBefore = backend.getBatches();
+  for (int i = 0; i < warmup + cycles; i++) {
+    SightingView sightings = bleScanner.scan();
+    bool counted = i >= warmup;
+    if (counted) {
+      host::startAllocationCount();
+    }
+    sketch::uploadBatch(sightings);
+    if (counted) {
+      keepWorst(result.worst, host::stopAllocationCount());
+    }
+  }
+  result.batches = backend.getBatches() - batchesBefore;
+  return result;
+}
+
+bool check(const Budget& budget, const CaseResult& result) {
+  const host::AllocationCounts& worst = result.worst;
+  bool ok = worst.allocations <= budget.allocations && worst.bytes <= budget.bytes;
+  printf("%-14s %6lu allocs %8lu bytes  (budget %lu / %lu)  library %lu allocs %lu bytes  batches %lu  %s\n",
+         budget.name, worst.allocations, worst.bytes, budget.allocations, budget.bytes,
+         worst.libraryAllocations, worst.libraryBytes, result.batches, ok ? "ok" : "OVER BUDGET");
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  int cycles = 5;
+  bool trace = false;
+  bool verbose = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+      cycles = std::max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--trace") == 0) {
+      trace = true;
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      verbose = true;
+    } else {
+      fprintf(stderr, "usage: %s [--cycles N] [--trace] [--verbose]\n"
+                      "  --cycles N   counted cycles per case after two warm-up cycles (default 5)\n"
+                      "  --trace      print a backtrace for every counted firmware allocation\n"
+                      "  --verbose    print the firmware log\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  free(malloc(1));
+  if (!host::allocationHooksLinked()) {
+    fprintf(stderr, "malloc is not interposed; link host/alloc_hooks.cpp\n");
+    return 1;
+  }
+
+  CannedBackend backend(REGISTERED_PHONES);
+  if (!backend.start()) {
+    fprintf(stderr, "cannot start the canned backend\n");
+    return 1;
+  }
+  char url[64];
+  snprintf(url, sizeof(url), "http://127.0.0.1:%u/http", backend.getPort());
+
+  host::useVirtualClock(true);
+  if (!verbose) {
+    host::setSerialOutput(nullptr);
+  }
+  sketch::setup();
+  sketch::setBackendUrl(url);
+
+  // Menu, then the first event; give up after ten minutes of firmware time
+  unsigned long long deadlineUs = host::clockMicros() + 600000000ULL;
+  while (!sketch::isSelectingEvent() && host::clockMicros() < deadlineUs) {
+    sketch::loopOnce();
+  }
+  if (!sketch::selectEvent(0)) {
+    fprintf(stderr, "could not start scanning (state %s)\n", sketch::stateName());
+    return 1;
+  }
+
+  StormConfig phonesConfig;
+  phonesConfig.phones = REGISTERED_PHONES + 10;
+  phonesConfig.beacons = 100;
+  StormSource phones(phonesConfig);
+  StormConfig beaconsConfig;
+  beaconsConfig.phones = 0;
+  beaconsConfig.beacons = 300;
+  StormSource beacons(beaconsConfig);
+
+  const int warmup = 2;
+  bool ok = true;
+  host::traceAllocations(trace);
+
+  host::setAdvertisementSource(nullptr);
+  ok &= check(BUDGETS[0], measureScanCycles(warmup, cycles, backend));
+
+  host::setAdvertisementSource(&beacons);
+  beacons.skipUntil(host::clockMicros());
+  ok &= check(BUDGETS[1], measureScanCycles(warmup, cycles, backend));
+
+  host::setAdvertisementSource(&phones);
+  phones.skipUntil(host::clockMicros());
+  CaseResult cycle = measureScanCycles(warmup, cycles, backend);
+  ok &= check(BUDGETS[2], cycle);
+
+  phones.skipUntil(host::clockMicros());
+  CaseResult upload = measureUploads(warmup, cycles, backend);
+  ok &= check(BUDGETS[3], upload);
+
+  host::setAdvertisementSource(nullptr);
+  logger.flush();
+  if (cycle.batches == 0 || upload.batches == 0) {
+    fprintf(stderr, "no batch reached the backend; the upload cases measured nothing\n");
+    ok = false;
+  }
+  return ok ? 0 : 1;
+}
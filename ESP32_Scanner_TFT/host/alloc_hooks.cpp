@@ -0,0 +1,124 @@
+// Interposes the C allocator so host tools can count heap allocations
+// (see host::startAllocationCount). operator new and the Arduino String
+// both end up in malloc, so this covers every allocation path. Linked
+// only into binaries that need it; glibc only.
+
+#include "alloc_hooks.h"
+#include "host_runtime.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <execinfo.h>
+
+namespace {
+
+std::atomic<bool> tracing(false);
+thread_local bool inTrace = false;
+std::atomic<host::AllocationObserver*> observer(nullptr);
+
+void countAllocation(size_t size) {
+  if (!host::noteAllocation(size) || !tracing || inTrace) {
+    return;
+  }
+  // backtrace_symbols_fd() writes without allocating
+  inTrace = true;
+  void* frames[16];
+  int count = backtrace(frames, 16);
+  fprintf(stderr, "firmware allocation of %zu bytes:\n", size);
+  backtrace_symbols_fd(frames + 2, count - 2, fileno(stderr));
+  inTrace = false;
+}
+
+void observeAllocation(void* ptr, size_t size) {
+  host::AllocationObserver* current = observer.load(std::memory_order_acquire);
+  if (current && ptr && !host::inLibraryScope()) {
+    current->allocated(ptr, size);
+  }
+}
+
+void observeFree(void* ptr) {
+  host::AllocationObserver* current = observer.load(std::memory_order_acquire);
+  if (current && ptr) {
+    current->freed(ptr);
+  }
+}
+
+} // namespace
+
+namespace host {
+
+void setAllocationObserver(AllocationObserver* newObserver) {
+  observer.store(newObserver, std::memory_order_release);
+}
+
+void traceAllocations(bool enabled) {
+  // The first backtrace() loads libgcc, which allocates
+  void* frames[1];
+  backtrace(frames, 1);
+  tracing = enabled;
+}
+
+} // namespace host
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+  countAllocation(size);
+  void* ptr = __libc_malloc(size);
+  observeAllocation(ptr, size);
+  return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+  countAllocation(count * size);
+  void* ptr = __libc_calloc(count, size);
+  observeAllocation(ptr, count * size);
+  return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+  // A realloc may move the block, so it counts as an allocation
+  countAllocation(size);
+  observeFree(ptr);
+  void* moved = __libc_realloc(ptr, size);
+  observeAllocation(moved, size);
+  return moved;
+}
+
+void free(void* ptr) {
+  if (ptr) {
+    host::noteFree();
+  }
+  observeFree(ptr);
+  __libc_free(ptr);
+}
+
+void* memalign(size_t alignment, size_t size) {
+  countAllocation(size);
+  void* ptr = __libc_memalign(alignment, size);
+  observeAllocation(ptr, size);
+  return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+  return memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+  void* ptr = memalign(alignment, size);
+  if (!ptr) {
+    return ENOMEM;
+  }
+  *out = ptr;
+  return 0;
+}
+
+} // extern "C"
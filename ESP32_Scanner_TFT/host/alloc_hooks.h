@@ -0,0 +1,28 @@
+#ifndef HOST_ALLOC_HOOKS_H
+#define HOST_ALLOC_HOOKS_H
+
+// Extras of the malloc interposer in alloc_hooks.cpp. The counters
+// themselves are in host_runtime.h.
+
+#include <cstddef>
+
+namespace host {
+
+// Prints a backtrace to stderr for every counted firmware allocation
+void traceAllocations(bool enabled);
+
+// Sees every firmware allocation and every free, on every thread;
+// allocations inside a LibraryScope are left out. Must not allocate. A
+// realloc is reported as a free followed by an allocation.
+class AllocationObserver {
+public:
+  virtual ~AllocationObserver() {}
+  virtual void allocated(void* ptr, size_t size) = 0;
+  virtual void freed(void* ptr) = 0;
+};
+
+void setAllocationObserver(AllocationObserver* observer);
+
+} // namespace host
+
+#endif // HOST_ALLOC_HOOKS_H
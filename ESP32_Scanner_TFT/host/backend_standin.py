@@ -0,0 +1,492 @@
+#!/usr/bin/env python3
+
+"""
+Local stand-in for the Convex HTTP routes the scanner uses
+(backend/convex/http.ts), with injectable network faults.
+
+Serves /events, /active-events, /activate-event, /registered-devices,
+/batch-checkin, /attendance, /deactivate-events and /health under --prefix
+with the same JSON shapes and API key check as the real backend. Every
+injected delay and fault is drawn from a seeded generator, so a run can be
+repeated exactly.
+
+    python3 backend_standin.py --latency-ms 80 --bandwidth-kbps 64 --error-rate 0.05
+
+Phones in the default data set use the UUIDs ble_storm generates
+(ATT-USER-00001000, ...), so the two can be run together.
+"""
+
+import argparse
+import json
+import random
+import signal
+import socket
+import ssl
+import struct
+import sys
+import threading
+import time
+import zlib
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+# Same keys as the MVP validation in http.ts
+VALID_API_KEYS = {"att_3sh4fmd2u14ffisevqztm", "att_rf3g3b5m4yx0f9dxwyzd"}
+
+CORS_HEADERS = {
+    "Access-Control-Allow-Origin": "*",
+    "Access-Control-Allow-Methods": "GET, POST, OPTIONS",
+    "Access-Control-Allow-Headers": "Content-Type, x-api-key",
+}
+
+
+class Store:
+    """Events, registrations and recorded attendance, shared by all connections."""
+
+    def __init__(self, event_count, registered, users):
+        self.lock = threading.Lock()
+        self.events = []
+        for i in range(event_count):
+            self.events.append({
+                "id": "event_%02d" % (i + 1),
+                "name": "Lecture %02d" % (i + 1),
+                "description": "Stand-in event %d" % (i + 1),
+                "isActive": False,
+                "startTime": None,
+                "endTime": None,
+            })
+        self.users = set(phone_uuid(i) for i in range(max(users, registered)))
+        self.registrations = {event["id"]: [phone_uuid(i) for i in range(registered)]
+                              for event in self.events}
+        self.attendance = {}  # (uuid, event id) -> latest record is present
+
+    @classmethod
+    def load(cls, path):
+        """Reads {"events": [...], "registrations": {eventId: [uuid, ...]}}."""
+        with open(path) as f:
+            data = json.load(f)
+        store = cls(0, 0, 0)
+        for event in data.get("events", []):
+            store.events.append({
+                "id": event["id"],
+                "name": event.get("name", event["id"]),
+                "description": event.get("description", ""),
+                "isActive": bool(event.get("isActive", False)),
+                "startTime": event.get("startTime"),
+                "endTime": event.get("endTime"),
+            })
+        store.registrations = {k: list(v) for k, v in data.get("registrations", {}).items()}
+        for uuids in store.registrations.values():
+            store.users.update(uuids)
+        store.users.update(data.get("users", []))
+        return store
+
+    def find_event(self, event_id):
+        for event in self.events:
+            if event["id"] == event_id or event["name"] == event_id:
+                return event
+        return None
+
+    def record(self, record):
+        """One batch record, with the checks batchRecordAttendance makes."""
+        uuid = record.get("bleUuid")
+        if uuid not in self.users:
+            return {"bleUuid": uuid, "status": "error", "error": "User not found"}
+        event = self.find_event(record.get("eventId"))
+        if not event:
+            return {"bleUuid": uuid, "status": "error", "error": "Event not found"}
+        if uuid not in self.registrations.get(event["id"], []):
+            return {"bleUuid": uuid, "status": "error", "error": "User not registered for event"}
+        key = (uuid, event["id"])
+        attendance_id = "att_%08x" % zlib.crc32(("%s/%s" % key).encode())
+        presence = record.get("presence")
+        # Departures and dwell summaries always insert; arrivals and plain
+        # sightings are first-seen unless the student left in between
+        if presence not in ("departure", "dwell") and key in self.attendance:
+            if presence != "arrival" or self.attendance[key]:
+                return {"bleUuid": uuid, "status": "duplicate", "attendanceId": attendance_id}
+        self.attendance[key] = presence != "departure"
+        timestamp = record.get("timestamp")
+        if isinstance(timestamp, (int, float)):
+            if event["startTime"] is None or timestamp < event["startTime"]:
+                event["startTime"] = timestamp
+            if event["endTime"] is None or timestamp > event["endTime"]:
+                event["endTime"] = timestamp
+        return {"bleUuid": uuid, "status": "success", "attendanceId": attendance_id}
+
+
+def defined(fields):
+    """Drops unset fields, as JSON.stringify does with undefined."""
+    return {k: v for k, v in fields.items() if v is not None}
+
+
+def phone_uuid(index):
+    return "ATT-USER-%08X" % (0x1000 + index)
+
+
+class Faults:
+    """Injected network behaviour. Draws are serialized so a seed replays exactly."""
+
+    def __init__(self, args):
+        self.args = args
+        self.random = random.Random(args.seed)
+        self.lock = threading.Lock()
+        self.route_latency = {}
+        for item in args.route_latency:
+            route, _, ms = item.partition("=")
+            self.route_latency[route.strip("/")] = float(ms)
+
+    def draw(self):
+        with self.lock:
+            return self.random.random()
+
+    def latency(self, route):
+        base = self.route_latency.get(route, self.args.latency_ms)
+        with self.lock:
+            jitter = self.random.gauss(0, self.args.jitter_ms) if self.args.jitter_ms > 0 else 0
+        return max(0.0, base + jitter) / 1000.0
+
+    def throttle(self, length):
+        """Seconds `length` bytes take at the bandwidth cap."""
+        if self.args.bandwidth_kbps <= 0:
+            return 0.0
+        return length * 8 / (self.args.bandwidth_kbps * 1000.0)
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.counts = {}
+
+    def add(self, name, amount=1):
+        with self.lock:
+            self.counts[name] = self.counts.get(name, 0) + amount
+
+    def report(self, out):
+        with self.lock:
+            for name in sorted(self.counts):
+                out.write("%-24s %d\n" % (name, self.counts[name]))
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "ConvexStandIn/1.0"
+
+    def setup(self):
+        super().setup()
+        self.server.stats.add("connections")
+        # Charged once per connection, like a handshake; the scanner opens
+        # a new session for every request
+        if self.server.args.tls_ms > 0:
+            time.sleep(self.server.args.tls_ms / 1000.0)
+
+    def log_message(self, fmt, *args):
+        if self.server.args.verbose:
+            sys.stderr.write("%s %s\n" % (self.address_string(), fmt % args))
+
+    # --- transport -----------------------------------------------------
+
+    def read_body(self):
+        length = int(self.headers.get("Content-Length", 0) or 0)
+        body = b""
+        faults = self.server.faults
+        while len(body) < length:
+            chunk = self.rfile.read(min(self.server.args.chunk_bytes, length - len(body)))
+            if not chunk:
+                break
+            body += chunk
+            time.sleep(faults.throttle(len(chunk)))
+        self.server.stats.add("bytes_in", len(body))
+        return body
+
+    def send_json(self, status, payload):
+        body = json.dumps(payload).encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        for name, value in CORS_HEADERS.items():
+            self.send_header(name, value)
+        self.end_headers()
+        faults = self.server.faults
+        for start in range(0, len(body), self.server.args.chunk_bytes):
+            chunk = body[start:start + self.server.args.chunk_bytes]
+            self.wfile.write(chunk)
+            self.wfile.flush()
+            time.sleep(faults.throttle(len(chunk)))
+        self.server.stats.add("bytes_out", len(body))
+        self.server.stats.add("status_%d" % status)
+
+    def reset_connection(self):
+        """Drops the connection with an RST instead of answering."""
+        self.server.stats.add("resets")
+        self.connection.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack("ii", 1, 0))
+        self.close_connection = True
+        self.wfile = _Discard()
+        self.connection.close()
+
+    # --- dispatch ------------------------------------------------------
+
+    def route(self):
+        path = urlparse(self.path).path
+        prefix = self.server.args.prefix.rstrip("/")
+        if prefix and path.startswith(prefix + "/"):
+            path = path[len(prefix):]
+        return path.strip("/")
+
+    def do_OPTIONS(self):
+        self.send_response(200)
+        for name, value in CORS_HEADERS.items():
+            self.send_header(name, value)
+        self.send_header("Content-Length", "0")
+        self.end_headers()
+
+    def do_GET(self):
+        self.dispatch("GET", b"")
+
+    def do_POST(self):
+        self.dispatch("POST", self.read_body())
+
+    def dispatch(self, method, body):
+        route = self.route()
+        stats = self.server.stats
+        faults = self.server.faults
+        args = self.server.args
+        stats.add("requests")
+        stats.add("route_" + route)
+
+        if faults.draw() < args.reset_rate:
+            self.reset_connection()
+            return
+
+        time.sleep(faults.latency(route))
+
+        if faults.draw() < args.error_rate:
+            stats.add("injected_errors")
+            self.send_json(args.error_status, {"error": "Internal server error",
+                                               "details": "Injected by backend_standin"})
+            return
+
+        handler = ROUTES.get((method, route))
+        if not handler:
+            self.send_json(404, {"error": "No matching routes found"})
+            return
+        if route not in ("health",) and self.headers.get("x-api-key") is None:
+            self.send_json(401, {"error": "Missing API key"})
+            return
+        if route not in ("health",) and self.headers.get("x-api-key") not in VALID_API_KEYS:
+            self.send_json(401, {"error": "Invalid API key"})
+            return
+        try:
+            payload = json.loads(body) if body else {}
+        except ValueError as error:
+            self.send_json(500, {"error": "Internal server error", "details": str(error)})
+            return
+        status, response = handler(self, payload)
+        self.send_json(status, response)
+
+    # --- routes --------------------------------------------------------
+
+    def get_events(self, _payload):
+        store = self.server.store
+        with store.lock:
+            events = [defined(event) for event in store.events]
+        return 200, {"success": True, "events": events}
+
+    def get_active_events(self, _payload):
+        store = self.server.store
+        with store.lock:
+            events = [defined({"id": e["id"], "name": e["name"], "startTime": e["startTime"],
+                               "endTime": e["endTime"], "isActive": e["isActive"]})
+                      for e in store.events if e["isActive"]]
+        return 200, {"success": True, "events": events}
+
+    def activate_event(self, payload):
+        event_id = payload.get("eventId")
+        if not event_id:
+            return 400, {"error": "Missing eventId"}
+        store = self.server.store
+        with store.lock:
+            event = store.find_event(event_id)
+            if not event:
+                return 500, {"error": "Internal server error", "details": "Event not found"}
+            for other in store.events:
+                other["isActive"] = False
+            event["isActive"] = True
+            return 200, {"success": True, "event": {"id": event["id"], "name": event["name"],
+                                                    "isActive": True}}
+
+    def deactivate_events(self, _payload):
+        store = self.server.store
+        with store.lock:
+            count = 0
+            for event in store.events:
+                if event["isActive"]:
+                    event["isActive"] = False
+                    count += 1
+        return 200, {"success": True, "deactivatedCount": count, "message": "All events deactivated"}
+
+    def registered_devices(self, _payload):
+        event_id = parse_qs(urlparse(self.path).query).get("eventId", [None])[0]
+        if not event_id:
+            return 400, {"error": "Missing eventId parameter"}
+        store = self.server.store
+        with store.lock:
+            event = store.find_event(event_id)
+            uuids = list(store.registrations.get(event["id"], [])) if event else []
+        return 200, {"success": True, "deviceUuids": uuids, "count": len(uuids)}
+
+    def batch_checkin(self, payload):
+        received = time.monotonic()
+        records = payload.get("records")
+        if not isinstance(records, list):
+            return 400, {"error": "Invalid request body. Expected { records: [...] }"}
+        store = self.server.store
+        with store.lock:
+            results = [store.record(record) for record in records]
+        self.server.stats.add("records", len(records))
+        if self.server.args.server_ms > 0:
+            time.sleep(self.server.args.server_ms / 1000.0)
+        return 200, {
+            "success": True,
+            "processed": len(results),
+            "successful": sum(1 for r in results if r["status"] == "success"),
+            "duplicates": sum(1 for r in results if r["status"] == "duplicate"),
+            "errors": sum(1 for r in results if r["status"] == "error"),
+            "results": results,
+            "serverMs": int((time.monotonic() - received) * 1000),
+        }
+
+    def attendance(self, payload):
+        uuid = payload.get("bleUuid")
+        event_id = payload.get("eventId")
+        if not uuid or not event_id:
+            return 400, {"error": "Missing bleUuid or eventId"}
+        store = self.server.store
+        with store.lock:
+            if uuid not in store.users:
+                return 404, {"error": "User not found for BLE UUID"}
+            result = store.record({"bleUuid": uuid, "eventId": event_id,
+                                   "timestamp": int(time.time() * 1000)})
+        return 200, {"success": True, "attendanceId": result.get("attendanceId"),
+                     "user": {"name": uuid, "email": uuid.lower() + "@example.com"}}
+
+    def health(self, _payload):
+        return 200, {"status": "healthy", "timestamp": int(time.time() * 1000), "version": "1.0.0"}
+
+
+class _Discard:
+    """Stands in for wfile once a connection has been reset."""
+
+    def write(self, data):
+        return len(data)
+
+    def flush(self):
+        pass
+
+    def close(self):
+        pass
+
+
+ROUTES = {
+    ("GET", "events"): Handler.get_events,
+    ("GET", "active-events"): Handler.get_active_events,
+    ("POST", "activate-event"): Handler.activate_event,
+    ("GET", "registered-devices"): Handler.registered_devices,
+    ("POST", "batch-checkin"): Handler.batch_checkin,
+    ("POST", "attendance"): Handler.attendance,
+    ("POST", "deactivate-events"): Handler.deactivate_events,
+    ("GET", "health"): Handler.health,
+}
+
+
+class StandInServer(ThreadingHTTPServer):
+    daemon_threads = True
+
+    def __init__(self, args, store):
+        super().__init__((args.host, args.port), Handler)
+        self.args = args
+        self.store = store
+        self.faults = Faults(args)
+        self.stats = Stats()
+        self.tls = None
+        if args.tls_cert:
+            self.tls = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+            self.tls.load_cert_chain(args.tls_cert, args.tls_key or args.tls_cert)
+
+    def get_request(self):
+        sock, address = super().get_request()
+        if self.tls:
+            # Handshake on the handler thread so a slow client does not
+            # stall the accept loop
+            sock = self.tls.wrap_socket(sock, server_side=True, do_handshake_on_connect=False)
+        return sock, address
+
+    def finish_request(self, request, client_address):
+        if self.tls:
+            try:
+                request.do_handshake()
+            except (ssl.SSLError, OSError):
+                self.stats.add("tls_failures")
+                return
+        super().finish_request(request, client_address)
+
+    def handle_error(self, request, client_address):
+        # Clients dropping mid-response are expected under fault injection
+        self.stats.add("client_errors")
+        if self.args.verbose:
+            super().handle_error(request, client_address)
+
+
+def parse_args(argv):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8787)
+    parser.add_argument("--prefix", default="/http", help="path prefix before the routes (default /http)")
+    parser.add_argument("--events", type=int, default=3, help="events in the default data set")
+    parser.add_argument("--registered", type=int, default=300, help="phones registered for each event")
+    parser.add_argument("--users", type=int, default=500, help="known phones, registered or not")
+    parser.add_argument("--data", help="JSON file with events, registrations and users instead")
+    parser.add_argument("--latency-ms", type=float, default=0, help="delay before every response")
+    parser.add_argument("--jitter-ms", type=float, default=0, help="standard deviation of the delay")
+    parser.add_argument("--route-latency", action="append", default=[], metavar="ROUTE=MS",
+                        help="delay for one route instead of --latency-ms, e.g. batch-checkin=400")
+    parser.add_argument("--server-ms", type=float, default=0,
+                        help="processing time added inside /batch-checkin, reported in serverMs")
+    parser.add_argument("--bandwidth-kbps", type=float, default=0,
+                        help="cap on request and response bodies, 0 = unlimited")
+    parser.add_argument("--chunk-bytes", type=int, default=512, help="write size under the bandwidth cap")
+    parser.add_argument("--error-rate", type=float, default=0, help="fraction of requests failed")
+    parser.add_argument("--error-status", type=int, default=500, help="status of injected errors")
+    parser.add_argument("--reset-rate", type=float, default=0,
+                        help="fraction of requests answered with a TCP reset")
+    parser.add_argument("--tls-ms", type=float, default=0, help="handshake delay per connection")
+    parser.add_argument("--tls-cert", help="serve real TLS with this certificate (PEM)")
+    parser.add_argument("--tls-key", help="private key for --tls-cert, if not in the same file")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--verbose", action="store_true", help="log every request")
+    return parser.parse_args(argv)
+
+
+def main(argv):
+    args = parse_args(argv)
+    store = Store.load(args.data) if args.data else Store(args.events, args.registered, args.users)
+    server = StandInServer(args, store)
+
+    def shutdown(_signum, _frame):
+        threading.Thread(target=server.shutdown, daemon=True).start()
+
+    signal.signal(signal.SIGINT, shutdown)
+    signal.signal(signal.SIGTERM, shutdown)
+
+    scheme = "https" if server.tls else "http"
+    sys.stderr.write("Convex stand-in on %s://%s:%d%s (%d events)\n"
+                     % (scheme, args.host, args.port, args.prefix, len(store.events)))
+    server.serve_forever()
+    server.server_close()
+    sys.stderr.write("\n--- backend_standin ---\n")
+    server.stats.report(sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""Compare two scanner_bench --json result files.
+
+    bench_compare.py BASELINE CURRENT [--threshold PCT]
+
+Prints the per-benchmark change in median ns/op and exits 1 when any
+benchmark got slower by more than the threshold (default 10%).
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return data.get("context", {}), {b["name"]: b for b in data.get("benchmarks", [])}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare scanner_bench results")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="regression threshold in percent (default 10)")
+    args = parser.parse_args()
+
+    base_context, baseline = load(args.baseline)
+    context, current = load(args.current)
+    for name, ctx in (("baseline", base_context), ("current", context)):
+        if ctx.get("optimized") is False:
+            print("warning: %s was built without optimization" % name, file=sys.stderr)
+
+    width = max([len(n) for n in list(baseline) + list(current)] + [9])
+    print("%-*s %14s %14s %9s" % (width, "benchmark", "baseline ns", "current ns", "change"))
+    regressions = []
+    for name, bench in current.items():
+        if name not in baseline:
+            print("%-*s %14s %14.1f %9s" % (width, name, "-", bench["ns_per_op"], "new"))
+            continue
+        before = baseline[name]["ns_per_op"]
+        after = bench["ns_per_op"]
+        change = (after - before) / before * 100.0 if before > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions.append(name)
+        print("%-*s %14.1f %14.1f %+8.1f%%%s" % (width, name, before, after, change, flag))
+    for name in baseline:
+        if name not in current:
+            print("%-*s %14.1f %14s %9s" % (width, name, baseline[name]["ns_per_op"], "-", "missing"))
+
+    if regressions:
+        print("\n%d benchmark(s) slower by more than %.0f%%" % (len(regressions), args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,169 @@
+// Replays an advertisement capture (see capture.h) through the firmware's
+// BLEScanner: the callback, filter, dedupe and registration lookup the
+// radio drives on the device. At --speed 1x the original timing is kept;
+// at max the virtual clock lets the scanner take packets as fast as it can,
+// which is the figure to compare before and after an optimization.
+//
+//   ble_replay CAPTURE [--speed 1x|max] [--loops N] [--registered FILE] [--verbose]
+
+#include "capture_file.h"
+#include "ble_scanner.h"
+#include "event_manager.h"
+#include "scanner_metrics.h"
+#include "log.h"
+#include "host_runtime.h"
+
+#include <Arduino.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <time.h>
+
+namespace {
+
+void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s CAPTURE [--speed 1x|max] [--loops N] [--registered FILE] [--verbose]\n"
+          "  CAPTURE          capture file or serial log holding a 'c' dump\n"
+          "  --speed S        1x keeps the recorded timing, max runs on the virtual clock (default max)\n"
+          "  --loops N        play the capture N times (default 1)\n"
+          "  --registered F   /registered-devices response body to match against\n"
+          "  --verbose        print the firmware log\n",
+          program);
+}
+
+double threadCpuSeconds() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+bool loadRegistered(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return false;
+  }
+  std::string json;
+  char chunk[4096];
+  size_t got;
+  while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    json.append(chunk, got);
+  }
+  fclose(file);
+  return events.parseRegisteredDevices(json.c_str(), json.length());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* capturePath = nullptr;
+  const char* registeredPath = nullptr;
+  bool realTime = false;
+  int loops = 1;
+  bool verbose = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+      const char* speed = argv[++i];
+      if (strcmp(speed, "1x") == 0) {
+        realTime = true;
+      } else if (strcmp(speed, "max") != 0) {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+      loops = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--registered") == 0 && i + 1 < argc) {
+      registeredPath = argv[++i];
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      verbose = true;
+    } else if (argv[i][0] != '-' && !capturePath) {
+      capturePath = argv[i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (!capturePath || loops < 1) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  std::vector<CaptureRecord> records;
+  std::string error;
+  if (!readCaptureFile(capturePath, records, error)) {
+    fprintf(stderr, "%s: %s\n", capturePath, error.c_str());
+    return 1;
+  }
+  if (!error.empty()) {
+    fprintf(stderr, "warning: %s\n", error.c_str());
+  }
+  std::set<unsigned long long> addresses;
+  for (const CaptureRecord& record : records) {
+    unsigned long long key = 0;
+    memcpy(&key, record.address, sizeof(record.address));
+    addresses.insert(key);
+  }
+
+  host::useVirtualClock(!realTime);
+  if (!verbose) {
+    host::setSerialOutput(nullptr);
+  }
+  events.begin();
+  if (registeredPath && !loadRegistered(registeredPath)) {
+    fprintf(stderr, "could not load registered devices from %s\n", registeredPath);
+    return 1;
+  }
+  if (!bleScanner.begin()) {
+    fprintf(stderr, "BLE scanner init failed\n");
+    return 1;
+  }
+
+  ReplaySource replay(records);
+  host::setAdvertisementSource(&replay);
+  replay.start(host::clockMicros(), loops);
+
+  auto wallStart = std::chrono::steady_clock::now();
+  double cpuStart = threadCpuSeconds();
+  unsigned long long replayStartUs = host::clockMicros();
+  long sightingsTotal = 0;
+  long registeredTotal = 0;
+  int scans = 0;
+  while (!replay.isFinished()) {
+    SightingView sightings = bleScanner.scan();
+    scans++;
+    sightingsTotal += sightings.size();
+    for (int i = 0; i < sightings.size(); i++) {
+      if (sightings.isRegistered(i)) {
+        registeredTotal++;
+      }
+    }
+  }
+  double cpuSeconds = threadCpuSeconds() - cpuStart;
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double replaySeconds = (host::clockMicros() - replayStartUs) / 1e6;
+  logger.flush();
+
+  unsigned long long delivered = replay.getDelivered();
+  unsigned long long seen = scannerMetrics.advertisementsSeen;
+  unsigned long long matched = scannerMetrics.advertisementsMatched;
+  printf("--- ble_replay %s ---\n", capturePath);
+  printf("capture        %zu advertisements, %zu addresses, %.2f s recorded\n",
+         records.size(), addresses.size(), replay.getDurationUs() / 1e6);
+  printf("replay         %llu delivered in %d scans, %.2f s firmware time, %.2f s wall (%s)\n",
+         delivered, scans, replaySeconds, wallSeconds, realTime ? "1x" : "max");
+  printf("throughput     %.0f packets/s wall, %.2f us CPU per packet (%.0f packets/s capacity)\n",
+         wallSeconds > 0 ? delivered / wallSeconds : 0.0,
+         delivered ? cpuSeconds * 1e6 / delivered : 0.0,
+         cpuSeconds > 0 ? delivered / cpuSeconds : 0.0);
+  printf("pipeline       %llu seen, %llu matched (%.1f%%), %lu sightings dropped\n",
+         seen, matched, seen ? 100.0 * matched / seen : 0.0, bleScanner.getDroppedSightings());
+  printf("sightings      %.1f per scan, %.1f registered (%d registrations loaded)\n",
+         scans ? (double)sightingsTotal / scans : 0.0, scans ? (double)registeredTotal / scans : 0.0,
+         events.getRegisteredDeviceCount());
+  return 0;
+}
@@ -0,0 +1,279 @@
+// BLE advertisement storm: feeds a synthetic population of attendance
+// phones and unrelated beacons through the firmware's BLEScanner, the same
+// callback and sighting path the radio drives on the device, and reports
+// how much of the offered traffic makes it through each stage.
+//
+//   ble_storm [--phones N] [--interval-ms N] [--beacons N] [--beacon-interval-ms N]
+//             [--registered N] [--rssi-mean DBM] [--rssi-spread DB] [--rssi-noise DB]
+//             [--rotate-s N] [--format mfg|name|service|mixed] [--max-lag-ms N]
+//             [--scans N] [--scan-gap-ms N] [--virtual-clock] [--seed N] [--record FILE]
+//             [--verbose]
+
+#include "storm_source.h"
+#include "capture_file.h"
+#include "ble_scanner.h"
+#include "event_manager.h"
+#include "backend_client.h"
+#include "scanner_metrics.h"
+#include "log.h"
+#include "host_runtime.h"
+
+#include <Arduino.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <time.h>
+
+namespace {
+
+void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --phones N              attendance phones advertising (default 500)\n"
+          "  --interval-ms N         phone advertising interval (default 100)\n"
+          "  --beacons N             non-attendance beacons (default 300)\n"
+          "  --beacon-interval-ms N  beacon advertising interval (default 100)\n"
+          "  --registered N          phones registered for the event (default 300)\n"
+          "  --rssi-mean DBM         mean of the per-device RSSI (default -65)\n"
+          "  --rssi-spread DB        spread of per-device means (default 8)\n"
+          "  --rssi-noise DB         per-packet RSSI noise (default 4)\n"
+          "  --rotate-s N            MAC rotation period, 0 = fixed (default 0)\n"
+          "  --format F              phone payload: mfg, name, service or mixed (default mfg)\n"
+          "  --max-lag-ms N          reports older than this are lost, 0 = never (default 100)\n"
+          "  --scans N               scan cycles to run (default 10)\n"
+          "  --scan-gap-ms N         radio-off time between scans (default 0)\n"
+          "  --virtual-clock         deliver on the virtual clock: exact counts, no lag\n"
+          "  --seed N                random seed (default 1)\n"
+          "  --record FILE           write the delivered advertisements as a capture for ble_replay\n"
+          "  --verbose               print the firmware log\n",
+          program);
+}
+
+bool parseFormat(const char* text, StormPayloadFormat& format) {
+  if (strcmp(text, "mfg") == 0) {
+    format = STORM_MANUFACTURER;
+  } else if (strcmp(text, "name") == 0) {
+    format = STORM_NAME;
+  } else if (strcmp(text, "service") == 0) {
+    format = STORM_SERVICE_DATA;
+  } else if (strcmp(text, "mixed") == 0) {
+    format = STORM_MIXED;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+double threadCpuSeconds() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Registers the first `count` phones through the same parser the
+// /registered-devices response goes through
+bool registerPhones(int count) {
+  std::string json = "{\"deviceUuids\":[";
+  char uuid[24];
+  for (int i = 0; i < count; i++) {
+    StormSource::phoneUuid(i, uuid, sizeof(uuid));
+    json += i > 0 ? ",\"" : "\"";
+    json += uuid;
+    json += "\"";
+  }
+  json += "]}";
+  return events.parseRegisteredDevices(json.c_str(), json.length());
+}
+
+double percent(unsigned long long part, unsigned long long whole) {
+  return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  StormConfig config;
+  int registered = 300;
+  int scans = 10;
+  unsigned long scanGapMs = 0;
+  bool virtualClock = false;
+  bool verbose = false;
+  const char* recordPath = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (strcmp(arg, "--virtual-clock") == 0) {
+      virtualClock = true;
+      continue;
+    }
+    if (strcmp(arg, "--verbose") == 0) {
+      verbose = true;
+      continue;
+    }
+    if (!value) {
+      usage(argv[0]);
+      return 2;
+    }
+    i++;
+    if (strcmp(arg, "--phones") == 0) {
+      config.phones = atoi(value);
+    } else if (strcmp(arg, "--interval-ms") == 0) {
+      config.phoneIntervalMs = strtoul(value, nullptr, 10);
+    } else if (strcmp(arg, "--beacons") == 0) {
+      config.beacons = atoi(value);
+    } else if (strcmp(arg, "--beacon-interval-ms") == 0) {
+      config.beaconIntervalMs = strtoul(value, nullptr, 10);
+    } else if (strcmp(arg, "--registered") == 0) {
+      registered = atoi(value);
+    } else if (strcmp(arg, "--rssi-mean") == 0) {
+      config.rssiMean = atof(value);
+    } else if (strcmp(arg, "--rssi-spread") == 0) {
+      config.rssiSpread = atof(value);
+    } else if (strcmp(arg, "--rssi-noise") == 0) {
+      config.rssiNoise = atof(value);
+    } else if (strcmp(arg, "--rotate-s") == 0) {
+      config.rotateSeconds = strtoul(value, nullptr, 10);
+    } else if (strcmp(arg, "--max-lag-ms") == 0) {
+      config.maxLagMs = strtoul(value, nullptr, 10);
+    } else if (strcmp(arg, "--scans") == 0) {
+      scans = atoi(value);
+    } else if (strcmp(arg, "--scan-gap-ms") == 0) {
+      scanGapMs = strtoul(value, nullptr, 10);
+    } else if (strcmp(arg, "--seed") == 0) {
+      config.seed = (uint32_t)strtoul(value, nullptr, 10);
+    } else if (strcmp(arg, "--record") == 0) {
+      recordPath = value;
+    } else if (strcmp(arg, "--format") == 0 && parseFormat(value, config.format)) {
+      continue;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (registered > config.phones) {
+    registered = config.phones;
+  }
+
+  host::useVirtualClock(virtualClock);
+  if (!verbose) {
+    host::setSerialOutput(nullptr);
+  }
+
+  events.begin();
+  if (!registerPhones(registered)) {
+    fprintf(stderr, "could not register %d phones (device arena %d bytes)\n", registered, DEVICE_ARENA_SIZE);
+    return 1;
+  }
+  int loaded = events.getRegisteredDeviceCount();
+  if (!bleScanner.begin()) {
+    fprintf(stderr, "BLE scanner init failed\n");
+    return 1;
+  }
+
+  StormSource storm(config);
+  CaptureFileWriter capture;
+  RecordingSource recording(storm, capture);
+  if (recordPath) {
+    if (!capture.open(recordPath)) {
+      fprintf(stderr, "cannot write %s\n", recordPath);
+      return 1;
+    }
+    host::setAdvertisementSource(&recording);
+  } else {
+    host::setAdvertisementSource(&storm);
+  }
+
+  static char body[BATCH_ARENA_SIZE];
+  unsigned long long scanUs = 0;
+  double cpuSeconds = 0;
+  int minFound = loaded;
+  long totalFound = 0;
+  int oversizedBatches = 0;
+  size_t largestBatch = 0;
+  unsigned long long seenBefore = scannerMetrics.advertisementsSeen;
+  unsigned long long matchedBefore = scannerMetrics.advertisementsMatched;
+
+  printf("%-5s %9s %9s %7s %10s %8s\n", "scan", "delivered", "sightings", "found", "batch_B", "lag_ms");
+  for (int cycle = 0; cycle < scans; cycle++) {
+    storm.skipUntil(host::clockMicros());
+    unsigned long long deliveredBefore = storm.getDelivered();
+    unsigned long long startUs = host::clockMicros();
+    double cpuStart = threadCpuSeconds();
+
+    SightingView sightings = bleScanner.scan();
+
+    cpuSeconds += threadCpuSeconds() - cpuStart;
+    scanUs += host::clockMicros() - startUs;
+
+    int found = 0;
+    for (int i = 0; i < sightings.size(); i++) {
+      if (sightings.isRegistered(i)) {
+        found++;
+      }
+    }
+    totalFound += found;
+    if (found < minFound) {
+      minFound = found;
+    }
+
+    // The upload path's first step, without the network
+    size_t bodyLength = 0;
+    if (found > 0) {
+      bodyLength = BackendClient::buildBatchCheckinBody(sightings, events.getRegisteredDeviceTable(),
+                                                        "storm-event", "ESP32-Scanner-01",
+                                                        1700000000000ULL, millis(), body, sizeof(body));
+      if (bodyLength == 0) {
+        oversizedBatches++;
+      } else if (bodyLength > largestBatch) {
+        largestBatch = bodyLength;
+      }
+    }
+
+    printf("%-5d %9llu %9d %7d %10u %8.1f\n", cycle + 1, storm.getDelivered() - deliveredBefore,
+           sightings.size(), found, (unsigned)bodyLength, storm.getWorstLagUs() / 1000.0);
+    if (scanGapMs > 0) {
+      delay(scanGapMs);
+    }
+  }
+  logger.flush();
+  if (recordPath) {
+    capture.close();
+  }
+
+  unsigned long long seen = scannerMetrics.advertisementsSeen - seenBefore;
+  unsigned long long matched = scannerMetrics.advertisementsMatched - matchedBefore;
+  unsigned long long airtime = storm.getGenerated() - storm.getRadioOff();
+  double scanSeconds = scanUs / 1e6;
+  double offeredRate = (double)config.phones * 1000.0 / (config.phoneIntervalMs + config.advDelayMaxMs / 2.0) +
+                       (double)config.beacons * 1000.0 / (config.beaconIntervalMs + config.advDelayMaxMs / 2.0);
+
+  printf("\n--- ble_storm: %d phones (%d registered), %d beacons, %d scans, %.1f s scanning ---\n",
+         config.phones, loaded, config.beacons, scans, scanSeconds);
+  printf("offered        %.0f packets/s on air\n", offeredRate);
+  printf("sustained      %.0f packets/s delivered while scanning, %.1f us CPU per packet (%.0f packets/s capacity)\n",
+         airtime > 0 ? offeredRate * storm.getDelivered() / airtime : 0.0,
+         storm.getDelivered() ? cpuSeconds * 1e6 / storm.getDelivered() : 0.0,
+         cpuSeconds > 0 ? storm.getDelivered() / cpuSeconds : 0.0);
+  printf("radio          %llu on air while scanning, %llu delivered, %llu lost to lag (%.2f%%), worst lag %.1f ms\n",
+         airtime, storm.getDelivered(), storm.getOverruns(), percent(storm.getOverruns(), airtime),
+         storm.getWorstLagUs() / 1000.0);
+  printf("               %llu sent while the radio was off, %llu MAC rotations\n",
+         storm.getRadioOff(), storm.getRotations());
+  printf("pipeline       %llu seen, %llu matched (%.1f%%), %lu sightings dropped (buffer %d)\n",
+         seen, matched, percent(matched, seen), bleScanner.getDroppedSightings(), MAX_SIGHTINGS);
+  printf("early reject   %lu no carrier, %lu too short, %lu no ATT- prefix\n",
+         (unsigned long)scannerMetrics.rejectedNoCarrier, (unsigned long)scannerMetrics.rejectedTooShort,
+         (unsigned long)scannerMetrics.rejectedNoPrefix);
+  unsigned long long hits = scannerMetrics.addressCacheHits;
+  printf("address cache  %.1f%% hits, %lu evictions, %lu payload changes (%d entries)\n",
+         percent(hits, hits + scannerMetrics.addressCacheMisses), bleScanner.getAddressCache().getEvictions(),
+         bleScanner.getAddressCache().getInvalidations(), ADDRESS_CACHE_SIZE);
+  printf("attendance     %.1f of %d registered found per scan (min %d, %.1f%%)\n",
+         scans > 0 ? (double)totalFound / scans : 0.0, loaded, minFound,
+         percent(totalFound, (unsigned long long)loaded * scans));
+  printf("batch          largest %u of %d bytes, %d scan(s) too large to upload\n",
+         (unsigned)largestBatch, BATCH_ARENA_SIZE, oversizedBatches);
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include "canned_backend.h"
+#include "storm_source.h"
+#include "common_types.h"
+
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+CannedBackend::CannedBackend(int registeredPhones)
+    : registeredPhones(registeredPhones), listener(-1), port(0), running(false) {}
+
+CannedBackend::~CannedBackend() {
+  running = false;
+  if (listener >= 0) {
+    shutdown(listener, SHUT_RDWR);
+    close(listener);
+  }
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+bool CannedBackend::start() {
+  registered = "{\"success\":true,\"deviceUuids\":[";
+  for (int i = 0; i < registeredPhones; i++) {
+    char uuid[DEVICE_UUID_SIZE];
+    StormSource::phoneUuid(i, uuid, sizeof(uuid));
+    registered += i > 0 ? ",\"" : "\"";
+    registered += uuid;
+    registered += "\"";
+  }
+  registered += "],\"count\":" + std::to_string(registeredPhones) + "}";
+
+  listener = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(addr);
+  if (listener < 0 || bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 8) != 0 ||
+      getsockname(listener, (sockaddr*)&addr, &length) != 0) {
+    return false;
+  }
+  port = ntohs(addr.sin_port);
+  running = true;
+  thread = std::thread(&CannedBackend::serve, this);
+  return true;
+}
+
+void CannedBackend::serve() {
+  while (running) {
+    int client = accept(listener, nullptr, nullptr);
+    if (client < 0) {
+      continue;
+    }
+    handle(client);
+    close(client);
+  }
+}
+
+void CannedBackend::handle(int client) {
+  std::string request;
+  char chunk[4096];
+  size_t headerEnd = std::string::npos;
+  size_t contentLength = 0;
+  while (true) {
+    ssize_t got = recv(client, chunk, sizeof(chunk), 0);
+    if (got <= 0) {
+      return;
+    }
+    request.append(chunk, got);
+    if (headerEnd == std::string::npos) {
+      headerEnd = request.find("\r\n\r\n");
+      if (headerEnd == std::string::npos) {
+        continue;
+      }
+      size_t field = request.find("Content-Length:");
+      if (field != std::string::npos && field < headerEnd) {
+        contentLength = strtoul(request.c_str() + field + 15, nullptr, 10);
+      }
+    }
+    if (request.size() >= headerEnd + 4 + contentLength) {
+      break;
+    }
+  }
+
+  std::string path = request.substr(0, request.find("\r\n"));
+  std::string status = "200 OK";
+  std::string body;
+  if (path.find("/batch-checkin") != std::string::npos) {
+    int count = 0;
+    for (size_t at = request.find("\"bleUuid\""); at != std::string::npos; at = request.find("\"bleUuid\"", at + 1)) {
+      count++;
+    }
+    batches++;
+    if (batchReply == BATCH_UNAVAILABLE) {
+      status = "503 Service Unavailable";
+      body = "{\"success\":false,\"error\":\"unavailable\"}";
+    } else {
+      records += count;
+      body = batchReply == BATCH_MALFORMED
+                 ? "<html>upstream timeout</html>"
+                 : "{\"success\":true,\"processed\":" + std::to_string(count) + ",\"successful\":" +
+                       std::to_string(count) + ",\"failed\":0,\"serverMs\":0}";
+    }
+  } else if (path.find("/registered-devices") != std::string::npos) {
+    body = registered;
+  } else if (path.find("events") != std::string::npos) {
+    body = "{\"success\":true,\"events\":[{\"id\":\"event_01\",\"name\":\"Budget Lecture\","
+           "\"startTime\":0,\"endTime\":4102444800000,\"isActive\":true}],"
+           "\"event\":{\"id\":\"event_01\",\"name\":\"Budget Lecture\",\"isActive\":true},"
+           "\"deactivatedCount\":0}";
+  } else {
+    body = "{\"success\":true,\"status\":\"healthy\"}";
+  }
+  std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: application/json\r\nContent-Length: " +
+                         std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+  send(client, response.data(), response.size(), MSG_NOSIGNAL);
+}
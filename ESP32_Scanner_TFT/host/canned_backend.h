@@ -0,0 +1,50 @@
+#ifndef HOST_CANNED_BACKEND_H
+#define HOST_CANNED_BACKEND_H
+
+// In-process stand-in for the routes the firmware uses, answered with
+// fixed bodies on a loopback port, one request per connection. Runs on its
+// own thread, so its allocations never land in a firmware count. The
+// registered devices are the first phones of a StormSource.
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+class CannedBackend {
+public:
+  // How /batch-checkin answers
+  enum BatchReply {
+    BATCH_OK,           // 200, every record accepted
+    BATCH_UNAVAILABLE,  // 503, nothing stored
+    BATCH_MALFORMED     // 200, records stored, body is not JSON
+  };
+
+  explicit CannedBackend(int registeredPhones);
+  ~CannedBackend();
+
+  bool start();
+
+  uint16_t getPort() const { return port; }
+  void setBatchReply(BatchReply reply) { batchReply = reply; }
+  // Batch requests received, whatever the reply
+  unsigned long getBatches() const { return batches; }
+  // Records stored by batches answered with 200
+  unsigned long getRecords() const { return records; }
+
+private:
+  int registeredPhones;
+  int listener;
+  uint16_t port;
+  std::atomic<bool> running;
+  std::atomic<int> batchReply{BATCH_OK};
+  std::atomic<unsigned long> batches{0};
+  std::atomic<unsigned long> records{0};
+  std::string registered;
+  std::thread thread;
+
+  void serve();
+  void handle(int client);
+};
+
+#endif // HOST_CANNED_BACKEND_H
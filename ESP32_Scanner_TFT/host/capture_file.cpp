@@ -0,0 +1,174 @@
+#include "capture_file.h"
+#include "capture.h"
+
+#include <cstring>
+
+namespace {
+
+uint32_t getU32(const uint8_t* in) {
+  return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+} // namespace
+
+bool readCaptureFile(const char* path, std::vector<CaptureRecord>& records, std::string& error) {
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    error = std::string("cannot open ") + path;
+    return false;
+  }
+  std::vector<uint8_t> bytes;
+  uint8_t chunk[4096];
+  size_t got;
+  while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    bytes.insert(bytes.end(), chunk, chunk + got);
+  }
+  fclose(file);
+
+  size_t start = 0;
+  while (start + CAPTURE_HEADER_SIZE <= bytes.size() && memcmp(&bytes[start], CAPTURE_MAGIC, 4) != 0) {
+    start++;
+  }
+  if (start + CAPTURE_HEADER_SIZE > bytes.size()) {
+    error = "no capture header found";
+    return false;
+  }
+  const uint8_t* header = &bytes[start];
+  if (header[4] != CAPTURE_VERSION) {
+    error = "unsupported capture version " + std::to_string(header[4]);
+    return false;
+  }
+  uint32_t expected = getU32(header + 8);
+  size_t pos = start + header[5];
+  size_t end = pos + getU32(header + 12);
+  if (end > bytes.size()) {
+    end = bytes.size(); // truncated dump: keep the complete records
+  }
+
+  records.clear();
+  records.reserve(expected);
+  unsigned long long timeUs = 0;
+  while (pos + CAPTURE_RECORD_HEADER <= end) {
+    const uint8_t* in = &bytes[pos];
+    size_t length = in[11];
+    if (length > CAPTURE_MAX_PAYLOAD || pos + CAPTURE_RECORD_HEADER + length > end) {
+      break;
+    }
+    CaptureRecord record;
+    timeUs += records.empty() ? 0 : getU32(in);
+    record.timeUs = timeUs;
+    memcpy(record.address, in + 4, 6);
+    record.rssi = (int8_t)in[10];
+    record.payloadLength = (uint8_t)length;
+    memcpy(record.payload, in + CAPTURE_RECORD_HEADER, length);
+    records.push_back(record);
+    pos += CAPTURE_RECORD_HEADER + length;
+  }
+  if (records.size() != expected) {
+    error = "capture truncated: " + std::to_string(records.size()) + " of " + std::to_string(expected) + " records";
+  }
+  return true;
+}
+
+CaptureFileWriter::CaptureFileWriter() {
+  file = nullptr;
+  records = 0;
+  recordBytes = 0;
+  lastUs = 0;
+}
+
+CaptureFileWriter::~CaptureFileWriter() {
+  close();
+}
+
+bool CaptureFileWriter::open(const char* path) {
+  close();
+  file = fopen(path, "wb");
+  if (!file) {
+    return false;
+  }
+  uint8_t header[CAPTURE_HEADER_SIZE];
+  encodeCaptureHeader(header, 0, 0);
+  fwrite(header, 1, sizeof(header), file);
+  records = 0;
+  recordBytes = 0;
+  return true;
+}
+
+void CaptureFileWriter::write(const host::RawAdvertisement& advertisement) {
+  if (!file) {
+    return;
+  }
+  uint32_t deltaUs = records > 0 ? (uint32_t)(advertisement.timestampUs - lastUs) : 0;
+  uint8_t record[CAPTURE_RECORD_HEADER + CAPTURE_MAX_PAYLOAD];
+  size_t length = encodeCaptureRecord(record, deltaUs, advertisement.address, advertisement.rssi,
+                                      advertisement.payload, advertisement.payloadLength);
+  fwrite(record, 1, length, file);
+  records++;
+  recordBytes += length;
+  lastUs = advertisement.timestampUs;
+}
+
+bool CaptureFileWriter::close() {
+  if (!file) {
+    return false;
+  }
+  uint8_t header[CAPTURE_HEADER_SIZE];
+  encodeCaptureHeader(header, (uint32_t)records, (uint32_t)recordBytes);
+  fseek(file, 0, SEEK_SET);
+  fwrite(header, 1, sizeof(header), file);
+  bool ok = fclose(file) == 0;
+  file = nullptr;
+  return ok;
+}
+
+ReplaySource::ReplaySource(const std::vector<CaptureRecord>& captured)
+  : records(captured) {
+  position = 0;
+  loop = 0;
+  loops = 1;
+  startUs = 0;
+  loopUs = 0;
+  delivered = 0;
+}
+
+void ReplaySource::start(unsigned long long nowUs, int loopCount) {
+  position = 0;
+  loop = 0;
+  loops = loopCount;
+  startUs = nowUs;
+  // One typical interval of silence between passes
+  loopUs = getDurationUs() + 100000ULL;
+}
+
+bool ReplaySource::next(unsigned long long untilUs, host::RawAdvertisement& out) {
+  if (isFinished()) {
+    return false;
+  }
+  const CaptureRecord& record = records[position];
+  unsigned long long atUs = startUs + (unsigned long long)loop * loopUs + record.timeUs;
+  if (atUs > untilUs) {
+    return false;
+  }
+
+  out.timestampUs = atUs;
+  memcpy(out.address, record.address, sizeof(out.address));
+  out.rssi = record.rssi;
+  out.payloadLength = record.payloadLength;
+  memcpy(out.payload, record.payload, record.payloadLength);
+  delivered++;
+
+  if (++position == records.size()) {
+    position = 0;
+    loop++;
+  }
+  return true;
+}
+
+bool ReplaySource::isFinished() const {
+  return records.empty() || loop >= loops;
+}
+
+unsigned long long ReplaySource::getDurationUs() const {
+  return records.empty() ? 0 : records.back().timeUs;
+}
@@ -0,0 +1,88 @@
+#ifndef HOST_CAPTURE_FILE_H
+#define HOST_CAPTURE_FILE_H
+
+// Reading and writing advertisement capture files (format in capture.h),
+// and a host radio source that plays one back.
+
+#include "host_ble.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct CaptureRecord {
+  unsigned long long timeUs;  // Since the first record
+  uint8_t address[6];
+  int8_t rssi;
+  uint8_t payloadLength;
+  uint8_t payload[62];
+};
+
+// Loads a capture. Anything before the "BCAP" header is skipped, so a raw
+// serial log holding a 'c' dump can be read directly.
+bool readCaptureFile(const char* path, std::vector<CaptureRecord>& records, std::string& error);
+
+// Streams advertisements into a capture file; the header is completed on close
+class CaptureFileWriter {
+public:
+  CaptureFileWriter();
+  ~CaptureFileWriter();
+
+  bool open(const char* path);
+  void write(const host::RawAdvertisement& advertisement);
+  bool close();
+
+  unsigned long getRecords() const { return records; }
+
+private:
+  FILE* file;
+  unsigned long records;
+  unsigned long recordBytes;
+  unsigned long long lastUs;
+};
+
+// Passes advertisements through from another source, writing each one the
+// scanner receives to a capture file
+class RecordingSource : public host::AdvertisementSource {
+public:
+  RecordingSource(host::AdvertisementSource& inner, CaptureFileWriter& writer)
+    : inner(inner), writer(writer) {}
+
+  bool next(unsigned long long untilUs, host::RawAdvertisement& out) override {
+    if (!inner.next(untilUs, out)) {
+      return false;
+    }
+    writer.write(out);
+    return true;
+  }
+
+private:
+  host::AdvertisementSource& inner;
+  CaptureFileWriter& writer;
+};
+
+// Plays records back on the host clock, `loops` times over. Timing is
+// kept relative to start(); with the virtual clock that is as fast as the
+// scanner can take them.
+class ReplaySource : public host::AdvertisementSource {
+public:
+  explicit ReplaySource(const std::vector<CaptureRecord>& records);
+
+  void start(unsigned long long startUs, int loops);
+  bool next(unsigned long long untilUs, host::RawAdvertisement& out) override;
+
+  bool isFinished() const;
+  unsigned long long getDelivered() const { return delivered; }
+  unsigned long long getDurationUs() const;
+
+private:
+  const std::vector<CaptureRecord>& records;
+  size_t position;
+  int loop;
+  int loops;
+  unsigned long long startUs;
+  unsigned long long loopUs;
+  unsigned long long delivered;
+};
+
+#endif // HOST_CAPTURE_FILE_H
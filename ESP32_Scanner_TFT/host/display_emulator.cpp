@@ -0,0 +1,280 @@
+// Host display emulator: drives DisplayManager through every screen, writes
+// each resulting frame as PPM/PNG and reports what it cost on the SPI bus.
+// With --golden the frames are compared pixel for pixel against reference
+// images so layout changes show up as a failing test. A missing or
+// different frame fails; the frame and a diff image are left in --out.
+// Only --update-golden writes into the golden directory.
+//
+//   display_emulator [--out DIR] [--golden DIR] [--update-golden]
+
+#include "display_manager.h"
+#include "scanner_metrics.h"
+#include "log.h"
+#include "heap_monitor.h"
+#include "host_runtime.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+
+DisplayManager display;
+ScannerMetrics scannerMetrics;
+Logger logger;
+HeapMonitor heapMonitor;
+
+namespace {
+
+const char* outDir = "display_frames";
+const char* goldenDir = nullptr;
+bool updateGolden = false;
+int failures = 0;
+
+Event sampleEvents[40];
+char sampleNames[40][32];
+
+Adafruit_ST7735& panel() {
+  return *Adafruit_ST7735::lastCreated();
+}
+
+// Runs one display frame and waits for the flush task to finish sending it
+void settle(unsigned long advanceMicros) {
+  host::advanceClock(advanceMicros);
+  display.update();
+  while (display.isFlushing()) {
+    std::this_thread::yield();
+  }
+}
+
+bool writePPM(const std::string& path, const std::string& pixels, int width, int height) {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f) {
+    return false;
+  }
+  fprintf(f, "P6 %d %d 255\n", width, height);
+  bool ok = fwrite(pixels.data(), 1, pixels.size(), f) == pixels.size();
+  fclose(f);
+  return ok;
+}
+
+bool readPPM(const std::string& path, std::string& pixels, int& width, int& height) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) {
+    return false;
+  }
+  int maxValue = 0;
+  bool ok = fscanf(f, "P6 %d %d %d", &width, &height, &maxValue) == 3 && fgetc(f) != EOF;
+  if (ok) {
+    pixels.resize((size_t)width * height * 3);
+    ok = fread(&pixels[0], 1, pixels.size(), f) == pixels.size();
+  }
+  fclose(f);
+  return ok;
+}
+
+void compareGolden(const char* name, const std::string& framePath) {
+  std::string goldenPath = std::string(goldenDir) + "/" + name + ".ppm";
+  std::string expected, actual;
+  int ew = 0, eh = 0, aw = 0, ah = 0;
+
+  if (updateGolden) {
+    panel().writePPM(goldenPath.c_str());
+    printf("  golden %s recorded\n", goldenPath.c_str());
+    return;
+  }
+  if (!readPPM(goldenPath, expected, ew, eh)) {
+    printf("  FAIL %s: no golden %s; candidate in %s\n", name, goldenPath.c_str(), framePath.c_str());
+    failures++;
+    return;
+  }
+  readPPM(framePath, actual, aw, ah);
+  if (aw != ew || ah != eh) {
+    printf("  FAIL %s: size %dx%d, golden %dx%d\n", name, aw, ah, ew, eh);
+    failures++;
+    return;
+  }
+  // Diff image: differing pixels red, the rest a dimmed grey of the golden
+  std::string diff(actual.size(), '\0');
+  unsigned long differing = 0;
+  for (size_t i = 0; i < actual.size(); i += 3) {
+    if (memcmp(&actual[i], &expected[i], 3) != 0) {
+      differing++;
+      diff[i] = (char)255;
+    } else {
+      char grey = (char)(((uint8_t)expected[i] + (uint8_t)expected[i + 1] + (uint8_t)expected[i + 2]) / 12);
+      diff[i] = diff[i + 1] = diff[i + 2] = grey;
+    }
+  }
+  if (differing > 0) {
+    std::string diffPath = std::string(outDir) + "/" + name + ".diff.ppm";
+    writePPM(diffPath, diff, aw, ah);
+    printf("  FAIL %s: %lu pixels differ from %s; see %s\n", name, differing, goldenPath.c_str(),
+           diffPath.c_str());
+    failures++;
+  }
+}
+
+// Renders the current state, then records the frame and its bus cost
+void capture(const char* name, unsigned long advanceMicros = 100000) {
+  panel().resetStats();
+  settle(advanceMicros);
+  const TFTFrameStats& stats = panel().getStats();
+  printf("%-18s %8lu %8lu %6lu %8.2f\n", name, stats.pixelsWritten, stats.spiBytes,
+         stats.addrWindows, Adafruit_ST7735::bytesToMs(stats.spiBytes));
+
+  std::string base = std::string(outDir) + "/" + name;
+  panel().writePPM((base + ".ppm").c_str());
+  panel().writePNG((base + ".png").c_str());
+  if (goldenDir) {
+    compareGolden(name, base + ".ppm");
+  }
+}
+
+// Hash of every printable glyph as this GFX library draws it. Frames are
+// only comparable between builds with the same font.
+uint32_t fontFingerprint() {
+  GFXcanvas16 canvas(6 * 95, 8);
+  canvas.setTextWrap(false);
+  canvas.setTextColor(0xFFFF, 0x0000);
+  canvas.setCursor(0, 0);
+  for (char c = 32; c < 127; c++) {
+    canvas.print(c);
+  }
+  uint32_t hash = 2166136261u;
+  const uint16_t* buffer = canvas.getBuffer();
+  for (int i = 0; i < 6 * 95 * 8; i++) {
+    hash = (hash ^ buffer[i]) * 16777619u;
+  }
+  return hash;
+}
+
+// Records the font next to the goldens, or checks it before comparing
+bool checkFont() {
+  std::string path = std::string(goldenDir) + "/font.txt";
+  unsigned int current = fontFingerprint();
+  if (updateGolden) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (f) {
+      fprintf(f, "%08x\n", current);
+      fclose(f);
+    }
+    return true;
+  }
+  unsigned int recorded = 0;
+  FILE* f = fopen(path.c_str(), "r");
+  bool found = f && fscanf(f, "%x", &recorded) == 1;
+  if (f) {
+    fclose(f);
+  }
+  if (!found) {
+    printf("FAIL: no golden images in %s; record them with --update-golden\n", goldenDir);
+    return false;
+  }
+  if (recorded != current) {
+    printf("FAIL: goldens were recorded with GFX font %08x, this build draws %08x.\n"
+           "Build against the same Adafruit GFX Library, or re-record with --update-golden.\n",
+           recorded, current);
+    return false;
+  }
+  return true;
+}
+
+void loadSampleEvents() {
+  for (int i = 0; i < 40; i++) {
+    snprintf(sampleNames[i], sizeof(sampleNames[i]), "Lecture %02d - Room %d", i + 1, 100 + i);
+    sampleEvents[i].id = sampleNames[i];
+    sampleEvents[i].name = sampleNames[i];
+    sampleEvents[i].isActive = true;
+  }
+}
+
+void runScenarios() {
+  display.showWiFiConnecting("CampusNet");
+  capture("wifi_connecting");
+
+  display.showWiFiConnected("192.168.1.42");
+  capture("wifi_connected");
+
+  display.showLoading("Loading events");
+  capture("loading");
+  // The firmware re-posts the message while waiting; each post steps the dots
+  display.showLoading("Loading events");
+  capture("loading_anim");
+
+  display.showEventList(sampleEvents, 5);
+  capture("event_list");
+
+  display.navigateDown();
+  capture("event_list_nav");
+
+  display.showEventList(sampleEvents, 40);
+  for (int i = 0; i < MAX_MENU_ITEMS; i++) {
+    display.navigateDown();
+  }
+  capture("event_list_scroll");
+
+  display.showEventSelected(sampleEvents[7].name);
+  capture("event_selected");
+
+  display.showScanning(sampleEvents[7].name);
+  capture("scanning");
+
+  display.updateScanResults(17);
+  capture("scanning_count");
+
+  // Page over to the dashboard and feed it one second of traffic
+  display.navigateUp();
+  capture("dashboard_enter");
+  scannerMetrics.advertisementsSeen += 340;
+  scannerMetrics.advertisementsMatched += 45;
+  scannerMetrics.studentsPresent = 17;
+  scannerMetrics.uploadPending = 3;
+  scannerMetrics.lastUploadMs = 412;
+  capture("dashboard", DASHBOARD_REFRESH_MS * 1000UL);
+
+  display.showError("Upload failed: 503");
+  capture("error");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      outDir = argv[++i];
+    } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+      goldenDir = argv[++i];
+    } else if (strcmp(argv[i], "--update-golden") == 0) {
+      updateGolden = true;
+    } else {
+      fprintf(stderr, "usage: %s [--out DIR] [--golden DIR] [--update-golden]\n", argv[0]);
+      return 2;
+    }
+  }
+  mkdir(outDir, 0755);
+  if (goldenDir && updateGolden) {
+    mkdir(goldenDir, 0755);
+  }
+
+  host::setSerialOutput(nullptr);
+  host::useVirtualClock(true);
+  host::setHeapModel(327680, [] { return (uint32_t)182000; }, [] { return (uint32_t)110592; });
+  loadSampleEvents();
+
+  if (!display.begin()) {
+    fprintf(stderr, "display init failed\n");
+    return 1;
+  }
+  if (goldenDir && !checkFont()) {
+    return 1;
+  }
+  printf("%-18s %8s %8s %6s %8s\n", "frame", "pixels", "spi_B", "wins", "spi_ms");
+  runScenarios();
+
+  if (failures > 0) {
+    printf("%d frame(s) differ from golden images\n", failures);
+    return 1;
+  }
+  return 0;
+}
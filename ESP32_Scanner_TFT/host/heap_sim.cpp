@@ -0,0 +1,196 @@
+#include "heap_sim.h"
+
+#include <cstring>
+
+HeapSimulator::HeapSimulator(uint32_t size) {
+  heapSize = size;
+  freeBytes = size;
+  minFreeBytes = size;
+  liveBlocks = 0;
+  failures = 0;
+  untracked = 0;
+  memset(blocks, 0, sizeof(blocks));
+  extents[0].offset = 0;
+  extents[0].size = size;
+  extentCount = 1;
+}
+
+void HeapSimulator::lock() {
+  while (busy.test_and_set(std::memory_order_acquire)) {
+  }
+}
+
+void HeapSimulator::unlock() {
+  busy.clear(std::memory_order_release);
+}
+
+uint32_t HeapSimulator::slotFor(uintptr_t ptr) {
+  uint64_t hash = (uint64_t)(ptr >> 4) * 0x9E3779B97F4A7C15ULL;
+  return (uint32_t)(hash >> 32) & (BLOCK_SLOTS - 1);
+}
+
+// First fit, carved from the front of the lowest extent that is big enough
+bool HeapSimulator::take(uint32_t size, uint32_t& offset) {
+  for (int i = 0; i < extentCount; i++) {
+    if (extents[i].size < size) {
+      continue;
+    }
+    offset = extents[i].offset;
+    extents[i].offset += size;
+    extents[i].size -= size;
+    if (extents[i].size == 0) {
+      memmove(&extents[i], &extents[i + 1], (extentCount - i - 1) * sizeof(Extent));
+      extentCount--;
+    }
+    return true;
+  }
+  return false;
+}
+
+void HeapSimulator::release(uint32_t offset, uint32_t size) {
+  // First extent after the freed range
+  int lo = 0;
+  int hi = extentCount;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (extents[mid].offset < offset) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  bool joinsPrevious = lo > 0 && extents[lo - 1].offset + extents[lo - 1].size == offset;
+  bool joinsNext = lo < extentCount && offset + size == extents[lo].offset;
+
+  if (joinsPrevious && joinsNext) {
+    extents[lo - 1].size += size + extents[lo].size;
+    memmove(&extents[lo], &extents[lo + 1], (extentCount - lo - 1) * sizeof(Extent));
+    extentCount--;
+  } else if (joinsPrevious) {
+    extents[lo - 1].size += size;
+  } else if (joinsNext) {
+    extents[lo].offset = offset;
+    extents[lo].size += size;
+  } else if (extentCount < MAX_EXTENTS) {
+    memmove(&extents[lo + 1], &extents[lo], (extentCount - lo) * sizeof(Extent));
+    extents[lo].offset = offset;
+    extents[lo].size = size;
+    extentCount++;
+  }
+  // else: too many holes to track; the range is lost, as in a badly
+  // fragmented heap
+}
+
+void HeapSimulator::allocated(void* ptr, size_t requested) {
+  uint32_t size = (uint32_t)((requested + 3) & ~(size_t)3) + BLOCK_OVERHEAD;
+  if (size < MIN_BLOCK) {
+    size = MIN_BLOCK;
+  }
+
+  lock();
+  uint32_t offset;
+  if (!take(size, offset)) {
+    failures++;
+    unlock();
+    return;
+  }
+  uint32_t slot = slotFor((uintptr_t)ptr);
+  uint32_t probes = 0;
+  while (blocks[slot].ptr != 0 && probes < BLOCK_SLOTS / 2) {
+    slot = (slot + 1) & (BLOCK_SLOTS - 1);
+    probes++;
+  }
+  if (blocks[slot].ptr != 0) {
+    release(offset, size);
+    untracked++;
+    unlock();
+    return;
+  }
+  blocks[slot].ptr = (uintptr_t)ptr;
+  blocks[slot].offset = offset;
+  blocks[slot].size = size;
+  liveBlocks++;
+  freeBytes -= size;
+  if (freeBytes < minFreeBytes) {
+    minFreeBytes = freeBytes;
+  }
+  unlock();
+}
+
+void HeapSimulator::freed(void* ptr) {
+  lock();
+  uint32_t slot = slotFor((uintptr_t)ptr);
+  while (blocks[slot].ptr != 0 && blocks[slot].ptr != (uintptr_t)ptr) {
+    slot = (slot + 1) & (BLOCK_SLOTS - 1);
+  }
+  if (blocks[slot].ptr == 0) {
+    // Allocated before the model was attached, or never fitted
+    unlock();
+    return;
+  }
+  release(blocks[slot].offset, blocks[slot].size);
+  freeBytes += blocks[slot].size;
+  liveBlocks--;
+
+  // Backward-shift deletion keeps probe chains intact without tombstones
+  uint32_t hole = slot;
+  uint32_t next = (hole + 1) & (BLOCK_SLOTS - 1);
+  while (blocks[next].ptr != 0) {
+    uint32_t home = slotFor(blocks[next].ptr);
+    // Move the entry back if its home is not in (hole, next]
+    if (((next - home) & (BLOCK_SLOTS - 1)) >= ((next - hole) & (BLOCK_SLOTS - 1))) {
+      blocks[hole] = blocks[next];
+      hole = next;
+    }
+    next = (next + 1) & (BLOCK_SLOTS - 1);
+  }
+  blocks[hole].ptr = 0;
+  unlock();
+}
+
+uint32_t HeapSimulator::getFreeBytes() {
+  lock();
+  uint32_t value = freeBytes;
+  unlock();
+  return value;
+}
+
+uint32_t HeapSimulator::getLargestBlock() {
+  lock();
+  uint32_t largest = 0;
+  for (int i = 0; i < extentCount; i++) {
+    if (extents[i].size > largest) {
+      largest = extents[i].size;
+    }
+  }
+  unlock();
+  return largest > BLOCK_OVERHEAD ? largest - BLOCK_OVERHEAD : 0;
+}
+
+uint32_t HeapSimulator::getMinFreeBytes() {
+  lock();
+  uint32_t value = minFreeBytes;
+  unlock();
+  return value;
+}
+
+uint32_t HeapSimulator::getLiveBlocks() {
+  lock();
+  uint32_t value = liveBlocks;
+  unlock();
+  return value;
+}
+
+unsigned long HeapSimulator::getFailures() {
+  lock();
+  unsigned long value = failures;
+  unlock();
+  return value;
+}
+
+unsigned long HeapSimulator::getUntracked() {
+  lock();
+  unsigned long value = untracked;
+  unlock();
+  return value;
+}
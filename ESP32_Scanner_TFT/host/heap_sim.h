@@ -0,0 +1,70 @@
+#ifndef HOST_HEAP_SIM_H
+#define HOST_HEAP_SIM_H
+
+// First-fit model of the ESP32 internal heap, fed with the host process's
+// real allocations through the malloc hooks. glibc does not fragment the
+// way a ~100 KB device heap does, so long runs replay every malloc and
+// free into this model to watch free bytes and the largest block drift.
+
+#include "alloc_hooks.h"
+
+#include <atomic>
+#include <cstdint>
+
+class HeapSimulator : public host::AllocationObserver {
+public:
+  explicit HeapSimulator(uint32_t heapSize);
+
+  void allocated(void* ptr, size_t size) override;
+  void freed(void* ptr) override;
+
+  uint32_t getHeapSize() const { return heapSize; }
+  uint32_t getFreeBytes();
+  uint32_t getLargestBlock();
+  uint32_t getMinFreeBytes();
+  uint32_t getLiveBlocks();
+  // Allocations the modelled heap could not satisfy; each would have
+  // failed on the device
+  unsigned long getFailures();
+  // Allocations that were not modelled because the block table was full
+  unsigned long getUntracked();
+
+private:
+  static const uint32_t BLOCK_SLOTS = 1 << 16;  // Power of two
+  static const int MAX_EXTENTS = 8192;
+  static const uint32_t BLOCK_OVERHEAD = 4;     // multi_heap block header
+  static const uint32_t MIN_BLOCK = 12;
+
+  struct Block {
+    uintptr_t ptr;    // 0 = empty slot
+    uint32_t offset;
+    uint32_t size;
+  };
+  struct Extent {
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  uint32_t heapSize;
+  uint32_t freeBytes;
+  uint32_t minFreeBytes;
+  uint32_t liveBlocks;
+  unsigned long failures;
+  unsigned long untracked;
+
+  // Open addressing over host pointers, linear probing
+  Block blocks[BLOCK_SLOTS];
+  // Free extents sorted by offset, never adjacent
+  Extent extents[MAX_EXTENTS];
+  int extentCount;
+
+  std::atomic_flag busy = ATOMIC_FLAG_INIT;
+
+  void lock();
+  void unlock();
+  static uint32_t slotFor(uintptr_t ptr);
+  bool take(uint32_t size, uint32_t& offset);
+  void release(uint32_t offset, uint32_t size);
+};
+
+#endif // HOST_HEAP_SIM_H
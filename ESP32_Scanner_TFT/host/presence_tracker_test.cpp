@@ -0,0 +1,152 @@
+// PresenceTracker against hand-written RSSI traces: one sighting of one
+// registered device per 5 s scan, checked against the changes queued.
+//
+//     ./build-host/presence_tracker_test
+
+#include <cstdio>
+#include <vector>
+
+#include "presence_tracker.h"
+#include "scanner_metrics.h"
+
+namespace {
+
+const uint32_t SCAN_MS = 5000;
+const uint32_t START_MS = 100000;
+
+int failures = 0;
+
+#define CHECK(condition)                                                    \
+  do {                                                                      \
+    if (!(condition)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                           \
+    }                                                                       \
+  } while (0)
+
+// One scan holding at most one sighting
+struct Scan {
+  uint32_t hash = 0;
+  int16_t ordinal = 0;
+  int8_t rssi = 0;
+  uint32_t timestamp = 0;
+  uint8_t address[1][6] = {};
+
+  SightingView view(int count) const {
+    SightingView v;
+    v.uuidHash = &hash;
+    v.ordinal = &ordinal;
+    v.rssi = &rssi;
+    v.timestamp = &timestamp;
+    v.address = address;
+    v.count = count;
+    return v;
+  }
+};
+
+// Large enough that it does not belong on the stack
+PresenceTracker tracker;
+
+int countChanges(PresenceChange change) {
+  int count = 0;
+  for (int i = 0; i < tracker.getPendingCount(); i++) {
+    if (tracker.getPending()[i].change == change) {
+      count++;
+    }
+  }
+  return count;
+}
+
+// Feeds one sighting of `ordinal` per scan; returns the time after the last
+uint32_t replay(int16_t ordinal, const std::vector<int>& trace, uint32_t nowMs) {
+  Scan scan;
+  scan.ordinal = ordinal;
+  for (int rssi : trace) {
+    scan.rssi = (int8_t)rssi;
+    scan.timestamp = nowMs;
+    tracker.update(scan.view(1), nowMs);
+    nowMs += SCAN_MS;
+  }
+  return nowMs;
+}
+
+// A phone at the doorway: strong once, then weak with single strong
+// packets. The hysteresis must not turn each strong packet into an arrival.
+void testDoorway() {
+  tracker.reset();
+  replay(3, {-75, -95, -95, -95, -95, -79, -95, -95, -79, -95, -95, -79}, START_MS);
+  CHECK(countChanges(PRESENCE_ARRIVAL) == 1);
+  CHECK(countChanges(PRESENCE_DEPARTURE) == 1);
+  CHECK(tracker.getPresentCount() == 0);
+}
+
+// Weak signal exit, then the phone really comes back
+void testReturnAfterExit() {
+  tracker.reset();
+  replay(4, {-70, -95, -95, -95, -95, -95, -70, -70, -70}, START_MS);
+  CHECK(countChanges(PRESENCE_ARRIVAL) == 2);
+  CHECK(countChanges(PRESENCE_DEPARTURE) == 1);
+  CHECK(tracker.getPresentCount() == 1);
+}
+
+// Unseen for PRESENCE_DEPART_MS: leaves at the time last seen
+void testTimeout() {
+  tracker.reset();
+  uint32_t nowMs = replay(5, {-60, -60, -60}, START_MS);
+  uint32_t lastSeen = nowMs - SCAN_MS;
+  Scan empty;
+
+  tracker.update(empty.view(0), lastSeen + PRESENCE_DEPART_MS - 1);
+  CHECK(countChanges(PRESENCE_DEPARTURE) == 0);
+  CHECK(tracker.getPresentCount() == 1);
+
+  tracker.update(empty.view(0), lastSeen + PRESENCE_DEPART_MS);
+  CHECK(countChanges(PRESENCE_DEPARTURE) == 1);
+  CHECK(tracker.getPresentCount() == 0);
+  const PresenceEvent& departure = tracker.getPending()[tracker.getPendingCount() - 1];
+  CHECK(departure.ordinal == 5);
+  CHECK(departure.timeMs == lastSeen);
+  CHECK(departure.dwellMs == lastSeen - START_MS);
+
+  // After a timeout the average starts over from the next sighting
+  replay(5, {-60}, lastSeen + PRESENCE_DEPART_MS + SCAN_MS);
+  CHECK(countChanges(PRESENCE_ARRIVAL) == 2);
+}
+
+void testDepartAllAndAcknowledge() {
+  tracker.reset();
+  replay(1, {-60}, START_MS);
+  replay(2, {-60}, START_MS);
+  CHECK(tracker.departAll(START_MS + SCAN_MS) == 2);
+  CHECK(tracker.getPendingCount() == 4);
+
+  tracker.acknowledge(3);
+  CHECK(tracker.getPendingCount() == 1);
+  CHECK(tracker.getPending()[0].change == PRESENCE_DEPARTURE);
+  CHECK(tracker.getPending()[0].ordinal == 2);
+  CHECK(tracker.reset() == 1);
+}
+
+void testUntrackedOrdinal() {
+  tracker.reset();
+  uint32_t before = scannerMetrics.presenceUntracked;
+  replay(PRESENCE_MAX_DEVICES, {-60}, START_MS);
+  CHECK(tracker.getPendingCount() == 0);
+  CHECK(scannerMetrics.presenceUntracked == before + 1);
+}
+
+} // namespace
+
+int main() {
+  testDoorway();
+  testReturnAfterExit();
+  testTimeout();
+  testDepartAllAndAcknowledge();
+  testUntrackedOrdinal();
+  if (failures > 0) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("presence_tracker_test: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,178 @@
+// Presence uploads through the sketch against the canned backend: changes
+// whose final upload fails at stop are discarded while their registration
+// table is still loaded, so selecting the next event neither crashes nor
+// sends them against the wrong table; a stored batch with an unreadable
+// reply is not sent again. Ends with a short ENTER press stopping the scan.
+//
+//     ./build-host/presence_upload_test [--verbose]
+
+#include "canned_backend.h"
+#include "sketch_runner.h"
+#include "storm_source.h"
+#include "backend_client.h"
+#include "presence_tracker.h"
+#include "scanner_metrics.h"
+#include "log.h"
+#include "hardware_config.h"
+#include "host_runtime.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const int REGISTERED_PHONES = 8;
+const unsigned long long SCAN_US = 5000000ULL;
+
+int failures = 0;
+
+#define CHECK(condition)                                                    \
+  do {                                                                      \
+    if (!(condition)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                           \
+    }                                                                       \
+  } while (0)
+
+void scanCycles(int cycles) {
+  for (int i = 0; i < cycles; i++) {
+    host::advanceClock(SCAN_US);
+    sketch::performScan();
+  }
+}
+
+// A change must not be serialized without the table its ordinal indexes
+void testBodyNeedsTable() {
+  const char* uuids[] = { "ATT-USER-00000000" };
+  PresenceEvent change;
+  memset(&change, 0, sizeof(change));
+  change.change = PRESENCE_ARRIVAL;
+  char body[512];
+  int written = -1;
+
+  CHECK(BackendClient::buildPresenceBody(&change, 1, uuids, 1, "event_01", "test", 0, 0,
+                                         body, sizeof(body), written) > 0);
+  CHECK(written == 1);
+  CHECK(BackendClient::buildPresenceBody(&change, 1, nullptr, 0, "event_01", "test", 0, 0,
+                                         body, sizeof(body), written) == 0);
+  CHECK(written == 0);
+  change.ordinal = 1;
+  CHECK(BackendClient::buildPresenceBody(&change, 1, uuids, 1, "event_01", "test", 0, 0,
+                                         body, sizeof(body), written) == 0);
+  change.ordinal = -1;
+  CHECK(BackendClient::buildPresenceBody(&change, 1, uuids, 1, "event_01", "test", 0, 0,
+                                         body, sizeof(body), written) == 0);
+}
+
+// The final upload fails, then the next event is selected
+void testFailedStopThenNextEvent(CannedBackend& backend) {
+  scanCycles(3);
+  CHECK(backend.getRecords() > 0);
+  CHECK(presence.getPresentCount() > 0);
+  CHECK(presence.getPendingCount() == 0);
+
+  backend.setBatchReply(CannedBackend::BATCH_UNAVAILABLE);
+  uint32_t discardedBefore = scannerMetrics.presenceDiscarded;
+  unsigned long recordsBefore = backend.getRecords();
+  sketch::requestStop();
+  scanCycles(1);
+  CHECK(sketch::isSelectingEvent());
+  CHECK(presence.getPendingCount() == 0);
+  CHECK(scannerMetrics.presenceDiscarded > discardedBefore);
+  CHECK(backend.getRecords() == recordsBefore);
+
+  backend.setBatchReply(CannedBackend::BATCH_OK);
+  CHECK(sketch::selectEvent(0));
+  CHECK(backend.getRecords() == recordsBefore);
+  scanCycles(3);
+  CHECK(backend.getRecords() > recordsBefore);
+  CHECK(presence.getPendingCount() == 0);
+}
+
+// A 2xx whose body does not parse was still stored; nothing is resent
+void testMalformedReplyIsAcknowledged(CannedBackend& backend) {
+  backend.setBatchReply(CannedBackend::BATCH_MALFORMED);
+  sketch::resetPresence();
+  unsigned long batchesBefore = backend.getBatches();
+  unsigned long recordsBefore = backend.getRecords();
+  scanCycles(1);
+  CHECK(backend.getBatches() == batchesBefore + 1);
+  CHECK(backend.getRecords() == recordsBefore + REGISTERED_PHONES);
+  CHECK(presence.getPendingCount() == 0);
+
+  backend.setBatchReply(CannedBackend::BATCH_OK);
+  scanCycles(1);
+  CHECK(backend.getBatches() == batchesBefore + 1);
+  CHECK(backend.getRecords() == recordsBefore + REGISTERED_PHONES);
+}
+
+// A short ENTER press while scanning stops, as the screen says
+void testShortPressStops() {
+  host::setPinLevel(BUTTON_ENTER, LOW);
+  host::advanceClock(100000ULL);
+  sketch::loopOnce();
+  host::setPinLevel(BUTTON_ENTER, HIGH);
+  unsigned long long deadlineUs = host::clockMicros() + 4 * SCAN_US;
+  while (!sketch::isSelectingEvent() && host::clockMicros() < deadlineUs) {
+    host::advanceClock(100000ULL);
+    sketch::loopOnce();
+  }
+  CHECK(sketch::isSelectingEvent());
+  CHECK(presence.getPresentCount() == 0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  bool verbose = argc > 1 && strcmp(argv[1], "--verbose") == 0;
+
+  testBodyNeedsTable();
+
+  CannedBackend backend(REGISTERED_PHONES);
+  if (!backend.start()) {
+    fprintf(stderr, "cannot start the canned backend\n");
+    return 1;
+  }
+  char url[64];
+  snprintf(url, sizeof(url), "http://127.0.0.1:%u/http", backend.getPort());
+
+  host::useVirtualClock(true);
+  if (!verbose) {
+    host::setSerialOutput(nullptr);
+  }
+  sketch::setup();
+  sketch::setBackendUrl(url);
+
+  // Menu, then the first event; give up after ten minutes of firmware time
+  unsigned long long deadlineUs = host::clockMicros() + 600000000ULL;
+  while (!sketch::isSelectingEvent() && host::clockMicros() < deadlineUs) {
+    sketch::loopOnce();
+  }
+  if (!sketch::selectEvent(0)) {
+    fprintf(stderr, "could not start scanning (state %s)\n", sketch::stateName());
+    return 1;
+  }
+
+  // Every registered phone close enough to arrive on its first scans
+  StormConfig config;
+  config.phones = REGISTERED_PHONES;
+  config.beacons = 0;
+  config.rssiMean = -55.0;
+  config.rssiSpread = 2.0;
+  StormSource phones(config);
+  host::setAdvertisementSource(&phones);
+  phones.skipUntil(host::clockMicros());
+
+  testFailedStopThenNextEvent(backend);
+  testMalformedReplyIsAcknowledged(backend);
+  testShortPressStops();
+
+  host::setAdvertisementSource(nullptr);
+  logger.flush();
+  if (failures > 0) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("presence_upload_test: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,505 @@
+// Microbenchmarks for the scanner hot paths: UUID extraction, the
+// attendance filter, per-scan dedupe, registration lookup, batch body
+// serialization and /registered-devices parsing. Each case is timed over
+// several repetitions and the median is reported; --json writes the
+// results for host/bench_compare.py.
+//
+//   scanner_bench [--json FILE] [--filter TEXT] [--min-time S] [--repetitions N]
+
+#include "ble_scanner.h"
+#include "event_manager.h"
+#include "backend_client.h"
+#include "sighting_buffer.h"
+#include "scanner_metrics.h"
+#include "log.h"
+#include "heap_monitor.h"
+#include "host_runtime.h"
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The firmware globals these sources reference; the sketch is not linked
+BLEScanner bleScanner;
+EventManager events;
+ScannerMetrics scannerMetrics;
+Logger logger;
+HeapMonitor heapMonitor;
+bool stopScanRequested = false;
+
+// Reaches the private per-advertisement steps of BLEScanner
+class ScannerBenchmark {
+public:
+  typedef BLEScanner::AdvertisementFields Fields;
+
+  // Payload parse plus extraction, as the callback does it
+  static size_t extractUUID(BLEAdvertisedDevice& device, char* out, size_t outSize) {
+    Fields fields = parse(device);
+    return bleScanner.extractUUID(fields, out, outSize);
+  }
+  // Both halves of the filter, as on an address cache miss
+  static bool shouldIncludeDevice(BLEAdvertisedDevice& device, const Fields& fields, const char* uuid, uint32_t hash) {
+    return bleScanner.shouldIncludeDevice(device, bleScanner.isAttendanceAdvertisement(fields, uuid), hash, 0);
+  }
+  static PayloadScreen screen(BLEAdvertisedDevice& device) {
+    return BLEScanner::screenPayload(device.getPayload(), device.getPayloadLength());
+  }
+  static Fields parse(BLEAdvertisedDevice& device) {
+    Fields fields;
+    BLEScanner::parseAdvertisement(device, fields);
+    return fields;
+  }
+  static void onDeviceFound(BLEAdvertisedDevice& device) {
+    bleScanner.onDeviceFound(device);
+  }
+  static SightingBuffer& sightings() {
+    return bleScanner.sightings;
+  }
+  static AddressCache& addressCache() {
+    return bleScanner.addressCache;
+  }
+};
+
+namespace {
+
+struct Result {
+  std::string name;
+  unsigned long long iterations;
+  int repetitions;
+  double nsPerOp;   // Median over repetitions
+  double minNs;
+  double maxNs;
+  int itemsPerOp;
+};
+
+double minTime = 0.2;
+int repetitions = 5;
+const char* filter = nullptr;
+std::vector<Result> results;
+
+template <class T>
+inline void keep(const T& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+// `body(n)` runs the operation n times
+void run(const std::string& name, int itemsPerOp, const std::function<void(unsigned long long)>& body) {
+  if (filter && name.find(filter) == std::string::npos) {
+    return;
+  }
+  typedef std::chrono::steady_clock Clock;
+
+  // Grow the iteration count until one pass takes a tenth of --min-time
+  unsigned long long iterations = 1;
+  double seconds = 0;
+  while (true) {
+    Clock::time_point start = Clock::now();
+    body(iterations);
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (seconds >= minTime / 10 || iterations >= (1ULL << 40)) {
+      break;
+    }
+    iterations *= seconds > 0 ? std::min(10.0, std::max(2.0, minTime / 10 / seconds)) : 10;
+  }
+  // Then scale it so each repetition lasts about --min-time
+  if (seconds < minTime) {
+    iterations = (unsigned long long)std::max(1.0, iterations * minTime / std::max(seconds, 1e-9));
+  }
+
+  std::vector<double> samples;
+  for (int r = 0; r < repetitions; r++) {
+    Clock::time_point start = Clock::now();
+    body(iterations);
+    samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations);
+  }
+  std::sort(samples.begin(), samples.end());
+
+  Result result;
+  result.name = name;
+  result.iterations = iterations;
+  result.repetitions = repetitions;
+  result.nsPerOp = samples[samples.size() / 2];
+  result.minNs = samples.front();
+  result.maxNs = samples.back();
+  result.itemsPerOp = itemsPerOp;
+  results.push_back(result);
+
+  printf("%-44s %12.1f ns/op %10.2f ns/item %12llu iters  (min %.1f, max %.1f)\n", name.c_str(),
+         result.nsPerOp, result.nsPerOp / itemsPerOp, iterations, result.minNs, result.maxNs);
+  fflush(stdout);
+}
+
+// --- advertisements ----------------------------------------------------
+
+std::string phoneUuid(int index) {
+  char uuid[24];
+  snprintf(uuid, sizeof(uuid), "ATT-USER-%08X", (unsigned)(0x1000 + index));
+  return uuid;
+}
+
+void appendAd(std::vector<uint8_t>& payload, uint8_t type, const void* data, size_t length) {
+  payload.push_back((uint8_t)(length + 1));
+  payload.push_back(type);
+  payload.insert(payload.end(), (const uint8_t*)data, (const uint8_t*)data + length);
+}
+
+BLEAdvertisedDevice makeDevice(const std::vector<uint8_t>& payload, int rssi, uint8_t addressByte) {
+  uint8_t address[6] = { 0xC0, 0x11, 0x22, 0x33, 0x44, addressByte };
+  return BLEAdvertisedDevice(address, rssi, payload.data(), payload.size());
+}
+
+enum PhoneFormat { MANUFACTURER, SERVICE_DATA, NAME };
+
+BLEAdvertisedDevice phone(int index, PhoneFormat format, int rssi = -60) {
+  std::vector<uint8_t> payload;
+  uint8_t flags = 0x06;
+  appendAd(payload, 0x01, &flags, 1);
+  std::string uuid = phoneUuid(index);
+  std::string data;
+  switch (format) {
+    case MANUFACTURER:
+      data = std::string("\xFF\xFF", 2) + uuid;
+      appendAd(payload, 0xFF, data.data(), data.size());
+      break;
+    case SERVICE_DATA:
+      data = std::string("\xF0\xFF", 2) + uuid;
+      appendAd(payload, 0x16, data.data(), data.size());
+      break;
+    case NAME:
+      appendAd(payload, 0x09, uuid.data(), uuid.size());
+      break;
+  }
+  return makeDevice(payload, rssi, (uint8_t)index);
+}
+
+BLEAdvertisedDevice iBeacon() {
+  std::vector<uint8_t> payload;
+  uint8_t flags = 0x06;
+  appendAd(payload, 0x01, &flags, 1);
+  uint8_t data[25] = { 0x4C, 0x00, 0x02, 0x15 };
+  for (int i = 4; i < 24; i++) {
+    data[i] = (uint8_t)(i * 37);
+  }
+  data[24] = 0xC5;
+  appendAd(payload, 0xFF, data, sizeof(data));
+  return makeDevice(payload, -60, 0xEE);
+}
+
+std::string registeredJson(int count) {
+  std::string json = "{\"success\":true,\"deviceUuids\":[";
+  for (int i = 0; i < count; i++) {
+    json += i > 0 ? ",\"" : "\"";
+    json += phoneUuid(i);
+    json += "\"";
+  }
+  json += "],\"count\":" + std::to_string(count) + "}";
+  return json;
+}
+
+bool loadRegistrations(int count) {
+  std::string json = registeredJson(count);
+  return events.parseRegisteredDevices(json.c_str(), json.length());
+}
+
+// --- cases ---------------------------------------------------------------
+
+void benchExtract() {
+  struct Case {
+    const char* name;
+    BLEAdvertisedDevice device;
+  };
+  Case cases[] = {
+    { "extractUUID/manufacturer", phone(1, MANUFACTURER) },
+    { "extractUUID/service_data", phone(1, SERVICE_DATA) },
+    { "extractUUID/name", phone(1, NAME) },
+    { "extractUUID/ibeacon", iBeacon() },
+  };
+  for (Case& c : cases) {
+    BLEAdvertisedDevice& device = c.device;
+    run(c.name, 1, [&](unsigned long long n) {
+      char uuid[DEVICE_UUID_SIZE];
+      for (unsigned long long i = 0; i < n; i++) {
+        size_t length = ScannerBenchmark::extractUUID(device, uuid, sizeof(uuid));
+        keep(length);
+      }
+    });
+  }
+}
+
+void benchFilter() {
+  SightingBuffer& sightings = ScannerBenchmark::sightings();
+  BLEAdvertisedDevice match = phone(1, MANUFACTURER);
+  BLEAdvertisedDevice weak = phone(2, MANUFACTURER, -100);
+  BLEAdvertisedDevice beacon = iBeacon();
+  std::string uuid = phoneUuid(1);
+  uint32_t hash = hashDeviceUuid(uuid.c_str(), uuid.length());
+  ScannerBenchmark::Fields matchFields = ScannerBenchmark::parse(match);
+  ScannerBenchmark::Fields weakFields = ScannerBenchmark::parse(weak);
+  ScannerBenchmark::Fields beaconFields = ScannerBenchmark::parse(beacon);
+  uint8_t address[6] = { 0 };
+
+  // The raw-payload screen in front of everything else
+  const struct {
+    const char* name;
+    BLEAdvertisedDevice device;
+  } screened[] = {
+    { "screenPayload/phone", match },
+    { "screenPayload/phone_name", phone(1, NAME) },
+    { "screenPayload/ibeacon", beacon },
+  };
+  for (const auto& item : screened) {
+    BLEAdvertisedDevice device = item.device;
+    run(item.name, 1, [&](unsigned long long n) {
+      for (unsigned long long i = 0; i < n; i++) {
+        PayloadScreen verdict = ScannerBenchmark::screen(device);
+        keep(verdict);
+      }
+    });
+  }
+
+  sightings.clear();
+  run("shouldIncludeDevice/new", 1, [&](unsigned long long n) {
+    for (unsigned long long i = 0; i < n; i++) {
+      bool include = ScannerBenchmark::shouldIncludeDevice(match, matchFields, uuid.c_str(), hash);
+      keep(include);
+    }
+  });
+  sightings.add(hash, 0, -60, 0, address);
+  run("shouldIncludeDevice/duplicate", 1, [&](unsigned long long n) {
+    for (unsigned long long i = 0; i < n; i++) {
+      bool include = ScannerBenchmark::shouldIncludeDevice(match, matchFields, uuid.c_str(), hash);
+      keep(include);
+    }
+  });
+  run("shouldIncludeDevice/weak_rssi", 1, [&](unsigned long long n) {
+    for (unsigned long long i = 0; i < n; i++) {
+      bool include = ScannerBenchmark::shouldIncludeDevice(weak, weakFields, uuid.c_str(), hash);
+      keep(include);
+    }
+  });
+  run("shouldIncludeDevice/no_uuid", 1, [&](unsigned long long n) {
+    for (unsigned long long i = 0; i < n; i++) {
+      bool include = ScannerBenchmark::shouldIncludeDevice(beacon, beaconFields, "", 0);
+      keep(include);
+    }
+  });
+
+  // The whole callback. A repeated advertisement is answered by the
+  // address cache; a rotating address misses it every time and takes the
+  // full extract, filter and lookup path.
+  sightings.clear();
+  run("onDeviceFound/phone_duplicate", 1, [&](unsigned long long n) {
+    for (unsigned long long i = 0; i < n; i++) {
+      ScannerBenchmark::onDeviceFound(match);
+    }
+  });
+  run("onDeviceFound/beacon", 1, [&](unsigned long long n) {
+    for (unsigned long long i = 0; i < n; i++) {
+      ScannerBenchmark::onDeviceFound(beacon);
+    }
+  });
+  std::vector<BLEAdvertisedDevice> rotating;
+  for (int k = 0; k < 4 * ADDRESS_CACHE_SIZE; k++) {
+    uint8_t rotated[6] = { 0x40, 0x11, 0x22, 0x33, (uint8_t)(k >> 8), (uint8_t)k };
+    rotating.push_back(BLEAdvertisedDevice(rotated, -60, match.getPayload(), match.getPayloadLength()));
+  }
+  run("onDeviceFound/phone_rotating", 1, [&](unsigned long long n) {
+    for (unsigned long long i = 0; i < n; i++) {
+      ScannerBenchmark::onDeviceFound(rotating[i % rotating.size()]);
+    }
+  });
+  sightings.clear();
+  ScannerBenchmark::addressCache().clear();
+}
+
+void benchDedupe() {
+  SightingBuffer& sightings = ScannerBenchmark::sightings();
+  uint8_t address[6] = { 0 };
+  const int sizes[] = { 10, 100, 500 };
+  for (int size : sizes) {
+    std::vector<uint32_t> hashes;
+    for (int i = 0; i < size; i++) {
+      std::string uuid = phoneUuid(i);
+      hashes.push_back(hashDeviceUuid(uuid.c_str(), uuid.length()));
+    }
+
+    run("dedupe/fill_scan/" + std::to_string(size), size, [&](unsigned long long n) {
+      for (unsigned long long i = 0; i < n; i++) {
+        sightings.clear();
+        for (int j = 0; j < size; j++) {
+          if (sightings.find(hashes[j], (int16_t)j) < 0) {
+            sightings.add(hashes[j], (int16_t)j, -60, 0, address);
+          }
+        }
+      }
+    });
+
+    sightings.clear();
+    for (int j = 0; j < size; j++) {
+      sightings.add(hashes[j], (int16_t)j, -60, 0, address);
+    }
+    run("dedupe/find_hit/" + std::to_string(size), 1, [&](unsigned long long n) {
+      for (unsigned long long i = 0; i < n; i++) {
+        int row = sightings.find(hashes[i % size], (int16_t)(i % size));
+        keep(row);
+      }
+    });
+    run("dedupe/find_miss/" + std::to_string(size), 1, [&](unsigned long long n) {
+      for (unsigned long long i = 0; i < n; i++) {
+        int row = sightings.find((uint32_t)(i * 2654435761u) | 1u, 0);
+        keep(row);
+      }
+    });
+  }
+  sightings.clear();
+}
+
+void benchRegistered() {
+  const int sizes[] = { 100, 1000, 10000 };
+  String eventId = "bench-event";
+  for (int size : sizes) {
+    if (!loadRegistrations(size)) {
+      fprintf(stderr, "could not load %d registrations\n", size);
+      continue;
+    }
+    std::vector<std::string> hits;
+    std::vector<std::string> misses;
+    for (int i = 0; i < 256; i++) {
+      hits.push_back(phoneUuid((i * 7919) % size));
+      misses.push_back(phoneUuid(size + i));
+    }
+    run("isDeviceRegistered/" + std::to_string(size) + "/hit", 1, [&](unsigned long long n) {
+      for (unsigned long long i = 0; i < n; i++) {
+        bool registered = events.isDeviceRegistered(eventId, hits[i & 255].c_str());
+        keep(registered);
+      }
+    });
+    run("isDeviceRegistered/" + std::to_string(size) + "/miss", 1, [&](unsigned long long n) {
+      for (unsigned long long i = 0; i < n; i++) {
+        bool registered = events.isDeviceRegistered(eventId, misses[i & 255].c_str());
+        keep(registered);
+      }
+    });
+  }
+}
+
+void benchSerialize() {
+  SightingBuffer& sightings = ScannerBenchmark::sightings();
+  const int sizes[] = { 10, 100, 500 };
+  std::vector<char> body(256 * 1024);
+  loadRegistrations(500);
+  for (int size : sizes) {
+    sightings.clear();
+    for (int i = 0; i < size; i++) {
+      std::string uuid = phoneUuid(i);
+      uint8_t address[6] = { 0xC0, 0, 0, 0, (uint8_t)(i >> 8), (uint8_t)i };
+      sightings.add(hashDeviceUuid(uuid.c_str(), uuid.length()), (int16_t)i, (int8_t)(-50 - i % 30),
+                    (uint32_t)(1000 + i), address);
+    }
+    SightingView view = sightings.view();
+    run("batchSerialize/" + std::to_string(size), size, [&](unsigned long long n) {
+      for (unsigned long long i = 0; i < n; i++) {
+        size_t length = BackendClient::buildBatchCheckinBody(view, events.getRegisteredDeviceTable(),
+                                                             "k57b3ad0q1x9cdfv2r7e3t5y6u8i9o0p",
+                                                             "ESP32-Scanner-01", 1700000000000ULL, 5000,
+                                                             body.data(), body.size());
+        keep(length);
+      }
+    });
+  }
+  sightings.clear();
+}
+
+void benchParse() {
+  const int sizes[] = { 100, 1000, 10000 };
+  for (int size : sizes) {
+    std::string json = registeredJson(size);
+    run("parseRegisteredDevices/" + std::to_string(size), size, [&](unsigned long long n) {
+      for (unsigned long long i = 0; i < n; i++) {
+        bool ok = events.parseRegisteredDevices(json.c_str(), json.length());
+        keep(ok);
+      }
+    });
+  }
+}
+
+// --- output --------------------------------------------------------------
+
+void writeJson(const char* path, const char* executable) {
+  FILE* out = fopen(path, "w");
+  if (!out) {
+    fprintf(stderr, "cannot write %s\n", path);
+    return;
+  }
+  char date[32];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+#ifdef __OPTIMIZE__
+  const char* optimized = "true";
+#else
+  const char* optimized = "false";
+#endif
+
+  fprintf(out, "{\n  \"context\": {\n");
+  fprintf(out, "    \"date\": \"%s\",\n    \"executable\": \"%s\",\n", date, executable);
+  fprintf(out, "    \"num_cpus\": %u,\n    \"optimized\": %s,\n", std::thread::hardware_concurrency(), optimized);
+  fprintf(out, "    \"min_time\": %g,\n    \"repetitions\": %d,\n", minTime, repetitions);
+  fprintf(out, "    \"device_arena_size\": %d\n  },\n  \"benchmarks\": [\n", DEVICE_ARENA_SIZE);
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result& r = results[i];
+    fprintf(out, "    {\"name\": \"%s\", \"iterations\": %llu, \"repetitions\": %d, "
+                 "\"ns_per_op\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f, \"items_per_op\": %d}%s\n",
+            r.name.c_str(), r.iterations, r.repetitions, r.nsPerOp, r.minNs, r.maxNs, r.itemsPerOp,
+            i + 1 < results.size() ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+  fclose(out);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* jsonPath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      jsonPath = argv[++i];
+    } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+      minTime = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+      repetitions = std::max(1, atoi(argv[++i]));
+    } else {
+      fprintf(stderr, "usage: %s [--json FILE] [--filter TEXT] [--min-time S] [--repetitions N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+#ifndef __OPTIMIZE__
+  fprintf(stderr, "warning: built without optimization, configure with -DCMAKE_BUILD_TYPE=Release\n");
+#endif
+  host::setSerialOutput(nullptr);
+  logger.setLevel(LOG_LEVEL_ERROR);
+  events.begin();
+  bleScanner.begin();
+
+  benchExtract();
+  benchFilter();
+  benchDedupe();
+  benchRegistered();
+  benchSerialize();
+  benchParse();
+
+  if (jsonPath) {
+    writeJson(jsonPath, argv[0]);
+  }
+  return 0;
+}
@@ -0,0 +1,93 @@
+// Runs the whole scanner firmware as a Linux process: real sockets for
+// HTTP, the host BLE radio for advertisements and an optional virtual
+// clock, so the firmware can be profiled and benchmarked off-device.
+//
+//   scanner_host [--backend URL] [--event N] [--seconds N] [--virtual-clock] [--quiet]
+
+#include "sketch_runner.h"
+#include "scanner_metrics.h"
+#include "log.h"
+#include "host_runtime.h"
+
+#include <Arduino.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s [--backend URL] [--event N] [--seconds N] [--virtual-clock] [--quiet]\n"
+          "  --backend URL     backend base URL (default http://127.0.0.1:8787/http)\n"
+          "  --event N         select event N once the menu is shown, -1 to stay in the menu (default 0)\n"
+          "  --seconds N       stop after N seconds of firmware time (default: run until killed)\n"
+          "  --virtual-clock   firmware time only advances through delays and waits\n"
+          "  --quiet           discard the firmware's serial output\n",
+          program);
+}
+
+void printSummary() {
+  const ScannerMetrics& m = scannerMetrics;
+  fprintf(stderr, "\n--- scanner_host after %lu ms (state %s) ---\n", millis(), sketch::stateName());
+  fprintf(stderr, "advertisements  seen %lu  matched %lu\n",
+          (unsigned long)m.advertisementsSeen, (unsigned long)m.advertisementsMatched);
+  fprintf(stderr, "uploads         ok %lu  failed %lu  records %lu  rejected %lu\n",
+          (unsigned long)m.uploadsSucceeded, (unsigned long)m.uploadsFailed,
+          (unsigned long)m.recordsUploaded, (unsigned long)m.recordsRejected);
+  fprintf(stderr, "http            requests %lu  errors %lu  mean %.1f ms\n",
+          (unsigned long)m.httpRequests, (unsigned long)m.httpErrors,
+          m.requestLatency.count ? (double)m.requestLatency.sum / m.requestLatency.count : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* backendUrl = "http://127.0.0.1:8787/http";
+  int eventIndex = 0;
+  double seconds = 0;
+  bool virtualClock = false;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc) {
+      backendUrl = argv[++i];
+    } else if (strcmp(argv[i], "--event") == 0 && i + 1 < argc) {
+      eventIndex = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      seconds = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--virtual-clock") == 0) {
+      virtualClock = true;
+    } else if (strcmp(argv[i], "--quiet") == 0) {
+      quiet = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  host::useVirtualClock(virtualClock);
+  if (quiet) {
+    host::setSerialOutput(nullptr);
+  }
+
+  sketch::setup();
+  sketch::setBackendUrl(backendUrl);
+
+  unsigned long long endUs = seconds > 0 ? host::clockMicros() + (unsigned long long)(seconds * 1e6) : 0;
+  bool selected = eventIndex < 0;
+  while (endUs == 0 || host::clockMicros() < endUs) {
+    sketch::loopOnce();
+    if (!selected && sketch::isSelectingEvent()) {
+      selected = true;
+      if (!sketch::selectEvent(eventIndex)) {
+        fprintf(stderr, "event %d could not be selected\n", eventIndex);
+      }
+    }
+  }
+
+  logger.flush();
+  fflush(stdout);
+  printSummary();
+  return 0;
+}
@@ -0,0 +1,403 @@
+// Accelerated soak: runs a day of lectures through the whole firmware on
+// the virtual clock, against the backend stand-in, and writes a time
+// series of heap, queue depths and per-stage latency. millis() is started
+// close to its 32-bit wrap so rollover lands inside a lecture.
+//
+// The ESP32 heap is modelled by HeapSimulator, fed with every allocation
+// the process makes once scanning starts; the firmware's HeapMonitor and
+// /metrics report the modelled figures.
+//
+//   scanner_soak [--backend URL] [--hours N] [--csv FILE] [options]
+
+#include "heap_sim.h"
+#include "sketch_runner.h"
+#include "storm_source.h"
+#include "ble_scanner.h"
+#include "event_manager.h"
+#include "scanner_metrics.h"
+#include "log.h"
+#include "host_ble.h"
+#include "host_runtime.h"
+
+#include <Arduino.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+const unsigned long long MINUTE_US = 60ULL * 1000000ULL;
+const unsigned long long HOUR_US = 60ULL * MINUTE_US;
+
+struct Options {
+  const char* backendUrl = "http://127.0.0.1:8787/http";
+  double hours = 24;
+  double dayStartHours = 8;    // First lecture of each day
+  int lectures = 8;            // Per day
+  double lectureMinutes = 50;
+  double breakMinutes = 10;
+  int students = 60;           // Mean attendance per lecture
+  int beacons = 100;           // Other BLE devices, always in range
+  double rolloverHours = 10.4; // Firmware time at which millis() wraps, < 0 = no wrap
+  uint32_t heapKb = 160;       // Free internal heap once scanning starts
+  double sampleMinutes = 5;
+  const char* csvPath = nullptr;
+  uint32_t seed = 1;
+  bool verbose = false;
+};
+
+void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --backend URL        backend base URL (default http://127.0.0.1:8787/http)\n"
+          "  --hours N            firmware hours to run (default 24)\n"
+          "  --day-start-h H      first lecture of each day (default 8)\n"
+          "  --lectures N         lectures per day (default 8)\n"
+          "  --lecture-min M      lecture length (default 50)\n"
+          "  --break-min M        gap between lectures (default 10)\n"
+          "  --students N         mean attendance per lecture (default 60)\n"
+          "  --beacons N          other BLE devices in range all day (default 100)\n"
+          "  --rollover-h H       hour at which millis() wraps, -1 for never (default 10.4)\n"
+          "  --heap-kb N          modelled free heap when scanning starts (default 160)\n"
+          "  --sample-min M       time series interval (default 5)\n"
+          "  --csv FILE           write the time series here (default stdout)\n"
+          "  --seed N             attendance and radio seed (default 1)\n"
+          "  --verbose            print the firmware log\n",
+          program);
+}
+
+HeapSimulator* heap = nullptr;
+
+uint32_t modelFree() { return heap->getFreeBytes(); }
+uint32_t modelLargest() { return heap->getLargestBlock(); }
+uint32_t modelBlocks() { return heap->getLiveBlocks(); }
+
+// Change of a histogram since the last sample
+struct HistogramWindow {
+  const LatencyHistogram* histogram;
+  LatencyHistogram previous;
+
+  explicit HistogramWindow(const LatencyHistogram& source) : histogram(&source), previous(source) {}
+
+  double mean() const {
+    uint32_t count = histogram->count - previous.count;
+    return count ? (double)(histogram->sum - previous.sum) / count : 0.0;
+  }
+
+  // Upper bound of the bucket holding the 95th percentile
+  uint32_t p95() const {
+    uint32_t count = histogram->count - previous.count;
+    if (count == 0) {
+      return 0;
+    }
+    uint32_t seen = 0;
+    for (int i = 0; i <= LATENCY_BUCKET_COUNT; i++) {
+      seen += histogram->buckets[i] - previous.buckets[i];
+      if (seen * 100ULL >= count * 95ULL) {
+        return histogram->bound(i);
+      }
+    }
+    return histogram->bound(LATENCY_BUCKET_COUNT);
+  }
+
+  void advance() { previous = *histogram; }
+};
+
+struct Counters {
+  int scans;
+  uint32_t uploadsOk;
+  uint32_t uploadsFailed;
+  uint32_t records;
+
+  static Counters now() {
+    Counters c;
+    c.scans = bleScanner.getTotalScans();
+    c.uploadsOk = scannerMetrics.uploadsSucceeded;
+    c.uploadsFailed = scannerMetrics.uploadsFailed;
+    c.records = scannerMetrics.recordsUploaded;
+    return c;
+  }
+};
+
+// Lecture index at firmware time `t` since the soak started, or -1
+int lectureAt(const Options& o, unsigned long long t) {
+  unsigned long long dayUs = 24ULL * HOUR_US;
+  unsigned long long inDay = t % dayUs;
+  unsigned long long dayStart = (unsigned long long)(o.dayStartHours * HOUR_US);
+  unsigned long long slot = (unsigned long long)((o.lectureMinutes + o.breakMinutes) * MINUTE_US);
+  if (inDay < dayStart || slot == 0) {
+    return -1;
+  }
+  unsigned long long index = (inDay - dayStart) / slot;
+  if (index >= (unsigned long long)o.lectures) {
+    return -1;
+  }
+  if ((inDay - dayStart) % slot >= (unsigned long long)(o.lectureMinutes * MINUTE_US)) {
+    return -1;
+  }
+  return (int)((t / dayUs) * o.lectures + index);
+}
+
+bool runUntil(bool (*done)(), unsigned long long limitUs) {
+  unsigned long long deadline = host::clockMicros() + limitUs;
+  while (!done()) {
+    if (host::clockMicros() > deadline) {
+      return false;
+    }
+    sketch::loopOnce();
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  Options o;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (strcmp(arg, "--backend") == 0 && hasValue) {
+      o.backendUrl = argv[++i];
+    } else if (strcmp(arg, "--hours") == 0 && hasValue) {
+      o.hours = atof(argv[++i]);
+    } else if (strcmp(arg, "--day-start-h") == 0 && hasValue) {
+      o.dayStartHours = atof(argv[++i]);
+    } else if (strcmp(arg, "--lectures") == 0 && hasValue) {
+      o.lectures = atoi(argv[++i]);
+    } else if (strcmp(arg, "--lecture-min") == 0 && hasValue) {
+      o.lectureMinutes = atof(argv[++i]);
+    } else if (strcmp(arg, "--break-min") == 0 && hasValue) {
+      o.breakMinutes = atof(argv[++i]);
+    } else if (strcmp(arg, "--students") == 0 && hasValue) {
+      o.students = atoi(argv[++i]);
+    } else if (strcmp(arg, "--beacons") == 0 && hasValue) {
+      o.beacons = atoi(argv[++i]);
+    } else if (strcmp(arg, "--rollover-h") == 0 && hasValue) {
+      o.rolloverHours = atof(argv[++i]);
+    } else if (strcmp(arg, "--heap-kb") == 0 && hasValue) {
+      o.heapKb = (uint32_t)atoi(argv[++i]);
+    } else if (strcmp(arg, "--sample-min") == 0 && hasValue) {
+      o.sampleMinutes = atof(argv[++i]);
+    } else if (strcmp(arg, "--csv") == 0 && hasValue) {
+      o.csvPath = argv[++i];
+    } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+      o.seed = (uint32_t)atoi(argv[++i]);
+    } else if (strcmp(arg, "--verbose") == 0) {
+      o.verbose = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (o.hours <= 0 || o.sampleMinutes <= 0 || o.heapKb == 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  FILE* csv = stdout;
+  if (o.csvPath) {
+    csv = fopen(o.csvPath, "w");
+    if (!csv) {
+      fprintf(stderr, "cannot write %s\n", o.csvPath);
+      return 1;
+    }
+  }
+
+  // Place the 2^32 ms wrap `rolloverHours` into the run; boot takes a few
+  // seconds of firmware time, which is negligible here
+  host::useVirtualClock(true);
+  if (o.rolloverHours >= 0) {
+    host::advanceClock((0x100000000ULL * 1000ULL) - (unsigned long long)(o.rolloverHours * HOUR_US));
+  }
+  if (!o.verbose) {
+    host::setSerialOutput(nullptr);
+  }
+
+  sketch::setup();
+  sketch::setBackendUrl(o.backendUrl);
+  if (!runUntil(sketch::isSelectingEvent, 10 * MINUTE_US)) {
+    fprintf(stderr, "scanner did not reach the event menu (state %s); is the backend at %s running?\n",
+            sketch::stateName(), o.backendUrl);
+    return 1;
+  }
+  int eventCount = events.getEventCount();
+  if (eventCount == 0) {
+    fprintf(stderr, "the backend has no events\n");
+    return 1;
+  }
+
+  // From here on the device heap is modelled
+  static HeapSimulator simulator(o.heapKb * 1024);
+  heap = &simulator;
+  host::setHeapModel(simulator.getHeapSize(), modelFree, modelLargest);
+  host::setHeapBlockModel(modelBlocks);
+  host::setAllocationObserver(&simulator);
+
+  StormConfig quiet;
+  quiet.phones = 0;
+  quiet.beacons = o.beacons;
+  quiet.seed = o.seed;
+  std::unique_ptr<StormSource> radio(new StormSource(quiet));
+  radio->skipUntil(host::clockMicros());
+  host::setAdvertisementSource(radio.get());
+
+  fprintf(csv, "hours,millis,state,lecture,heap_free,heap_largest,heap_min_free,heap_blocks,frag_pct,"
+               "heap_failures,upload_pending,log_queued,log_dropped,present,scans,uploads_ok,uploads_failed,"
+               "records,queue_ms,serialize_us,network_ms,server_ms,ack_ms,ack_p95_ms\n");
+
+  std::mt19937 rng(o.seed);
+  HistogramWindow queue(scannerMetrics.queueLatency);
+  HistogramWindow serialize(scannerMetrics.serializeLatency);
+  HistogramWindow network(scannerMetrics.networkLatency);
+  HistogramWindow server(scannerMetrics.serverLatency);
+  HistogramWindow ack(scannerMetrics.ackLatency);
+  Counters last = Counters::now();
+
+  unsigned long long startUs = host::clockMicros();
+  unsigned long long endUs = startUs + (unsigned long long)(o.hours * HOUR_US);
+  unsigned long long sampleUs = (unsigned long long)(o.sampleMinutes * MINUTE_US);
+  unsigned long long nextSample = startUs;
+  unsigned long long rolloverAt = 0;
+  uint32_t lastMillis = millis();
+  int scansAtRollover = -1;
+  int current = -1;
+  int lecturesRun = 0;
+  int lecturesMissed = 0;
+  uint32_t worstLargest = simulator.getLargestBlock();
+  int worstFragmentation = 0;
+  std::vector<uint32_t> freeAtLectureStart;
+  auto wallStart = std::chrono::steady_clock::now();
+
+  while (host::clockMicros() < endUs) {
+    unsigned long long elapsed = host::clockMicros() - startUs;
+    int lecture = lectureAt(o, elapsed);
+
+    if (lecture != current) {
+      if (current >= 0 && sketch::isScanning()) {
+        sketch::requestStop();
+        runUntil(sketch::isSelectingEvent, 2 * MINUTE_US);
+      }
+      StormConfig config = quiet;
+      if (lecture >= 0) {
+        std::uniform_real_distribution<double> attendance(0.8, 1.2);
+        config.phones = (int)(o.students * attendance(rng));
+        config.seed = o.seed + 1000 + lecture;
+      }
+      host::setAdvertisementSource(nullptr);
+      radio.reset(new StormSource(config));
+      radio->skipUntil(host::clockMicros());
+      host::setAdvertisementSource(radio.get());
+      if (lecture >= 0) {
+        freeAtLectureStart.push_back(simulator.getFreeBytes());
+        if (sketch::isSelectingEvent() && sketch::selectEvent(lecture % eventCount)) {
+          lecturesRun++;
+        } else {
+          lecturesMissed++;
+          fprintf(stderr, "lecture %d: could not start scanning (state %s)\n", lecture, sketch::stateName());
+        }
+      }
+      current = lecture;
+    }
+
+    sketch::loopOnce();
+
+    uint32_t nowMillis = millis();
+    if (nowMillis < lastMillis && rolloverAt == 0) {
+      rolloverAt = host::clockMicros() - startUs;
+      scansAtRollover = bleScanner.getTotalScans();
+    }
+    lastMillis = nowMillis;
+
+    if (host::clockMicros() >= nextSample) {
+      nextSample += sampleUs;
+      uint32_t freeBytes = simulator.getFreeBytes();
+      uint32_t largest = simulator.getLargestBlock();
+      int fragmentation = freeBytes ? 100 - (int)((uint64_t)largest * 100 / freeBytes) : 0;
+      if (largest < worstLargest) {
+        worstLargest = largest;
+      }
+      if (fragmentation > worstFragmentation) {
+        worstFragmentation = fragmentation;
+      }
+      Counters now = Counters::now();
+      fprintf(csv, "%.3f,%lu,%s,%d,%u,%u,%u,%u,%d,%lu,%d,%u,%lu,%d,%d,%u,%u,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%u\n",
+              (host::clockMicros() - startUs) / (double)HOUR_US, (unsigned long)nowMillis, sketch::stateName(),
+              current, freeBytes, largest, simulator.getMinFreeBytes(), simulator.getLiveBlocks(), fragmentation,
+              simulator.getFailures(), scannerMetrics.uploadPending, logger.getQueuedBytes(), logger.getDropped(),
+              scannerMetrics.studentsPresent, now.scans - last.scans, now.uploadsOk - last.uploadsOk,
+              now.uploadsFailed - last.uploadsFailed, now.records - last.records, queue.mean(), serialize.mean(),
+              network.mean(), server.mean(), ack.mean(), ack.p95());
+      fflush(csv);
+      last = now;
+      queue.advance();
+      serialize.advance();
+      network.advance();
+      server.advance();
+      ack.advance();
+    }
+  }
+
+  if (sketch::isScanning()) {
+    sketch::requestStop();
+    runUntil(sketch::isSelectingEvent, 2 * MINUTE_US);
+  }
+  host::setAdvertisementSource(nullptr);
+  host::setAllocationObserver(nullptr);
+  logger.flush();
+  if (csv != stdout) {
+    fclose(csv);
+  }
+
+  // Heap trend: free bytes at each lecture start, where the firmware is
+  // back in the menu; a steady decline is a leak
+  double slopePerLecture = 0;
+  size_t n = freeAtLectureStart.size();
+  if (n >= 2) {
+    double meanX = (n - 1) / 2.0;
+    double meanY = 0;
+    for (uint32_t y : freeAtLectureStart) {
+      meanY += y;
+    }
+    meanY /= n;
+    double num = 0;
+    double den = 0;
+    for (size_t i = 0; i < n; i++) {
+      num += (i - meanX) * (freeAtLectureStart[i] - meanY);
+      den += (i - meanX) * (i - meanX);
+    }
+    slopePerLecture = num / den;
+  }
+
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  bool stalled = false;
+  fprintf(stderr, "\n--- scanner_soak: %.1f firmware hours in %.0f s wall ---\n", o.hours, wallSeconds);
+  fprintf(stderr, "lectures   %d run, %d could not start\n", lecturesRun, lecturesMissed);
+  fprintf(stderr, "uploads    ok %lu  failed %lu  records %lu\n", (unsigned long)scannerMetrics.uploadsSucceeded,
+          (unsigned long)scannerMetrics.uploadsFailed, (unsigned long)scannerMetrics.recordsUploaded);
+  fprintf(stderr, "heap       %u of %u bytes free at the end, min free %u, smallest largest block %u, "
+                  "worst fragmentation %d%%\n",
+          simulator.getFreeBytes(), simulator.getHeapSize(), simulator.getMinFreeBytes(), worstLargest,
+          worstFragmentation);
+  fprintf(stderr, "           trend %+.0f bytes per lecture, %lu allocations would have failed\n", slopePerLecture,
+          simulator.getFailures());
+  if (simulator.getUntracked() > 0) {
+    fprintf(stderr, "           %lu allocations not modelled (block table full)\n", simulator.getUntracked());
+  }
+  if (o.rolloverHours >= 0) {
+    if (rolloverAt == 0) {
+      fprintf(stderr, "rollover   millis() did not wrap; run longer than --rollover-h\n");
+    } else {
+      int after = bleScanner.getTotalScans() - scansAtRollover;
+      bool inLecture = lectureAt(o, rolloverAt) >= 0;
+      stalled = inLecture && after == 0;
+      fprintf(stderr, "rollover   at %.2f h (%s), %d scans after it%s\n", rolloverAt / (double)HOUR_US,
+              inLecture ? "during a lecture" : "between lectures", after, stalled ? "  STALLED" : "");
+    }
+  }
+
+  return simulator.getFailures() > 0 || lecturesMissed > 0 || stalled ? 1 : 0;
+}
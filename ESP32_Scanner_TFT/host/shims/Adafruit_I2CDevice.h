@@ -0,0 +1,7 @@
+#ifndef HOST_ADAFRUIT_I2CDEVICE_H
+#define HOST_ADAFRUIT_I2CDEVICE_H
+
+// Adafruit_GFX.h includes the BusIO headers; nothing in the host build
+// talks to a real bus, so empty stand-ins keep BusIO out of the build.
+
+#endif // HOST_ADAFRUIT_I2CDEVICE_H
@@ -0,0 +1,6 @@
+#ifndef HOST_ADAFRUIT_SPIDEVICE_H
+#define HOST_ADAFRUIT_SPIDEVICE_H
+
+// See Adafruit_I2CDevice.h
+
+#endif // HOST_ADAFRUIT_SPIDEVICE_H
@@ -0,0 +1,80 @@
+#ifndef HOST_ADAFRUIT_ST7735_H
+#define HOST_ADAFRUIT_ST7735_H
+
+// Host stand-in for Adafruit_ST7735: the real Adafruit_GFX renders into an
+// in-memory RGB565 framebuffer. Every operation is also charged the bytes
+// the real driver would clock out over SPI, so redraw cost can be measured
+// off-device.
+
+#include <Adafruit_GFX.h>
+
+#define INITR_GREENTAB   0x00
+#define INITR_REDTAB     0x01
+#define INITR_BLACKTAB   0x02
+#define INITR_144GREENTAB 0x01
+#define INITR_MINI160x80 0x04
+
+#define ST77XX_BLACK 0x0000
+#define ST77XX_WHITE 0xFFFF
+
+struct TFTFrameStats {
+  unsigned long pixelsWritten;  // Pixels that reached the panel
+  unsigned long spiBytes;       // Command + data bytes on the bus
+  unsigned long addrWindows;    // CASET/RASET/RAMWR sequences
+};
+
+class Adafruit_ST7735 : public Adafruit_GFX {
+private:
+  uint16_t framebuffer[128 * 160];
+  int16_t windowX, windowY, windowW, windowH;
+  int32_t windowPos;
+  TFTFrameStats stats;
+
+  void chargeWindow(int16_t x, int16_t y, int16_t w, int16_t h);
+  void store(int16_t x, int16_t y, uint16_t color);
+
+public:
+  // SPI clock the byte counts are converted at (Adafruit ST77xx default)
+  static const uint32_t SPI_HZ = 24000000;
+  static const uint8_t ADDR_WINDOW_BYTES = 11;
+
+  Adafruit_ST7735(int8_t cs, int8_t dc, int8_t rst);
+  Adafruit_ST7735(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst);
+
+  void initR(uint8_t options = INITR_GREENTAB);
+  void setRotation(uint8_t r) override;
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void writePixel(int16_t x, int16_t y, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+
+  // Raw window/pixel streaming as in Adafruit_SPITFT
+  void startWrite() override {}
+  void endWrite() override {}
+  void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  void writePixels(uint16_t* colors, uint32_t len, bool block = true, bool bigEndian = false);
+  void pushColor(uint16_t color);
+  void drawRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap, int16_t w, int16_t h);
+  void dmaWait() {}
+
+  // Host only: framebuffer access and bus accounting
+  const uint16_t* getFramebuffer() const { return framebuffer; }
+  uint16_t getPixel(int16_t x, int16_t y) const;
+  const TFTFrameStats& getStats() const { return stats; }
+  void resetStats();
+  static float bytesToMs(unsigned long bytes) { return (float)bytes * 8.0f * 1000.0f / (float)SPI_HZ; }
+  bool writePPM(const char* path) const;
+  bool writePNG(const char* path) const;
+
+  // Host only: the most recently constructed panel, so tools can reach a
+  // display owned by firmware code
+  static Adafruit_ST7735* lastCreated();
+};
+
+#endif // HOST_ADAFRUIT_ST7735_H
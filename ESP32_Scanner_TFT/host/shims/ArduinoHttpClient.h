@@ -0,0 +1,6 @@
+#ifndef HOST_ARDUINO_HTTP_CLIENT_H
+#define HOST_ARDUINO_HTTP_CLIENT_H
+
+// The firmware includes ArduinoHttpClient but only uses HTTPClient.
+
+#endif // HOST_ARDUINO_HTTP_CLIENT_H
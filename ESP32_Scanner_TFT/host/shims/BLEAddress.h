@@ -0,0 +1,28 @@
+#ifndef HOST_BLE_ADDRESS_H
+#define HOST_BLE_ADDRESS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+typedef uint8_t esp_bd_addr_t[6];
+
+class BLEAddress {
+private:
+  esp_bd_addr_t address;
+
+public:
+  BLEAddress() { memset(address, 0, sizeof(address)); }
+  BLEAddress(const uint8_t* native) { memcpy(address, native, sizeof(address)); }
+  esp_bd_addr_t* getNative() { return &address; }
+  bool equals(const BLEAddress& other) const { return memcmp(address, other.address, sizeof(address)) == 0; }
+  std::string toString() const {
+    char buf[18];
+    snprintf(buf, sizeof(buf), "%02x:%02x:%02x:%02x:%02x:%02x",
+             address[0], address[1], address[2], address[3], address[4], address[5]);
+    return std::string(buf);
+  }
+};
+
+#endif // HOST_BLE_ADDRESS_H
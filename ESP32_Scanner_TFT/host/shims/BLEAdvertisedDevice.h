@@ -0,0 +1,55 @@
+#ifndef HOST_BLE_ADVERTISED_DEVICE_H
+#define HOST_BLE_ADVERTISED_DEVICE_H
+
+// Host stand-in for the ESP32 BLE Arduino BLEAdvertisedDevice. It is built
+// from a raw advertising payload and parses the AD structures the same way
+// the library does.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BLEAddress.h"
+#include "BLEUUID.h"
+
+class BLEAdvertisedDevice {
+private:
+  BLEAddress address;
+  int rssi;
+  std::string name;
+  std::string manufacturerData;
+  std::string serviceData;
+  std::vector<BLEUUID> serviceUUIDs;
+  bool hasName;
+  bool hasManufacturerData;
+  bool hasServiceData;
+  uint8_t payload[62];
+  size_t payloadLength;
+
+public:
+  BLEAdvertisedDevice();
+  BLEAdvertisedDevice(const uint8_t* addr, int rssi, const uint8_t* payload, size_t length);
+
+  BLEAddress getAddress() { return address; }
+  int getRSSI() { return rssi; }
+  std::string getName() { return name; }
+  std::string getManufacturerData() { return manufacturerData; }
+  std::string getServiceData() { return serviceData; }
+  BLEUUID getServiceUUID() { return serviceUUIDs.empty() ? BLEUUID() : serviceUUIDs[0]; }
+  bool haveName() { return hasName; }
+  bool haveRSSI() { return true; }
+  bool haveManufacturerData() { return hasManufacturerData; }
+  bool haveServiceData() { return hasServiceData; }
+  bool haveServiceUUID() { return !serviceUUIDs.empty(); }
+  bool isAdvertisingService(BLEUUID uuid);
+  uint8_t* getPayload() { return payload; }
+  size_t getPayloadLength() { return payloadLength; }
+  std::string toString() { return "Name: " + name + ", Address: " + address.toString(); }
+};
+
+class BLEAdvertisedDeviceCallbacks {
+public:
+  virtual ~BLEAdvertisedDeviceCallbacks() {}
+  virtual void onResult(BLEAdvertisedDevice advertisedDevice) = 0;
+};
+
+#endif // HOST_BLE_ADVERTISED_DEVICE_H
@@ -0,0 +1,18 @@
+#ifndef HOST_BLE_DEVICE_H
+#define HOST_BLE_DEVICE_H
+
+#include <string>
+#include "BLEAddress.h"
+#include "BLEAdvertisedDevice.h"
+#include "BLEScan.h"
+#include "BLEUUID.h"
+
+class BLEDevice {
+public:
+  static void init(const std::string& deviceName);
+  static void deinit(bool releaseMemory = false);
+  static BLEScan* getScan();
+  static bool getInitialized();
+};
+
+#endif // HOST_BLE_DEVICE_H
@@ -0,0 +1,40 @@
+#ifndef HOST_BLE_SCAN_H
+#define HOST_BLE_SCAN_H
+
+#include <cstdint>
+#include "BLEAdvertisedDevice.h"
+
+class BLEScanResults {
+private:
+  int count;
+
+public:
+  BLEScanResults(int count = 0) : count(count) {}
+  int getCount() { return count; }
+};
+
+// Scans deliver advertisements from the host advertisement source (see
+// host_ble.h) for the requested duration, on the calling thread.
+class BLEScan {
+private:
+  BLEAdvertisedDeviceCallbacks* callbacks;
+  bool activeScan;
+  bool wantDuplicates;
+  volatile bool stopRequested;
+  uint16_t interval;
+  uint16_t window;
+
+public:
+  BLEScan();
+  void setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* callbacks,
+                                    bool wantDuplicates = false, bool shouldParse = true);
+  void setActiveScan(bool active) { activeScan = active; }
+  void setInterval(uint16_t intervalMs) { interval = intervalMs; }
+  void setWindow(uint16_t windowMs) { window = windowMs; }
+  BLEScanResults start(uint32_t duration, bool is_continue = false);
+  bool start(uint32_t duration, void (*scanCompleteCB)(BLEScanResults), bool is_continue = false);
+  void stop() { stopRequested = true; }
+  void clearResults() {}
+};
+
+#endif // HOST_BLE_SCAN_H
@@ -0,0 +1,36 @@
+#ifndef HOST_BLE_UUID_H
+#define HOST_BLE_UUID_H
+
+#include <cctype>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+
+// UUIDs are kept in canonical 128-bit lowercase text form so 16-bit and
+// 128-bit spellings of the same UUID compare equal.
+class BLEUUID {
+private:
+  std::string value;
+
+  static std::string canonical(const std::string& text) {
+    std::string lower;
+    for (char c : text) lower += (char)tolower((unsigned char)c);
+    if (lower.size() == 4) return "0000" + lower + "-0000-1000-8000-00805f9b34fb";
+    if (lower.size() == 8) return lower + "-0000-1000-8000-00805f9b34fb";
+    return lower;
+  }
+
+public:
+  BLEUUID() {}
+  BLEUUID(const std::string& text) : value(canonical(text)) {}
+  BLEUUID(const char* text) : value(canonical(text ? text : "")) {}
+  BLEUUID(uint16_t uuid16) {
+    char buf[5];
+    snprintf(buf, sizeof(buf), "%04x", uuid16);
+    value = canonical(buf);
+  }
+  bool equals(const BLEUUID& other) const { return value == other.value; }
+  std::string toString() const { return value; }
+};
+
+#endif // HOST_BLE_UUID_H
@@ -0,0 +1,66 @@
+#ifndef HOST_HTTP_CLIENT_H
+#define HOST_HTTP_CLIENT_H
+
+// Host stand-in for the ESP32 HTTPClient: HTTP/1.1 over a real socket,
+// one request per connection. https:// URLs are sent as plain HTTP.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "host_runtime.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+typedef enum {
+  HTTPC_DISABLE_FOLLOW_REDIRECTS,
+  HTTPC_STRICT_FOLLOW_REDIRECTS,
+  HTTPC_FORCE_FOLLOW_REDIRECTS
+} followRedirects_t;
+
+class HTTPClient {
+private:
+  WiFiClient* client;
+  WiFiClient ownClient;
+  String host;
+  String path;
+  uint16_t port;
+  unsigned long timeoutMs;
+  bool reuse;
+  std::vector<std::pair<String, String>> headers;
+  String body;
+  int lastCode;
+
+public:
+  HTTPClient();
+  bool begin(const String& url);
+  bool begin(WiFiClient& client, const String& url);
+  void end();
+  void setTimeout(unsigned long ms) { timeoutMs = ms; }
+  void setConnectTimeout(int32_t ms) {}
+  void setFollowRedirects(followRedirects_t follow) {}
+  void setReuse(bool keepAlive) { reuse = keepAlive; }
+  void addHeader(const String& name, const String& value);
+  int GET();
+  int POST(const String& payload);
+  int POST(uint8_t* payload, size_t size);
+  int sendRequest(const char* method, const uint8_t* payload, size_t size);
+  String getString() {
+    host::LibraryScope scope;
+    return body;
+  }
+  int getSize() { return (int)body.length(); }
+  static String errorToString(int error);
+
+private:
+  bool parseUrl(const String& url);
+};
+
+#endif // HOST_HTTP_CLIENT_H
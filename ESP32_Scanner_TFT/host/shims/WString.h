@@ -0,0 +1,159 @@
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+// Host stand-in for the Arduino String class, backed by std::string.
+// Only the subset of the API used by the firmware is provided.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+class String {
+private:
+  std::string s;
+
+public:
+  String() {}
+  String(const char* cstr) : s(cstr ? cstr : "") {}
+  String(const char* cstr, unsigned int length) : s(cstr ? cstr : "", cstr ? length : 0) {}
+  String(const std::string& str) : s(str) {}
+  String(const String& other) = default;
+  String(String&& other) = default;
+  explicit String(char c) : s(1, c) {}
+  explicit String(unsigned char value, unsigned char base = 10) { fromUnsigned(value, base); }
+  explicit String(int value, unsigned char base = 10) { fromSigned(value, base); }
+  explicit String(unsigned int value, unsigned char base = 10) { fromUnsigned(value, base); }
+  explicit String(long value, unsigned char base = 10) { fromSigned(value, base); }
+  explicit String(unsigned long value, unsigned char base = 10) { fromUnsigned(value, base); }
+  explicit String(long long value, unsigned char base = 10) { fromSigned(value, base); }
+  explicit String(unsigned long long value, unsigned char base = 10) { fromUnsigned(value, base); }
+  explicit String(float value, unsigned int decimalPlaces = 2) { fromDouble(value, decimalPlaces); }
+  explicit String(double value, unsigned int decimalPlaces = 2) { fromDouble(value, decimalPlaces); }
+
+  String& operator=(const String& other) = default;
+  String& operator=(String&& other) = default;
+  String& operator=(const char* cstr) { s = cstr ? cstr : ""; return *this; }
+
+  unsigned int length() const { return (unsigned int)s.length(); }
+  bool isEmpty() const { return s.empty(); }
+  const char* c_str() const { return s.c_str(); }
+  bool reserve(unsigned int size) { s.reserve(size); return true; }
+  const std::string& str() const { return s; }
+
+  bool concat(const String& other) { s += other.s; return true; }
+  bool concat(const char* cstr) { if (cstr) s += cstr; return true; }
+  bool concat(const char* cstr, unsigned int length) { if (cstr) s.append(cstr, length); return true; }
+  bool concat(char c) { s += c; return true; }
+  template <typename T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, char>::value, int>::type = 0>
+  bool concat(T value) { s += String(value).s; return true; }
+
+  String& operator+=(const String& other) { concat(other); return *this; }
+  String& operator+=(const char* cstr) { concat(cstr); return *this; }
+  String& operator+=(char c) { concat(c); return *this; }
+  template <typename T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, char>::value, int>::type = 0>
+  String& operator+=(T value) { concat(value); return *this; }
+
+  bool equals(const String& other) const { return s == other.s; }
+  bool equals(const char* cstr) const { return s == (cstr ? cstr : ""); }
+  bool equalsIgnoreCase(const String& other) const {
+    if (s.length() != other.s.length()) return false;
+    for (size_t i = 0; i < s.length(); i++) {
+      if (tolower((unsigned char)s[i]) != tolower((unsigned char)other.s[i])) return false;
+    }
+    return true;
+  }
+  bool operator==(const String& other) const { return equals(other); }
+  bool operator==(const char* cstr) const { return equals(cstr); }
+  bool operator!=(const String& other) const { return !equals(other); }
+  bool operator!=(const char* cstr) const { return !equals(cstr); }
+  bool operator<(const String& other) const { return s < other.s; }
+  bool operator>(const String& other) const { return s > other.s; }
+  int compareTo(const String& other) const { return s.compare(other.s); }
+
+  bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.length(), prefix.s) == 0 && s.length() >= prefix.s.length(); }
+  bool startsWith(const String& prefix, unsigned int offset) const {
+    return offset <= s.length() && s.compare(offset, prefix.s.length(), prefix.s) == 0 && s.length() - offset >= prefix.s.length();
+  }
+  bool endsWith(const String& suffix) const {
+    return s.length() >= suffix.s.length() && s.compare(s.length() - suffix.s.length(), suffix.s.length(), suffix.s) == 0;
+  }
+
+  char charAt(unsigned int index) const { return index < s.length() ? s[index] : 0; }
+  void setCharAt(unsigned int index, char c) { if (index < s.length()) s[index] = c; }
+  char operator[](unsigned int index) const { return charAt(index); }
+  char& operator[](unsigned int index) { return s[index]; }
+
+  int indexOf(char c, unsigned int from = 0) const { return toIndex(s.find(c, from)); }
+  int indexOf(const String& str, unsigned int from = 0) const { return toIndex(s.find(str.s, from)); }
+  int lastIndexOf(char c) const { return toIndex(s.rfind(c)); }
+  int lastIndexOf(const String& str) const { return toIndex(s.rfind(str.s)); }
+
+  String substring(unsigned int beginIndex) const {
+    return beginIndex < s.length() ? String(s.substr(beginIndex)) : String();
+  }
+  String substring(unsigned int beginIndex, unsigned int endIndex) const {
+    if (beginIndex > endIndex) { unsigned int t = beginIndex; beginIndex = endIndex; endIndex = t; }
+    if (beginIndex >= s.length()) return String();
+    if (endIndex > s.length()) endIndex = (unsigned int)s.length();
+    return String(s.substr(beginIndex, endIndex - beginIndex));
+  }
+
+  void replace(char find, char replace) { for (auto& c : s) if (c == find) c = replace; }
+  void replace(const String& find, const String& replace) {
+    if (find.s.empty()) return;
+    size_t pos = 0;
+    while ((pos = s.find(find.s, pos)) != std::string::npos) {
+      s.replace(pos, find.s.length(), replace.s);
+      pos += replace.s.length();
+    }
+  }
+  void remove(unsigned int index) { if (index < s.length()) s.erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < s.length()) s.erase(index, count); }
+  void toLowerCase() { for (auto& c : s) c = (char)tolower((unsigned char)c); }
+  void toUpperCase() { for (auto& c : s) c = (char)toupper((unsigned char)c); }
+  void trim() {
+    size_t begin = s.find_first_not_of(" \t\r\n\f\v");
+    if (begin == std::string::npos) { s.clear(); return; }
+    size_t end = s.find_last_not_of(" \t\r\n\f\v");
+    s = s.substr(begin, end - begin + 1);
+  }
+
+  long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(s.c_str(), nullptr); }
+  double toDouble() const { return strtod(s.c_str(), nullptr); }
+
+  friend String operator+(const String& lhs, const String& rhs) { String r(lhs); r.s += rhs.s; return r; }
+  friend String operator+(const String& lhs, const char* rhs) { String r(lhs); r.concat(rhs); return r; }
+  friend String operator+(const char* lhs, const String& rhs) { String r(lhs); r.s += rhs.s; return r; }
+  friend String operator+(const String& lhs, char rhs) { String r(lhs); r.s += rhs; return r; }
+  template <typename T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, char>::value, int>::type = 0>
+  friend String operator+(const String& lhs, T rhs) { String r(lhs); r.concat(rhs); return r; }
+
+private:
+  static int toIndex(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+  void fromSigned(long long value, unsigned char base) {
+    if (value < 0 && base == 10) { s = "-"; fromUnsignedAppend((unsigned long long)(-value), base); }
+    else { fromUnsignedAppend((unsigned long long)value, base); }
+  }
+  void fromUnsigned(unsigned long long value, unsigned char base) { s.clear(); fromUnsignedAppend(value, base); }
+  void fromUnsignedAppend(unsigned long long value, unsigned char base) {
+    char buf[72];
+    int i = 0;
+    if (base < 2) base = 10;
+    do {
+      int digit = (int)(value % base);
+      buf[i++] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+      value /= base;
+    } while (value > 0);
+    while (i > 0) s += buf[--i];
+  }
+  void fromDouble(double value, unsigned int decimalPlaces) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    s = buf;
+  }
+};
+
+#endif // HOST_WSTRING_H
@@ -0,0 +1,94 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+// Host stand-in for the ESP32 WiFi stack. The station is always connected;
+// WiFiClient and WiFiServer are plain TCP sockets.
+
+#include <Arduino.h>
+#include "IPAddress.h"
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3
+} wifi_mode_t;
+
+class WiFiClass {
+private:
+  wl_status_t currentStatus = WL_CONNECTED;
+
+public:
+  wl_status_t status() { return currentStatus; }
+  wl_status_t begin(const char* ssid, const char* passphrase = nullptr) { return currentStatus; }
+  bool disconnect(bool wifiOff = false, bool eraseAp = false) { return true; }
+  bool mode(wifi_mode_t mode) { return true; }
+  bool softAP(const char* ssid, const char* passphrase = nullptr) { return true; }
+  IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+  int8_t RSSI() { return -50; }
+  bool setSleep(bool enabled) { return true; }
+
+  // Host only: simulate link loss and recovery.
+  void setStatus(wl_status_t status) { currentStatus = status; }
+};
+
+extern WiFiClass WiFi;
+
+class WiFiClient : public Print {
+protected:
+  int fd;
+  unsigned long timeoutMs;
+  uint8_t peekBuffer[512];
+  size_t peekLength;
+  size_t peekPos;
+  bool fillBuffer(unsigned long waitMs);
+
+public:
+  WiFiClient();
+  explicit WiFiClient(int acceptedFd);  // Host only: adopt an accepted socket
+  virtual ~WiFiClient();
+  WiFiClient(const WiFiClient&) = delete;
+  WiFiClient& operator=(const WiFiClient&) = delete;
+
+  virtual int connect(const char* host, uint16_t port);
+  virtual int connect(const char* host, uint16_t port, int32_t timeoutMs) { setTimeout(timeoutMs); return connect(host, port); }
+  virtual void stop();
+  virtual uint8_t connected();
+  virtual int available();
+  virtual int read();
+  virtual int read(uint8_t* buffer, size_t size);
+  virtual int peek();
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  void setTimeout(unsigned long ms) { timeoutMs = ms; }
+  String readStringUntil(char terminator);
+  operator bool() { return connected(); }
+};
+
+// Listening TCP socket on all interfaces; available() never blocks
+class WiFiServer {
+private:
+  uint16_t port;
+  int fd;
+
+public:
+  explicit WiFiServer(uint16_t port);
+  ~WiFiServer();
+  void begin();
+  void end();
+  WiFiClient available();
+  uint16_t getPort() { return port; }
+};
+
+#endif // HOST_WIFI_H
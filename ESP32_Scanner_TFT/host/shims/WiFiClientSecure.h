@@ -0,0 +1,16 @@
+#ifndef HOST_WIFI_CLIENT_SECURE_H
+#define HOST_WIFI_CLIENT_SECURE_H
+
+// On the host the "secure" client is plain TCP: point the firmware at the
+// local stand-in backend over http:// (or a TLS-terminating proxy).
+
+#include <WiFi.h>
+
+class WiFiClientSecure : public WiFiClient {
+public:
+  void setInsecure() {}
+  void setCACert(const char* rootCA) {}
+  void setHandshakeTimeout(unsigned long seconds) {}
+};
+
+#endif // HOST_WIFI_CLIENT_SECURE_H
@@ -0,0 +1,463 @@
+#include <Arduino.h>
+#include <SPI.h>
+#include <esp_sleep.h>
+#include <esp_heap_caps.h>
+#include <driver/gpio.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include "host_runtime.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+
+namespace {
+
+const int PIN_COUNT = 64;
+const uint32_t DEFAULT_HEAP_SIZE = 320 * 1024;
+
+std::atomic<bool> virtualClock(false);
+std::atomic<unsigned long long> virtualMicros(0);
+const auto startTime = std::chrono::steady_clock::now();
+
+unsigned long long wallMicros() {
+  return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - startTime).count();
+}
+
+struct PinState {
+  uint8_t mode = INPUT;
+  int level = HIGH;
+  void (*handler)(void) = nullptr;
+  int edgeMode = 0;
+  int wakeLevel = -1;  // Light-sleep wake level, -1 = not a wake source
+};
+PinState pins[PIN_COUNT];
+std::mutex pinMutex;
+
+FILE* serialOut = stdout;
+std::string serialIn;
+size_t serialInPos = 0;
+std::mutex serialMutex;
+
+uint32_t cpuFrequencyMhz = 240;
+
+const int LEDC_CHANNELS = 16;
+struct LedcChannel {
+  bool configured = false;
+  uint32_t frequency = 0;
+  uint8_t resolutionBits = 0;
+  uint32_t duty = 0;
+};
+LedcChannel ledc[LEDC_CHANNELS];
+
+// Allocation counting state of one thread; plain data, so touching it
+// from inside malloc never allocates
+struct AllocationState {
+  bool counting;
+  int libraryDepth;
+  host::AllocationCounts counts;
+};
+thread_local AllocationState allocationState;
+std::atomic<bool> allocationHooks(false);
+
+uint64_t sleepTimerUs = 0;
+bool sleepGpioWake = false;
+esp_sleep_wakeup_cause_t lastWakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+bool wakePinActive() {
+  std::lock_guard<std::mutex> lock(pinMutex);
+  for (int i = 0; i < PIN_COUNT; i++) {
+    if (pins[i].wakeLevel >= 0 && pins[i].level == pins[i].wakeLevel) {
+      return true;
+    }
+  }
+  return false;
+}
+std::mt19937 rng(12345);
+
+uint32_t heapSize = DEFAULT_HEAP_SIZE;
+uint32_t (*heapFreeBytes)() = nullptr;
+uint32_t (*heapLargestBlock)() = nullptr;
+uint32_t heapMinFree = DEFAULT_HEAP_SIZE;
+uint32_t (*heapAllocatedBlocks)() = nullptr;
+
+} // namespace
+
+namespace host {
+
+void useVirtualClock(bool enabled) {
+  virtualClock = enabled;
+}
+
+bool isVirtualClock() {
+  return virtualClock;
+}
+
+void advanceClock(unsigned long long micros) {
+  virtualMicros += micros;
+}
+
+unsigned long long clockMicros() {
+  if (virtualClock) {
+    return virtualMicros;
+  }
+  return wallMicros();
+}
+
+BlockingWait::BlockingWait() {
+  startUs = wallMicros();
+}
+
+BlockingWait::~BlockingWait() {
+  // Background tasks never drive the virtual clock
+  if (virtualClock && !isTaskThread()) {
+    virtualMicros += wallMicros() - startUs;
+  }
+}
+
+void setPinLevel(uint8_t pin, int level) {
+  if (pin >= PIN_COUNT) return;
+  void (*handler)(void) = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(pinMutex);
+    PinState& p = pins[pin];
+    int previous = p.level;
+    p.level = level;
+    if (p.handler && previous != level) {
+      bool rising = (level == HIGH);
+      if (p.edgeMode == CHANGE || (p.edgeMode == RISING && rising) || (p.edgeMode == FALLING && !rising)) {
+        handler = p.handler;
+      }
+    }
+  }
+  if (handler) {
+    handler();
+  }
+}
+
+int getPinLevel(uint8_t pin) {
+  if (pin >= PIN_COUNT) return LOW;
+  std::lock_guard<std::mutex> lock(pinMutex);
+  return pins[pin].level;
+}
+
+bool getLedcOutput(uint8_t channel, uint32_t& frequency, uint32_t& duty, uint8_t& resolutionBits) {
+  if (channel >= LEDC_CHANNELS || !ledc[channel].configured) return false;
+  frequency = ledc[channel].frequency;
+  duty = ledc[channel].duty;
+  resolutionBits = ledc[channel].resolutionBits;
+  return true;
+}
+
+void setSerialOutput(FILE* out) {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  serialOut = out;
+}
+
+void setSerialInput(const char* data) {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  serialIn += data;
+}
+
+void setHeapModel(uint32_t size, uint32_t (*freeBytes)(), uint32_t (*largestBlock)()) {
+  heapSize = size;
+  heapFreeBytes = freeBytes;
+  heapLargestBlock = largestBlock;
+  heapMinFree = size;
+}
+
+void setHeapBlockModel(uint32_t (*allocatedBlocks)()) {
+  heapAllocatedBlocks = allocatedBlocks;
+}
+
+void startAllocationCount() {
+  memset(&allocationState.counts, 0, sizeof(allocationState.counts));
+  allocationState.counting = true;
+}
+
+AllocationCounts stopAllocationCount() {
+  allocationState.counting = false;
+  return allocationState.counts;
+}
+
+bool allocationHooksLinked() {
+  return allocationHooks;
+}
+
+LibraryScope::LibraryScope() {
+  allocationState.libraryDepth++;
+}
+
+LibraryScope::~LibraryScope() {
+  allocationState.libraryDepth--;
+}
+
+bool inLibraryScope() {
+  return allocationState.libraryDepth > 0;
+}
+
+bool noteAllocation(size_t bytes) {
+  allocationHooks.store(true, std::memory_order_relaxed);
+  AllocationState& state = allocationState;
+  if (!state.counting) {
+    return false;
+  }
+  if (state.libraryDepth > 0) {
+    state.counts.libraryAllocations++;
+    state.counts.libraryBytes += bytes;
+    return false;
+  }
+  state.counts.allocations++;
+  state.counts.bytes += bytes;
+  return true;
+}
+
+void noteFree() {
+  if (allocationState.counting) {
+    allocationState.counts.frees++;
+  }
+}
+
+} // namespace host
+
+unsigned long millis() {
+  return (unsigned long)(uint32_t)(host::clockMicros() / 1000ULL);
+}
+
+unsigned long micros() {
+  return (unsigned long)(uint32_t)host::clockMicros();
+}
+
+void delay(unsigned long ms) {
+  if (virtualClock && host::isTaskThread()) {
+    // Background tasks never drive the virtual clock; they wait for the
+    // main thread to move it past their wake time
+    unsigned long long wake = virtualMicros + (unsigned long long)ms * 1000ULL;
+    while (virtualClock && virtualMicros < wake) {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  } else if (virtualClock) {
+    virtualMicros += (unsigned long long)ms * 1000ULL;
+  } else {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  }
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (virtualClock) {
+    virtualMicros += us;
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  }
+}
+
+void yield() {
+  if (!virtualClock) {
+    std::this_thread::yield();
+  }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= PIN_COUNT) return;
+  std::lock_guard<std::mutex> lock(pinMutex);
+  pins[pin].mode = mode;
+  if (mode == INPUT_PULLUP) pins[pin].level = HIGH;
+  if (mode == INPUT_PULLDOWN) pins[pin].level = LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin >= PIN_COUNT) return;
+  std::lock_guard<std::mutex> lock(pinMutex);
+  pins[pin].level = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  return host::getPinLevel(pin);
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+  if (pin >= PIN_COUNT) return;
+  std::lock_guard<std::mutex> lock(pinMutex);
+  pins[pin].handler = handler;
+  pins[pin].edgeMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin >= PIN_COUNT) return;
+  std::lock_guard<std::mutex> lock(pinMutex);
+  pins[pin].handler = nullptr;
+}
+
+uint32_t ledcSetup(uint8_t channel, uint32_t frequency, uint8_t resolutionBits) {
+  if (channel >= LEDC_CHANNELS || resolutionBits == 0 || resolutionBits > 20 || frequency == 0) return 0;
+  // The timer divides the 80 MHz APB clock, or the 1 MHz REF_TICK for slow
+  // rates, by at most 1023 (plus fraction); outside that range it fails
+  uint64_t counts = (uint64_t)frequency << resolutionBits;
+  if (counts > 80000000ULL || counts * 1024 <= 1000000ULL) return 0;
+  ledc[channel].configured = true;
+  ledc[channel].frequency = frequency;
+  ledc[channel].resolutionBits = resolutionBits;
+  return frequency;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+  (void)pin;
+  (void)channel;
+}
+
+void ledcDetachPin(uint8_t pin) {
+  (void)pin;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+  if (channel >= LEDC_CHANNELS) return;
+  ledc[channel].duty = duty;
+}
+
+long random(long max) {
+  if (max <= 0) return 0;
+  return (long)(rng() % (unsigned long)max);
+}
+
+long random(long min, long max) {
+  if (max <= min) return min;
+  return min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+  rng.seed((uint32_t)seed);
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+  cpuFrequencyMhz = mhz;
+  return true;
+}
+
+uint32_t getCpuFrequencyMhz() {
+  return cpuFrequencyMhz;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio, gpio_int_type_t type) {
+  if (gpio < 0 || gpio >= PIN_COUNT) return ESP_ERR_INVALID_ARG;
+  if (type != GPIO_INTR_LOW_LEVEL && type != GPIO_INTR_HIGH_LEVEL) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> lock(pinMutex);
+  pins[gpio].wakeLevel = (type == GPIO_INTR_HIGH_LEVEL) ? HIGH : LOW;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio) {
+  if (gpio < 0 || gpio >= PIN_COUNT) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> lock(pinMutex);
+  pins[gpio].wakeLevel = -1;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeInUs) {
+  sleepTimerUs = timeInUs;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+  sleepGpioWake = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source) {
+  if (source == ESP_SLEEP_WAKEUP_TIMER || source == ESP_SLEEP_WAKEUP_ALL) sleepTimerUs = 0;
+  if (source == ESP_SLEEP_WAKEUP_GPIO || source == ESP_SLEEP_WAKEUP_ALL) sleepGpioWake = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+  if (sleepTimerUs == 0 && !sleepGpioWake) return ESP_ERR_INVALID_STATE;
+  // Sleep in 1ms steps so a pin driven from another thread wakes us
+  unsigned long long start = host::clockMicros();
+  while (true) {
+    if (sleepGpioWake && wakePinActive()) {
+      lastWakeCause = ESP_SLEEP_WAKEUP_GPIO;
+      return ESP_OK;
+    }
+    if (sleepTimerUs > 0 && host::clockMicros() - start >= sleepTimerUs) {
+      lastWakeCause = ESP_SLEEP_WAKEUP_TIMER;
+      return ESP_OK;
+    }
+    if (virtualClock) {
+      virtualMicros += 1000;
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return lastWakeCause;
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2, const char* server3) {
+  // The host clock is already synchronised.
+}
+
+int HardwareSerial::available() {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  return (int)(serialIn.size() - serialInPos);
+}
+
+int HardwareSerial::read() {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  if (serialInPos >= serialIn.size()) return -1;
+  return (unsigned char)serialIn[serialInPos++];
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  if (serialOut) {
+    fwrite(buffer, 1, size, serialOut);
+  }
+  return size;
+}
+
+void HardwareSerial::flush() {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  if (serialOut) fflush(serialOut);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  uint32_t free = heapFreeBytes ? heapFreeBytes() : heapSize;
+  if (free < heapMinFree) heapMinFree = free;
+  return free;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  getFreeHeap();
+  return heapMinFree;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return heapLargestBlock ? heapLargestBlock() : getFreeHeap();
+}
+
+uint32_t EspClass::getHeapSize() {
+  return heapSize;
+}
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps) {
+  (void)caps;
+  info->total_free_bytes = ESP.getFreeHeap();
+  info->total_allocated_bytes = heapSize - info->total_free_bytes;
+  info->largest_free_block = ESP.getMaxAllocHeap();
+  info->minimum_free_bytes = ESP.getMinFreeHeap();
+  info->allocated_blocks = heapAllocatedBlocks ? heapAllocatedBlocks() : 0;
+  info->free_blocks = 0;
+  info->total_blocks = info->allocated_blocks;
+}
@@ -0,0 +1,43 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// Host stand-in for the FreeRTOS subset the firmware uses. Tasks are
+// std::threads, queues and semaphores are mutex/condvar backed. Tick = 1 ms.
+
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  0
+#define pdPASS  1
+#define errQUEUE_FULL 0
+
+#define portMAX_DELAY      ((TickType_t)0xFFFFFFFF)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+#define configMAX_PRIORITIES 25
+#define tskIDLE_PRIORITY   0
+#define tskNO_AFFINITY     0x7FFFFFFF
+
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+// Critical sections map onto one global recursive lock
+struct portMUX_TYPE {
+  int unused;
+};
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void hostEnterCritical(portMUX_TYPE* mux);
+void hostExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux)     hostEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)      hostExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) hostEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)  hostExitCritical(mux)
+
+BaseType_t xPortGetCoreID();
+
+#endif // HOST_FREERTOS_H
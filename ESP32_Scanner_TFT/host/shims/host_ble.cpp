@@ -0,0 +1,180 @@
+#include <Arduino.h>
+#include <BLEDevice.h>
+#include <chrono>
+#include <thread>
+#include "host_ble.h"
+#include "host_runtime.h"
+
+namespace {
+
+BLEScan scanInstance;
+bool initialized = false;
+host::AdvertisementSource* advertisementSource = nullptr;
+unsigned long long delivered = 0;
+
+} // namespace
+
+namespace host {
+
+void setAdvertisementSource(AdvertisementSource* source) {
+  advertisementSource = source;
+}
+
+AdvertisementSource* getAdvertisementSource() {
+  return advertisementSource;
+}
+
+unsigned long long advertisementsDelivered() {
+  return delivered;
+}
+
+} // namespace host
+
+BLEAdvertisedDevice::BLEAdvertisedDevice() {
+  rssi = 0;
+  hasName = false;
+  hasManufacturerData = false;
+  hasServiceData = false;
+  payloadLength = 0;
+}
+
+BLEAdvertisedDevice::BLEAdvertisedDevice(const uint8_t* addr, int rssiValue, const uint8_t* data, size_t length)
+  : BLEAdvertisedDevice() {
+  address = BLEAddress(addr);
+  rssi = rssiValue;
+  payloadLength = length < sizeof(payload) ? length : sizeof(payload);
+  memcpy(payload, data, payloadLength);
+
+  // Walk the AD structures: [len][type][data...]
+  size_t pos = 0;
+  while (pos < payloadLength) {
+    uint8_t len = payload[pos];
+    if (len == 0 || pos + 1 + len > payloadLength) break;
+    uint8_t type = payload[pos + 1];
+    const char* field = (const char*)&payload[pos + 2];
+    size_t fieldLength = len - 1;
+
+    switch (type) {
+      case 0x08: // Shortened local name
+      case 0x09: // Complete local name
+        name.assign(field, fieldLength);
+        hasName = true;
+        break;
+      case 0x02: // Incomplete 16-bit UUIDs
+      case 0x03: // Complete 16-bit UUIDs
+        for (size_t i = 0; i + 1 < fieldLength; i += 2) {
+          uint16_t uuid16 = (uint8_t)field[i] | ((uint8_t)field[i + 1] << 8);
+          serviceUUIDs.push_back(BLEUUID(uuid16));
+        }
+        break;
+      case 0x06: // Incomplete 128-bit UUIDs
+      case 0x07: // Complete 128-bit UUIDs
+        for (size_t i = 0; i + 15 < fieldLength; i += 16) {
+          char text[37];
+          const uint8_t* b = (const uint8_t*)field + i;
+          snprintf(text, sizeof(text),
+                   "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+                   b[15], b[14], b[13], b[12], b[11], b[10], b[9], b[8],
+                   b[7], b[6], b[5], b[4], b[3], b[2], b[1], b[0]);
+          serviceUUIDs.push_back(BLEUUID(text));
+        }
+        break;
+      case 0x16: // Service data (16-bit UUID)
+        if (fieldLength >= 2) {
+          uint16_t uuid16 = (uint8_t)field[0] | ((uint8_t)field[1] << 8);
+          serviceUUIDs.push_back(BLEUUID(uuid16));
+          serviceData.assign(field + 2, fieldLength - 2);
+          hasServiceData = true;
+        }
+        break;
+      case 0xFF: // Manufacturer specific data
+        manufacturerData.assign(field, fieldLength);
+        hasManufacturerData = true;
+        break;
+      default:
+        break;
+    }
+    pos += 1 + len;
+  }
+}
+
+bool BLEAdvertisedDevice::isAdvertisingService(BLEUUID uuid) {
+  for (auto& serviceUUID : serviceUUIDs) {
+    if (serviceUUID.equals(uuid)) return true;
+  }
+  return false;
+}
+
+BLEScan::BLEScan() {
+  callbacks = nullptr;
+  activeScan = false;
+  wantDuplicates = false;
+  stopRequested = false;
+  interval = 100;
+  window = 100;
+}
+
+void BLEScan::setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* cb, bool duplicates, bool shouldParse) {
+  callbacks = cb;
+  wantDuplicates = duplicates;
+}
+
+BLEScanResults BLEScan::start(uint32_t duration, bool is_continue) {
+  stopRequested = false;
+  unsigned long long endUs = host::clockMicros() + (unsigned long long)duration * 1000000ULL;
+  int count = 0;
+  host::RawAdvertisement adv;
+
+  while (!stopRequested && host::clockMicros() < endUs) {
+    host::AdvertisementSource* source = advertisementSource;
+    bool got = false;
+    if (source) {
+      unsigned long long until = host::isVirtualClock() ? endUs : host::clockMicros();
+      got = source->next(until, adv);
+    }
+
+    if (got) {
+      if (host::isVirtualClock() && adv.timestampUs > host::clockMicros()) {
+        host::advanceClock(adv.timestampUs - host::clockMicros());
+      }
+      if (callbacks) {
+        delivered++;
+        count++;
+        // Parsing the report is the BLE stack's work, not the firmware's
+        BLEAdvertisedDevice device;
+        {
+          host::LibraryScope scope;
+          device = BLEAdvertisedDevice(adv.address, adv.rssi, adv.payload, adv.payloadLength);
+        }
+        callbacks->onResult(std::move(device));
+      }
+    } else if (host::isVirtualClock()) {
+      host::advanceClock(endUs - host::clockMicros());
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  return BLEScanResults(count);
+}
+
+bool BLEScan::start(uint32_t duration, void (*scanCompleteCB)(BLEScanResults), bool is_continue) {
+  BLEScanResults results = start(duration, is_continue);
+  if (scanCompleteCB) scanCompleteCB(results);
+  return true;
+}
+
+void BLEDevice::init(const std::string& deviceName) {
+  initialized = true;
+}
+
+void BLEDevice::deinit(bool releaseMemory) {
+  initialized = false;
+}
+
+BLEScan* BLEDevice::getScan() {
+  return &scanInstance;
+}
+
+bool BLEDevice::getInitialized() {
+  return initialized;
+}
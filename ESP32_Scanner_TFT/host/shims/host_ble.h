@@ -0,0 +1,36 @@
+#ifndef HOST_BLE_H
+#define HOST_BLE_H
+
+// Host-only hook that feeds advertisements into BLEScan. Sources produce
+// raw advertisements in timestamp order; a running scan delivers each one
+// to the registered callbacks once the host clock reaches its timestamp.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace host {
+
+struct RawAdvertisement {
+  unsigned long long timestampUs;
+  uint8_t address[6];
+  int8_t rssi;
+  uint8_t payloadLength;
+  uint8_t payload[62];
+};
+
+class AdvertisementSource {
+public:
+  virtual ~AdvertisementSource() {}
+  // Fill `out` with the next advertisement at or before `untilUs`.
+  virtual bool next(unsigned long long untilUs, RawAdvertisement& out) = 0;
+};
+
+void setAdvertisementSource(AdvertisementSource* source);
+AdvertisementSource* getAdvertisementSource();
+
+// Statistics for the advertisements the host radio handed to callbacks.
+unsigned long long advertisementsDelivered();
+
+} // namespace host
+
+#endif // HOST_BLE_H
@@ -0,0 +1,302 @@
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "host_runtime.h"
+
+struct HostTask {
+  std::string name;
+  TaskFunction_t function;
+  void* parameter;
+  std::mutex mutex;
+  std::condition_variable signal;
+  uint32_t notifications = 0;
+};
+
+struct HostQueue {
+  size_t length;
+  size_t itemSize;
+  bool isMutex;
+  std::deque<std::vector<uint8_t>> items;
+  size_t tokens = 0;  // Semaphores: available count
+  std::mutex mutex;
+  std::condition_variable changed;
+};
+
+namespace {
+
+struct TaskExit {};
+
+thread_local HostTask* currentTask = nullptr;
+std::recursive_mutex criticalMutex;
+
+// Blocks in 1 ms real-time slices until `ready` holds or `ticks` have passed
+// on the active clock (virtual or real), so timeouts follow the virtual clock.
+template <typename Ready>
+bool waitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, TickType_t ticks, Ready ready) {
+  if (ready()) {
+    return true;
+  }
+  if (ticks == 0) {
+    return false;
+  }
+  if (host::isVirtualClock() && !host::isTaskThread() && ticks != portMAX_DELAY) {
+    // The main thread drives the virtual clock: give other threads a moment
+    // to deliver, then let the timeout elapse in one step as delay() does
+    cv.wait_for(lock, std::chrono::milliseconds(1), ready);
+    if (!ready()) {
+      host::advanceClock((unsigned long long)ticks * 1000ULL);
+    }
+    return ready();
+  }
+  unsigned long long deadline = host::clockMicros() + (unsigned long long)ticks * 1000ULL;
+  while (!ready()) {
+    if (ticks != portMAX_DELAY && host::clockMicros() >= deadline) {
+      return false;
+    }
+    cv.wait_for(lock, std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+void taskMain(HostTask* task) {
+  currentTask = task;
+  try {
+    task->function(task->parameter);
+  } catch (const TaskExit&) {
+  }
+}
+
+} // namespace
+
+namespace host {
+
+bool isTaskThread() {
+  return currentTask != nullptr;
+}
+
+} // namespace host
+
+void hostEnterCritical(portMUX_TYPE* mux) {
+  (void)mux;
+  criticalMutex.lock();
+}
+
+void hostExitCritical(portMUX_TYPE* mux) {
+  (void)mux;
+  criticalMutex.unlock();
+}
+
+BaseType_t xPortGetCoreID() {
+  return currentTask ? 0 : 1;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+  (void)stackDepth;
+  (void)priority;
+  (void)core;
+  HostTask* task = new HostTask();
+  task->name = name ? name : "";
+  task->function = function;
+  task->parameter = parameter;
+  if (handle) {
+    *handle = task;
+  }
+  std::thread(taskMain, task).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                       void* parameter, UBaseType_t priority, TaskHandle_t* handle) {
+  return xTaskCreatePinnedToCore(function, name, stackDepth, parameter, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  // Only self-deletion is supported; the handle is leaked deliberately
+  if (task == nullptr || task == currentTask) {
+    throw TaskExit();
+  }
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks);
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return currentTask;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  (void)task;
+  return 0;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+  if (!task) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(task->mutex);
+  task->notifications++;
+  task->signal.notify_all();
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+  xTaskNotifyGive(task);
+  if (higherPriorityTaskWoken) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+  HostTask* task = currentTask;
+  if (!task) {
+    return 0;
+  }
+  std::unique_lock<std::mutex> lock(task->mutex);
+  waitUntil(lock, task->signal, ticksToWait, [task] { return task->notifications > 0; });
+  uint32_t value = task->notifications;
+  if (value > 0) {
+    task->notifications = clearOnExit ? 0 : value - 1;
+  }
+  return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  HostQueue* queue = new HostQueue();
+  queue->length = length;
+  queue->itemSize = itemSize;
+  queue->isMutex = false;
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!waitUntil(lock, queue->changed, ticksToWait, [queue] { return queue->items.size() < queue->length; })) {
+    return errQUEUE_FULL;
+  }
+  const uint8_t* bytes = (const uint8_t*)item;
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+  return xQueueSend(queue, item, ticksToWait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!waitUntil(lock, queue->changed, ticksToWait, [queue] { return !queue->items.empty(); })) {
+    return pdFALSE;
+  }
+  memcpy(buffer, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!waitUntil(lock, queue->changed, ticksToWait, [queue] { return !queue->items.empty(); })) {
+    return pdFALSE;
+  }
+  memcpy(buffer, queue->items.front().data(), queue->itemSize);
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t queue, void* buffer, BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return xQueueReceive(queue, buffer, 0);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  return queue->isMutex || queue->itemSize == 0 ? queue->tokens : queue->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  return queue->length - queue->items.size();
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  queue->items.clear();
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  HostQueue* semaphore = new HostQueue();
+  semaphore->length = 1;
+  semaphore->itemSize = 0;
+  semaphore->isMutex = true;
+  semaphore->tokens = 1;
+  return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  HostQueue* semaphore = new HostQueue();
+  semaphore->length = 1;
+  semaphore->itemSize = 0;
+  semaphore->isMutex = false;
+  semaphore->tokens = 0;
+  return semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(semaphore->mutex);
+  if (!waitUntil(lock, semaphore->changed, ticksToWait, [semaphore] { return semaphore->tokens > 0; })) {
+    return pdFALSE;
+  }
+  semaphore->tokens--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  std::lock_guard<std::mutex> lock(semaphore->mutex);
+  if (semaphore->tokens >= semaphore->length) {
+    return pdFALSE;
+  }
+  semaphore->tokens++;
+  semaphore->changed.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return xSemaphoreGive(semaphore);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
@@ -0,0 +1,176 @@
+#include <HTTPClient.h>
+#include "host_runtime.h"
+
+HTTPClient::HTTPClient() {
+  client = nullptr;
+  port = 80;
+  timeoutMs = 5000;
+  reuse = false;
+  lastCode = 0;
+}
+
+bool HTTPClient::parseUrl(const String& url) {
+  String rest = url;
+  port = 80;
+  if (rest.startsWith("https://")) {
+    rest = rest.substring(8);
+    port = 443;
+  } else if (rest.startsWith("http://")) {
+    rest = rest.substring(7);
+  }
+
+  int slash = rest.indexOf('/');
+  host = slash >= 0 ? rest.substring(0, slash) : rest;
+  path = slash >= 0 ? rest.substring(slash) : String("/");
+
+  int colon = host.indexOf(':');
+  if (colon >= 0) {
+    port = (uint16_t)host.substring(colon + 1).toInt();
+    host = host.substring(0, colon);
+  }
+  return host.length() > 0;
+}
+
+bool HTTPClient::begin(const String& url) {
+  host::LibraryScope scope;
+  client = &ownClient;
+  headers.clear();
+  return parseUrl(url);
+}
+
+bool HTTPClient::begin(WiFiClient& externalClient, const String& url) {
+  host::LibraryScope scope;
+  client = &externalClient;
+  headers.clear();
+  return parseUrl(url);
+}
+
+void HTTPClient::end() {
+  host::LibraryScope scope;
+  if (client) {
+    client->stop();
+  }
+  client = nullptr;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+  host::LibraryScope scope;
+  headers.push_back(std::make_pair(name, value));
+}
+
+int HTTPClient::GET() {
+  return sendRequest("GET", nullptr, 0);
+}
+
+int HTTPClient::POST(const String& payload) {
+  return sendRequest("POST", (const uint8_t*)payload.c_str(), payload.length());
+}
+
+int HTTPClient::POST(uint8_t* payload, size_t size) {
+  return sendRequest("POST", payload, size);
+}
+
+int HTTPClient::sendRequest(const char* method, const uint8_t* payload, size_t size) {
+  host::LibraryScope scope;
+  body = "";
+  if (!client) return HTTPC_ERROR_NOT_CONNECTED;
+
+  client->setTimeout(timeoutMs);
+  if (!client->connect(host.c_str(), port)) {
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+
+  String request = String(method) + " " + path + " HTTP/1.1\r\n";
+  request += "Host: " + host + "\r\n";
+  request += "Connection: close\r\n";
+  for (const auto& header : headers) {
+    request += header.first + ": " + header.second + "\r\n";
+  }
+  request += "Content-Length: " + String((unsigned long)size) + "\r\n\r\n";
+
+  if (client->write((const uint8_t*)request.c_str(), request.length()) != request.length()) {
+    client->stop();
+    return HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+  if (size > 0 && client->write(payload, size) != size) {
+    client->stop();
+    return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+  }
+
+  String statusLine = client->readStringUntil('\n');
+  if (statusLine.length() == 0) {
+    client->stop();
+    return client->connected() ? HTTPC_ERROR_READ_TIMEOUT : HTTPC_ERROR_CONNECTION_LOST;
+  }
+  int space = statusLine.indexOf(' ');
+  if (!statusLine.startsWith("HTTP/") || space < 0) {
+    client->stop();
+    return HTTPC_ERROR_NO_HTTP_SERVER;
+  }
+  int code = (int)statusLine.substring(space + 1).toInt();
+
+  long contentLength = -1;
+  bool chunked = false;
+  for (;;) {
+    String line = client->readStringUntil('\n');
+    line.trim();
+    if (line.length() == 0) break;
+    String lower = line;
+    lower.toLowerCase();
+    if (lower.startsWith("content-length:")) {
+      contentLength = lower.substring(15).toInt();
+    } else if (lower.startsWith("transfer-encoding:") && lower.indexOf("chunked") >= 0) {
+      chunked = true;
+    }
+  }
+
+  std::string data;
+  uint8_t buffer[1024];
+  if (chunked) {
+    for (;;) {
+      String sizeLine = client->readStringUntil('\n');
+      long chunkSize = strtol(sizeLine.c_str(), nullptr, 16);
+      if (chunkSize <= 0) break;
+      while (chunkSize > 0) {
+        int n = client->read(buffer, chunkSize < (long)sizeof(buffer) ? (size_t)chunkSize : sizeof(buffer));
+        if (n <= 0) break;
+        data.append((const char*)buffer, (size_t)n);
+        chunkSize -= n;
+      }
+      client->readStringUntil('\n');
+    }
+  } else {
+    while (contentLength < 0 || (long)data.size() < contentLength) {
+      size_t want = sizeof(buffer);
+      if (contentLength >= 0 && (long)(contentLength - data.size()) < (long)want) {
+        want = (size_t)(contentLength - data.size());
+      }
+      int n = client->read(buffer, want);
+      if (n <= 0) break;
+      data.append((const char*)buffer, (size_t)n);
+    }
+    if (contentLength >= 0 && (long)data.size() < contentLength) {
+      client->stop();
+      return HTTPC_ERROR_CONNECTION_LOST;
+    }
+  }
+
+  body = String(data);
+  lastCode = code;
+  client->stop();
+  return code;
+}
+
+String HTTPClient::errorToString(int error) {
+  host::LibraryScope scope;
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+    case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+    case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+    case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+    case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+    default: return String();
+  }
+}
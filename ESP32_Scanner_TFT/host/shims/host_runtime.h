@@ -0,0 +1,79 @@
+#ifndef HOST_RUNTIME_H
+#define HOST_RUNTIME_H
+
+// Controls for the host runtime that have no Arduino equivalent: the clock
+// source, simulated GPIO input levels and serial output routing.
+
+#include <cstdint>
+#include <cstdio>
+
+namespace host {
+
+// With the virtual clock, millis()/micros() only move when delay() is called
+// or advanceClock() is used, so hours of firmware time run in seconds.
+void useVirtualClock(bool enabled);
+bool isVirtualClock();
+void advanceClock(unsigned long long micros);
+unsigned long long clockMicros();
+
+// Wall-clock stopwatch for code that blocks for real (sockets). With the
+// virtual clock, the main thread's blocked time is added to firmware time
+// when the BlockingWait ends, so network latency shows up in metrics.
+class BlockingWait {
+public:
+  BlockingWait();
+  ~BlockingWait();
+
+private:
+  unsigned long long startUs;
+};
+
+// True on threads started through xTaskCreate*
+bool isTaskThread();
+
+// Drive a simulated input pin; attached interrupts fire on matching edges.
+void setPinLevel(uint8_t pin, int level);
+int getPinLevel(uint8_t pin);
+
+// Current LEDC setup of a channel; false if it was never configured
+bool getLedcOutput(uint8_t channel, uint32_t& frequency, uint32_t& duty, uint8_t& resolutionBits);
+
+// Serial output goes to stdout by default; nullptr silences it.
+void setSerialOutput(FILE* out);
+void setSerialInput(const char* data);
+
+// Heap figures reported through ESP.getFreeHeap() and friends.
+void setHeapModel(uint32_t heapSize, uint32_t (*freeBytes)(), uint32_t (*largestBlock)());
+// Live block count reported through heap_caps_get_info()
+void setHeapBlockModel(uint32_t (*allocatedBlocks)());
+
+// Heap allocations made by the calling thread between start and stop.
+// Counts only move in binaries that link host/alloc_hooks.cpp, which
+// interposes malloc; elsewhere they stay zero.
+struct AllocationCounts {
+  unsigned long allocations;
+  unsigned long bytes;
+  unsigned long frees;
+  unsigned long libraryAllocations;  // Made inside a LibraryScope
+  unsigned long libraryBytes;
+};
+void startAllocationCount();
+AllocationCounts stopAllocationCount();
+bool allocationHooksLinked();
+
+// Marks code in the Arduino and ESP-IDF stand-ins, so its allocations are
+// counted as library rather than firmware allocations
+class LibraryScope {
+public:
+  LibraryScope();
+  ~LibraryScope();
+};
+bool inLibraryScope();
+
+// Called by the malloc hooks; true when the allocation counted as firmware
+bool noteAllocation(size_t bytes);
+void noteFree();
+
+} // namespace host
+
+#endif // HOST_RUNTIME_H
@@ -0,0 +1,244 @@
+#include <Adafruit_ST7735.h>
+#include <string>
+
+namespace {
+
+Adafruit_ST7735* lastPanel = nullptr;
+
+void toRGB888(uint16_t c, uint8_t* rgb) {
+  rgb[0] = (uint8_t)(((c >> 11) & 0x1F) * 255 / 31);
+  rgb[1] = (uint8_t)(((c >> 5) & 0x3F) * 255 / 63);
+  rgb[2] = (uint8_t)((c & 0x1F) * 255 / 31);
+}
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t len) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int k = 0; k < 8; k++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+void putBE32(std::string& out, uint32_t v) {
+  out.push_back((char)(v >> 24));
+  out.push_back((char)(v >> 16));
+  out.push_back((char)(v >> 8));
+  out.push_back((char)v);
+}
+
+void writeChunk(FILE* f, const char* type, const std::string& data) {
+  std::string chunk(type, 4);
+  chunk += data;
+  std::string len;
+  putBE32(len, (uint32_t)data.size());
+  std::string crc;
+  putBE32(crc, crc32(0, (const uint8_t*)chunk.data(), chunk.size()));
+  fwrite(len.data(), 1, 4, f);
+  fwrite(chunk.data(), 1, chunk.size(), f);
+  fwrite(crc.data(), 1, 4, f);
+}
+
+} // namespace
+
+Adafruit_ST7735* Adafruit_ST7735::lastCreated() {
+  return lastPanel;
+}
+
+Adafruit_ST7735::Adafruit_ST7735(int8_t cs, int8_t dc, int8_t rst)
+  : Adafruit_GFX(128, 160) {
+  lastPanel = this;
+  memset(framebuffer, 0, sizeof(framebuffer));
+  windowX = windowY = 0;
+  windowW = windowH = 0;
+  windowPos = 0;
+  resetStats();
+}
+
+Adafruit_ST7735::Adafruit_ST7735(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst)
+  : Adafruit_ST7735(cs, dc, rst) {
+}
+
+void Adafruit_ST7735::initR(uint8_t options) {
+  // 128x128 panels report a 128x128 drawable area like the real driver
+  if (options == INITR_144GREENTAB || options == INITR_BLACKTAB) {
+    WIDTH = 128;
+    HEIGHT = options == INITR_144GREENTAB ? 128 : 160;
+  }
+  _width = WIDTH;
+  _height = HEIGHT;
+  memset(framebuffer, 0, sizeof(framebuffer));
+}
+
+void Adafruit_ST7735::setRotation(uint8_t r) {
+  Adafruit_GFX::setRotation(r);
+  // MADCTL write
+  stats.spiBytes += 2;
+}
+
+void Adafruit_ST7735::chargeWindow(int16_t x, int16_t y, int16_t w, int16_t h) {
+  stats.addrWindows++;
+  stats.spiBytes += ADDR_WINDOW_BYTES;
+}
+
+void Adafruit_ST7735::store(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+  framebuffer[y * _width + x] = color;
+  stats.pixelsWritten++;
+  stats.spiBytes += 2;
+}
+
+void Adafruit_ST7735::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+  chargeWindow(x, y, 1, 1);
+  store(x, y, color);
+}
+
+void Adafruit_ST7735::writePixel(int16_t x, int16_t y, uint16_t color) {
+  drawPixel(x, y, color);
+}
+
+void Adafruit_ST7735::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (w < 0) { x += w + 1; w = -w; }
+  if (h < 0) { y += h + 1; h = -h; }
+  int16_t x2 = x + w, y2 = y + h;
+  if (x < 0) x = 0;
+  if (y < 0) y = 0;
+  if (x2 > _width) x2 = _width;
+  if (y2 > _height) y2 = _height;
+  if (x >= x2 || y >= y2) return;
+
+  chargeWindow(x, y, x2 - x, y2 - y);
+  for (int16_t row = y; row < y2; row++) {
+    for (int16_t col = x; col < x2; col++) {
+      store(col, row, color);
+    }
+  }
+}
+
+void Adafruit_ST7735::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  fillRect(x, y, w, h, color);
+}
+
+void Adafruit_ST7735::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void Adafruit_ST7735::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void Adafruit_ST7735::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void Adafruit_ST7735::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void Adafruit_ST7735::fillScreen(uint16_t color) {
+  fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_ST7735::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  windowX = x;
+  windowY = y;
+  windowW = w;
+  windowH = h;
+  windowPos = 0;
+  chargeWindow(x, y, w, h);
+}
+
+void Adafruit_ST7735::writePixels(uint16_t* colors, uint32_t len, bool block, bool bigEndian) {
+  for (uint32_t i = 0; i < len; i++) {
+    pushColor(bigEndian ? (uint16_t)((colors[i] >> 8) | (colors[i] << 8)) : colors[i]);
+  }
+}
+
+void Adafruit_ST7735::pushColor(uint16_t color) {
+  if (windowW <= 0 || windowH <= 0) return;
+  int32_t area = (int32_t)windowW * windowH;
+  int16_t x = windowX + (int16_t)(windowPos % windowW);
+  int16_t y = windowY + (int16_t)((windowPos / windowW) % windowH);
+  windowPos = (windowPos + 1) % area;
+  store(x, y, color);
+}
+
+void Adafruit_ST7735::drawRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap, int16_t w, int16_t h) {
+  setAddrWindow(x, y, w, h);
+  writePixels(bitmap, (uint32_t)w * h);
+}
+
+uint16_t Adafruit_ST7735::getPixel(int16_t x, int16_t y) const {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  return framebuffer[y * _width + x];
+}
+
+void Adafruit_ST7735::resetStats() {
+  stats.pixelsWritten = 0;
+  stats.spiBytes = 0;
+  stats.addrWindows = 0;
+}
+
+bool Adafruit_ST7735::writePPM(const char* path) const {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P6\n%d %d\n255\n", _width, _height);
+  for (int32_t i = 0; i < (int32_t)_width * _height; i++) {
+    uint8_t rgb[3];
+    toRGB888(framebuffer[i], rgb);
+    fwrite(rgb, 1, 3, f);
+  }
+  fclose(f);
+  return true;
+}
+
+bool Adafruit_ST7735::writePNG(const char* path) const {
+  // Uncompressed (stored) deflate keeps this free of zlib
+  std::string raw;
+  for (int16_t y = 0; y < _height; y++) {
+    raw.push_back(0); // filter: none
+    for (int16_t x = 0; x < _width; x++) {
+      uint8_t rgb[3];
+      toRGB888(framebuffer[y * _width + x], rgb);
+      raw.append((const char*)rgb, 3);
+    }
+  }
+
+  std::string zdata("\x78\x01", 2);
+  uint32_t a = 1, b = 0;
+  for (unsigned char c : raw) {
+    a = (a + c) % 65521;
+    b = (b + a) % 65521;
+  }
+  for (size_t pos = 0; pos < raw.size() || pos == 0; pos += 65535) {
+    size_t n = std::min<size_t>(65535, raw.size() - pos);
+    bool last = pos + n >= raw.size();
+    zdata.push_back(last ? 1 : 0);
+    zdata.push_back((char)(n & 0xFF));
+    zdata.push_back((char)(n >> 8));
+    zdata.push_back((char)(~n & 0xFF));
+    zdata.push_back((char)((~n >> 8) & 0xFF));
+    zdata.append(raw, pos, n);
+    if (last) {
+      break;
+    }
+  }
+  putBE32(zdata, (b << 16) | a);
+
+  std::string header;
+  putBE32(header, (uint32_t)_width);
+  putBE32(header, (uint32_t)_height);
+  header += std::string("\x08\x02\x00\x00\x00", 5); // 8-bit RGB
+
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  fwrite("\x89PNG\r\n\x1a\n", 1, 8, f);
+  writeChunk(f, "IHDR", header);
+  writeChunk(f, "IDAT", zdata);
+  writeChunk(f, "IEND", std::string());
+  fclose(f);
+  return true;
+}
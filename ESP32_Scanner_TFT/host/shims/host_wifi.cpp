@@ -0,0 +1,228 @@
+#include <WiFi.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include "host_runtime.h"
+
+WiFiClass WiFi;
+
+WiFiClient::WiFiClient() {
+  fd = -1;
+  timeoutMs = 5000;
+  peekLength = 0;
+  peekPos = 0;
+}
+
+WiFiClient::WiFiClient(int acceptedFd) : WiFiClient() {
+  fd = acceptedFd;
+}
+
+WiFiClient::~WiFiClient() {
+  stop();
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  host::LibraryScope scope;
+  stop();
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  char portStr[8];
+  snprintf(portStr, sizeof(portStr), "%u", port);
+
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(host, portStr, &hints, &result) != 0 || !result) {
+    return 0;
+  }
+
+  int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+  if (sock < 0) {
+    freeaddrinfo(result);
+    return 0;
+  }
+
+  host::BlockingWait wait;
+  if (::connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
+    ::close(sock);
+    freeaddrinfo(result);
+    return 0;
+  }
+  freeaddrinfo(result);
+
+  int one = 1;
+  setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  fd = sock;
+  peekLength = 0;
+  peekPos = 0;
+  return 1;
+}
+
+void WiFiClient::stop() {
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+  peekLength = 0;
+  peekPos = 0;
+}
+
+bool WiFiClient::fillBuffer(unsigned long waitMs) {
+  if (peekPos < peekLength) return true;
+  if (fd < 0) return false;
+
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  host::BlockingWait wait;
+  int ready = poll(&pfd, 1, (int)waitMs);
+  if (ready <= 0) return false;
+
+  ssize_t n = ::recv(fd, peekBuffer, sizeof(peekBuffer), 0);
+  if (n <= 0) {
+    ::close(fd);
+    fd = -1;
+    return false;
+  }
+  peekLength = (size_t)n;
+  peekPos = 0;
+  return true;
+}
+
+uint8_t WiFiClient::connected() {
+  if (peekPos < peekLength) return 1;
+  if (fd < 0) return 0;
+
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  if (poll(&pfd, 1, 0) > 0) {
+    uint8_t probe;
+    ssize_t n = ::recv(fd, &probe, 1, MSG_PEEK);
+    if (n == 0) {
+      ::close(fd);
+      fd = -1;
+      return 0;
+    }
+  }
+  return 1;
+}
+
+int WiFiClient::available() {
+  if (peekPos < peekLength) return (int)(peekLength - peekPos);
+  fillBuffer(0);
+  return (int)(peekLength - peekPos);
+}
+
+int WiFiClient::read() {
+  if (!fillBuffer(timeoutMs)) return -1;
+  return peekBuffer[peekPos++];
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+  size_t copied = 0;
+  while (copied < size && fillBuffer(copied == 0 ? timeoutMs : 0)) {
+    size_t chunk = peekLength - peekPos;
+    if (chunk > size - copied) chunk = size - copied;
+    memcpy(buffer + copied, peekBuffer + peekPos, chunk);
+    peekPos += chunk;
+    copied += chunk;
+  }
+  return (int)copied;
+}
+
+int WiFiClient::peek() {
+  if (!fillBuffer(timeoutMs)) return -1;
+  return peekBuffer[peekPos];
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+  if (fd < 0) return 0;
+  host::BlockingWait wait;
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t n = ::send(fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) continue;
+      stop();
+      break;
+    }
+    sent += (size_t)n;
+  }
+  return sent;
+}
+
+String WiFiClient::readStringUntil(char terminator) {
+  host::LibraryScope scope;
+  String line;
+  int c;
+  while ((c = read()) >= 0) {
+    if (c == terminator) break;
+    line += (char)c;
+  }
+  return line;
+}
+
+WiFiServer::WiFiServer(uint16_t port) {
+  this->port = port;
+  fd = -1;
+}
+
+WiFiServer::~WiFiServer() {
+  end();
+}
+
+void WiFiServer::begin() {
+  end();
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0) return;
+
+  int one = 1;
+  setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(sock, 4) != 0) {
+    ::close(sock);
+    return;
+  }
+  fd = sock;
+}
+
+void WiFiServer::end() {
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+WiFiClient WiFiServer::available() {
+  if (fd < 0) return WiFiClient();
+
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  if (poll(&pfd, 1, 0) <= 0) return WiFiClient();
+
+  int accepted = accept(fd, nullptr, nullptr);
+  if (accepted < 0) return WiFiClient();
+  int one = 1;
+  setsockopt(accepted, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return WiFiClient(accepted);
+}
@@ -0,0 +1,83 @@
+// The sketch is compiled here as one C++ translation unit, exactly as the
+// Arduino IDE would after prototype generation.
+#include "ESP32_Scanner_TFT.ino"
+#include "sketch_runner.h"
+
+namespace sketch {
+
+void setup() {
+  ::setup();
+}
+
+void loopOnce() {
+  ::loop();
+}
+
+const char* stateName() {
+  switch (currentState) {
+    case STATE_INIT: return "init";
+    case STATE_WIFI_CONNECTING: return "wifi_connecting";
+    case STATE_WIFI_CONNECTED: return "wifi_connected";
+    case STATE_LOADING_EVENTS: return "loading_events";
+    case STATE_EVENT_SELECTION: return "event_selection";
+    case STATE_EVENT_ACTIVE: return "event_active";
+    case STATE_SCANNING: return "scanning";
+    case STATE_ERROR: return "error";
+  }
+  return "?";
+}
+
+bool isSelectingEvent() {
+  return currentState == STATE_EVENT_SELECTION;
+}
+
+bool isScanning() {
+  return currentState == STATE_SCANNING;
+}
+
+bool isError() {
+  return currentState == STATE_ERROR;
+}
+
+bool selectEvent(int index) {
+  if (currentState != STATE_EVENT_SELECTION || index < 0 || index >= events.getEventCount()) {
+    return false;
+  }
+  while (display.getSelectedIndex() > index) {
+    display.navigateUp();
+  }
+  while (display.getSelectedIndex() < index) {
+    display.navigateDown();
+  }
+  handleEnterPress();
+  return currentState == STATE_SCANNING;
+}
+
+void requestStop() {
+  if (currentState == STATE_SCANNING) {
+    handleEnterPress();
+  }
+}
+
+void setBackendUrl(const char* url) {
+  BACKEND_URL = url;
+  backend.setBaseURL(url);
+}
+
+void performScan() {
+  ::performScan();
+}
+
+void resetPresence() {
+  presence.reset();
+}
+
+void uploadBatch(const SightingView& sightings) {
+  presence.reset();
+  presence.update(sightings, millis());
+  if (presence.getPendingCount() > 0) {
+    ::recordAttendanceBatch();
+  }
+}
+
+} // namespace sketch
@@ -0,0 +1,40 @@
+#ifndef HOST_SKETCH_RUNNER_H
+#define HOST_SKETCH_RUNNER_H
+
+// Drives the unmodified sketch (ESP32_Scanner_TFT.ino) from host tools:
+// setup()/loop() plus the few state-machine hooks a script needs.
+
+#include "sighting_buffer.h"
+
+namespace sketch {
+
+void setup();
+void loopOnce();
+
+const char* stateName();
+bool isSelectingEvent();
+bool isScanning();
+bool isError();
+
+// Moves the menu cursor to `index` and presses ENTER, as a user would
+bool selectEvent(int index);
+
+// Same as an ENTER press while scanning
+void requestStop();
+
+// Points the backend client at another base URL, e.g. a local stand-in
+void setBackendUrl(const char* url);
+
+// One pass of the scanning state: scan, update presence, upload changes.
+// performScan() skips the scan unless 5 s of firmware time have passed.
+void performScan();
+// Ends every presence session without uploading, so the next scan
+// reports each registered device as a new arrival
+void resetPresence();
+// Uploads the registered rows of a scan as arrivals: resets presence,
+// feeds it the scan and flushes the outbox as performScan() does
+void uploadBatch(const SightingView& sightings);
+
+} // namespace sketch
+
+#endif // HOST_SKETCH_RUNNER_H
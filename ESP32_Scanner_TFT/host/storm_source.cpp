@@ -0,0 +1,232 @@
+#include "storm_source.h"
+#include "host_runtime.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const uint8_t FLAGS = 0x06;  // LE General Discoverable, no BR/EDR
+
+const char* const BEACON_NAMES[] = { "JBL Flip 5", "Tile", "Mi Smart Band 7", "LE-Bose QC" };
+
+// Appends one AD structure; returns the new length
+uint8_t appendAd(uint8_t* payload, uint8_t length, uint8_t type, const uint8_t* data, size_t dataLength) {
+  payload[length++] = (uint8_t)(dataLength + 1);
+  payload[length++] = type;
+  memcpy(payload + length, data, dataLength);
+  return (uint8_t)(length + dataLength);
+}
+
+} // namespace
+
+StormSource::StormSource(const StormConfig& storm)
+  : config(storm), random(storm.seed) {
+  generated = 0;
+  delivered = 0;
+  overruns = 0;
+  radioOff = 0;
+  rotations = 0;
+  worstLagUs = 0;
+
+  unsigned long long now = host::clockMicros();
+  std::normal_distribution<double> deviceRssi(config.rssiMean, config.rssiSpread);
+  int total = config.phones + config.beacons;
+  emitters.resize(total);
+
+  for (int i = 0; i < total; i++) {
+    Emitter& emitter = emitters[i];
+    emitter.phone = i < config.phones;
+    emitter.index = emitter.phone ? i : i - config.phones;
+    emitter.intervalUs = (emitter.phone ? config.phoneIntervalMs : config.beaconIntervalMs) * 1000UL;
+    emitter.rssiMean = deviceRssi(random);
+    randomAddress(emitter.address);
+
+    // Random phase, so devices do not all fire at the start of the run
+    unsigned long long rotateUs = (unsigned long long)config.rotateSeconds * 1000000ULL;
+    emitter.rotateAtUs = rotateUs > 0 ? now + random() % rotateUs : 0;
+    if (emitter.phone) {
+      StormPayloadFormat format = config.format;
+      if (format == STORM_MIXED) {
+        format = (StormPayloadFormat)(emitter.index % STORM_MIXED);
+      }
+      buildPhone(emitter, format);
+    } else {
+      buildBeacon(emitter);
+    }
+
+    Pending first;
+    first.atUs = now + (emitter.intervalUs > 0 ? random() % emitter.intervalUs : 0);
+    first.emitter = i;
+    schedule.push(first);
+  }
+}
+
+void StormSource::phoneUuid(int index, char* out, size_t outSize) {
+  snprintf(out, outSize, "ATT-USER-%08X", (unsigned)(0x1000 + index));
+}
+
+bool StormSource::next(unsigned long long untilUs, host::RawAdvertisement& out) {
+  while (!schedule.empty() && schedule.top().atUs <= untilUs) {
+    Pending due = schedule.top();
+    schedule.pop();
+    generated++;
+    reschedule(due);
+
+    // In real time the pipeline can fall behind the air; the controller
+    // only buffers so much, anything older is gone
+    unsigned long long now = host::clockMicros();
+    unsigned long long lag = now > due.atUs ? now - due.atUs : 0;
+    if (config.maxLagMs > 0 && lag > config.maxLagMs * 1000ULL) {
+      overruns++;
+      continue;
+    }
+    if (lag > worstLagUs) {
+      worstLagUs = lag;
+    }
+
+    fill(emitters[due.emitter], due.atUs, out);
+    delivered++;
+    return true;
+  }
+  return false;
+}
+
+void StormSource::skipUntil(unsigned long long nowUs) {
+  while (!schedule.empty() && schedule.top().atUs < nowUs) {
+    Pending due = schedule.top();
+    schedule.pop();
+    generated++;
+    radioOff++;
+    reschedule(due);
+  }
+}
+
+void StormSource::reschedule(const Pending& due) {
+  Emitter& emitter = emitters[due.emitter];
+  unsigned long advDelayUs = config.advDelayMaxMs * 1000UL;
+
+  Pending following;
+  following.atUs = due.atUs + emitter.intervalUs + (advDelayUs > 0 ? random() % advDelayUs : 0);
+  following.emitter = due.emitter;
+  if (following.atUs == due.atUs) {
+    following.atUs++; // a zero interval would never let time move on
+  }
+  schedule.push(following);
+
+  if (emitter.rotateAtUs > 0 && due.atUs >= emitter.rotateAtUs) {
+    randomAddress(emitter.address);
+    emitter.rotateAtUs += (unsigned long long)config.rotateSeconds * 1000000ULL;
+    rotations++;
+  }
+}
+
+void StormSource::fill(Emitter& emitter, unsigned long long atUs, host::RawAdvertisement& out) {
+  std::normal_distribution<double> noise(emitter.rssiMean, config.rssiNoise);
+  double rssi = noise(random);
+  if (rssi < -100) {
+    rssi = -100;
+  } else if (rssi > -20) {
+    rssi = -20;
+  }
+
+  out.timestampUs = atUs;
+  memcpy(out.address, emitter.address, sizeof(out.address));
+  out.rssi = (int8_t)rssi;
+  out.payloadLength = emitter.payloadLength;
+  memcpy(out.payload, emitter.payload, emitter.payloadLength);
+}
+
+void StormSource::buildPhone(Emitter& emitter, StormPayloadFormat format) {
+  char uuid[24];
+  phoneUuid(emitter.index, uuid, sizeof(uuid));
+  size_t uuidLength = strlen(uuid);
+  uint8_t data[29];
+
+  uint8_t length = appendAd(emitter.payload, 0, 0x01, &FLAGS, 1);
+  switch (format) {
+    case STORM_NAME:
+      length = appendAd(emitter.payload, length, 0x09, (const uint8_t*)uuid, uuidLength);
+      break;
+    case STORM_SERVICE_DATA:
+      data[0] = 0xF0; // 0xFFF0, little endian
+      data[1] = 0xFF;
+      memcpy(data + 2, uuid, uuidLength);
+      length = appendAd(emitter.payload, length, 0x16, data, uuidLength + 2);
+      break;
+    default:
+      data[0] = 0xFF; // Company 0xFFFF (reserved for testing)
+      data[1] = 0xFF;
+      memcpy(data + 2, uuid, uuidLength);
+      length = appendAd(emitter.payload, length, 0xFF, data, uuidLength + 2);
+      break;
+  }
+  emitter.payloadLength = length;
+}
+
+void StormSource::buildBeacon(Emitter& emitter) {
+  uint8_t data[29];
+  uint8_t length = appendAd(emitter.payload, 0, 0x01, &FLAGS, 1);
+
+  switch (emitter.index % 5) {
+    case 0: { // Apple Nearby Info
+      const uint8_t apple[] = { 0x4C, 0x00, 0x10, 0x05, 0x01, 0x18, 0x00, 0x00, 0x00 };
+      memcpy(data, apple, sizeof(apple));
+      for (size_t i = 6; i < sizeof(apple); i++) {
+        data[i] = (uint8_t)random();
+      }
+      length = appendAd(emitter.payload, length, 0xFF, data, sizeof(apple));
+      break;
+    }
+    case 1: { // iBeacon: proximity UUID, major, minor, measured power
+      data[0] = 0x4C;
+      data[1] = 0x00;
+      data[2] = 0x02;
+      data[3] = 0x15;
+      for (int i = 4; i < 24; i++) {
+        data[i] = (uint8_t)random();
+      }
+      data[24] = 0xC5;
+      length = appendAd(emitter.payload, length, 0xFF, data, 25);
+      break;
+    }
+    case 2: { // Eddystone-UID
+      const uint8_t services[] = { 0xAA, 0xFE };
+      length = appendAd(emitter.payload, length, 0x03, services, sizeof(services));
+      data[0] = 0xAA;
+      data[1] = 0xFE;
+      data[2] = 0x00;
+      data[3] = 0xEE;
+      for (int i = 4; i < 20; i++) {
+        data[i] = (uint8_t)random();
+      }
+      data[20] = 0;
+      data[21] = 0;
+      length = appendAd(emitter.payload, length, 0x16, data, 22);
+      break;
+    }
+    case 3: { // Microsoft CDP
+      const uint8_t microsoft[] = { 0x06, 0x00, 0x01, 0x09, 0x20, 0x02 };
+      memcpy(data, microsoft, sizeof(microsoft));
+      for (int i = 6; i < 14; i++) {
+        data[i] = (uint8_t)random();
+      }
+      length = appendAd(emitter.payload, length, 0xFF, data, 14);
+      break;
+    }
+    default: { // Named accessory
+      const char* name = BEACON_NAMES[(emitter.index / 5) % (sizeof(BEACON_NAMES) / sizeof(BEACON_NAMES[0]))];
+      length = appendAd(emitter.payload, length, 0x09, (const uint8_t*)name, strlen(name));
+      break;
+    }
+  }
+  emitter.payloadLength = length;
+}
+
+void StormSource::randomAddress(uint8_t* address) {
+  for (int i = 0; i < 6; i++) {
+    address[i] = (uint8_t)random();
+  }
+  // Resolvable private when rotating, random static otherwise
+  address[0] = (uint8_t)((address[0] & 0x3F) | (config.rotateSeconds > 0 ? 0x40 : 0xC0));
+}
@@ -0,0 +1,93 @@
+#ifndef HOST_STORM_SOURCE_H
+#define HOST_STORM_SOURCE_H
+
+// Synthetic advertisement storm for the host BLE radio: a population of
+// phones advertising ATT-USER-XXXXXXXX next to unrelated beacons, each on
+// its own interval with the random advDelay the BLE spec adds, a per-device
+// RSSI distribution and optional MAC rotation.
+
+#include "host_ble.h"
+
+#include <queue>
+#include <random>
+#include <vector>
+
+enum StormPayloadFormat {
+  STORM_MANUFACTURER,  // Company 0xFFFF + UUID, as the mobile app sends it
+  STORM_NAME,          // Complete local name
+  STORM_SERVICE_DATA,  // Service data on 0xFFF0
+  STORM_MIXED          // Phones cycle through the three formats
+};
+
+struct StormConfig {
+  int phones = 500;
+  unsigned long phoneIntervalMs = 100;
+  int beacons = 300;
+  unsigned long beaconIntervalMs = 100;
+  unsigned long advDelayMaxMs = 10;     // Random delay added to every event
+  double rssiMean = -65.0;              // Mean of the per-device mean RSSI
+  double rssiSpread = 8.0;              // Spread of per-device means
+  double rssiNoise = 4.0;               // Per-packet noise around a device's mean
+  unsigned long rotateSeconds = 0;      // MAC rotation period, 0 = fixed address
+  StormPayloadFormat format = STORM_MANUFACTURER;
+  unsigned long maxLagMs = 100;         // Older reports are lost by the controller
+  uint32_t seed = 1;
+};
+
+class StormSource : public host::AdvertisementSource {
+public:
+  explicit StormSource(const StormConfig& config);
+
+  bool next(unsigned long long untilUs, host::RawAdvertisement& out) override;
+
+  // Discards everything due before `nowUs`; call when the radio turns on
+  void skipUntil(unsigned long long nowUs);
+
+  // UUID phone `index` advertises; the first N are the registered ones
+  static void phoneUuid(int index, char* out, size_t outSize);
+
+  unsigned long long getGenerated() const { return generated; }
+  unsigned long long getDelivered() const { return delivered; }
+  unsigned long long getOverruns() const { return overruns; }
+  unsigned long long getRadioOff() const { return radioOff; }
+  unsigned long long getRotations() const { return rotations; }
+  unsigned long long getWorstLagUs() const { return worstLagUs; }
+
+private:
+  struct Emitter {
+    bool phone;
+    int index;
+    unsigned long intervalUs;
+    unsigned long long rotateAtUs;
+    double rssiMean;
+    uint8_t address[6];
+    uint8_t payloadLength;
+    uint8_t payload[31];
+  };
+
+  struct Pending {
+    unsigned long long atUs;
+    int emitter;
+    bool operator>(const Pending& other) const { return atUs > other.atUs; }
+  };
+
+  StormConfig config;
+  std::mt19937 random;
+  std::vector<Emitter> emitters;
+  std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> schedule;
+
+  unsigned long long generated;
+  unsigned long long delivered;
+  unsigned long long overruns;
+  unsigned long long radioOff;
+  unsigned long long rotations;
+  unsigned long long worstLagUs;
+
+  void buildPhone(Emitter& emitter, StormPayloadFormat format);
+  void buildBeacon(Emitter& emitter);
+  void randomAddress(uint8_t* address);
+  void reschedule(const Pending& due);
+  void fill(Emitter& emitter, unsigned long long atUs, host::RawAdvertisement& out);
+};
+
+#endif // HOST_STORM_SOURCE_H
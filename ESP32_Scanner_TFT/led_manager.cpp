@@ -1,26 +1,49 @@
 #include "led_manager.h"
+#include "log.h"
 
 // Global instance defined in ESP32_Scanner_TFT.ino
 
+// Blinking comes from the LEDC timer, which cannot run slower than 1 Hz
+// at LED_PWM_RESOLUTION, so every period is at most 1000 ms
+
+// Yellow: device / network
+static const LedPattern PATTERN_OFF          = { 0, 0 };
+static const LedPattern PATTERN_SOLID        = { 0, 100 };
+static const LedPattern PATTERN_OFFLINE      = { 1000, 10 };  // Short flash each second
+static const LedPattern PATTERN_BACKLOG      = { 1000, 80 };  // Brief off-blink each second
+static const LedPattern PATTERN_BACKLOG_HIGH = { 250, 50 };   // Fast blink
+
+// Blue: radio activity
+static const LedPattern PATTERN_SCANNING     = { 1000, 50 };  // Same rate as the old 500ms toggle
+static const LedPattern PATTERN_UPLOADING    = { 200, 50 };
+
 LEDManager::LEDManager() {
   systemOn = false;
   scanning = false;
-  lastBlink = 0;
-  blinkState = false;
+  online = true;
+  uploading = false;
+  backlog = 0;
+  yellowPattern = PATTERN_OFF;
+  bluePattern = PATTERN_OFF;
 }
 
 bool LEDManager::begin() {
-  Serial.println("Initializing LEDs...");
+  LOG_INFO("Initializing LEDs...");
   
-  // Configure LED pins
-  pinMode(LED_YELLOW, OUTPUT);
-  pinMode(LED_BLUE, OUTPUT);
+  // One LEDC channel per LED; LED_ON is the active level
+  if (ledcSetup(LED_YELLOW_CHANNEL, 1, LED_PWM_RESOLUTION) == 0 ||
+      ledcSetup(LED_BLUE_CHANNEL, 1, LED_PWM_RESOLUTION) == 0) {
+    LOG_ERROR("Failed to configure LEDC");
+    return false;
+  }
+  ledcAttachPin(LED_YELLOW, LED_YELLOW_CHANNEL);
+  ledcAttachPin(LED_BLUE, LED_BLUE_CHANNEL);
   
   // Turn off LEDs initially
-  digitalWrite(LED_YELLOW, LED_OFF);
-  digitalWrite(LED_BLUE, LED_OFF);
+  ledcWrite(LED_YELLOW_CHANNEL, 0);
+  ledcWrite(LED_BLUE_CHANNEL, 0);
   
-  Serial.println("LEDs initialized successfully");
+  LOG_INFO("LEDs initialized successfully");
   return true;
 }
 
@@ -31,34 +54,83 @@ void LEDManager::update() {
 void LEDManager::setSystemState(bool on, bool scan) {
   systemOn = on;
   scanning = scan;
+  updateLEDs();
 }
 
 void LEDManager::setSystemOn(bool on) {
   systemOn = on;
+  updateLEDs();
 }
 
 void LEDManager::setScanning(bool scan) {
   scanning = scan;
+  updateLEDs();
+}
+
+void LEDManager::setOnline(bool isOnline) {
+  online = isOnline;
+  updateLEDs();
+}
+
+void LEDManager::setBacklog(int pending) {
+  backlog = pending;
+  updateLEDs();
+}
+
+void LEDManager::setUploading(bool active) {
+  uploading = active;
+  updateLEDs();
+}
+
+bool LEDManager::isBlinking() {
+  return yellowPattern.periodMs > 0 || bluePattern.periodMs > 0;
+}
+
+LedPattern LEDManager::selectYellow() {
+  if (!online) {
+    return PATTERN_OFFLINE;
+  }
+  if (backlog >= LED_BACKLOG_HIGH) {
+    return PATTERN_BACKLOG_HIGH;
+  }
+  if (backlog > 0) {
+    return PATTERN_BACKLOG;
+  }
+  return systemOn ? PATTERN_SOLID : PATTERN_OFF;
+}
+
+LedPattern LEDManager::selectBlue() {
+  if (uploading) {
+    return PATTERN_UPLOADING;
+  }
+  return scanning ? PATTERN_SCANNING : PATTERN_OFF;
 }
 
 void LEDManager::updateLEDs() {
-  unsigned long now = millis();
+  applyPattern(LED_YELLOW_CHANNEL, selectYellow(), yellowPattern);
+  applyPattern(LED_BLUE_CHANNEL, selectBlue(), bluePattern);
+}
+
+void LEDManager::applyPattern(uint8_t channel, LedPattern pattern, LedPattern& current) {
+  if (pattern.periodMs == current.periodMs && pattern.dutyPercent == current.dutyPercent) {
+    return;
+  }
+  current = pattern;
   
-  // Yellow LED: System on indicator (solid when on)
-  if (systemOn) {
-    digitalWrite(LED_YELLOW, LED_ON);
-  } else {
-    digitalWrite(LED_YELLOW, LED_OFF);
+  const uint32_t maxDuty = (1UL << LED_PWM_RESOLUTION) - 1;
+  if (pattern.periodMs == 0) {
+    // Steady level; frequency does not matter
+    ledcWrite(channel, pattern.dutyPercent > 0 ? maxDuty : 0);
+    return;
   }
   
-  // Blue LED: Scanning indicator (blinking when scanning)
-  if (scanning) {
-    if (now - lastBlink >= 500) { // Blink every 500ms
-      blinkState = !blinkState;
-      lastBlink = now;
-    }
-    digitalWrite(LED_BLUE, blinkState ? LED_ON : LED_OFF);
-  } else {
-    digitalWrite(LED_BLUE, LED_OFF);
+  // Re-running setup restarts the timer, so the new pattern begins with
+  // its on phase
+  if (ledcSetup(channel, 1000 / pattern.periodMs, LED_PWM_RESOLUTION) == 0) {
+    // The timer keeps its old rate; show a steady level instead
+    LOG_WARN("LEDC cannot blink with a %u ms period", (unsigned)pattern.periodMs);
+    ledcWrite(channel, pattern.dutyPercent >= 50 ? maxDuty : 0);
+    return;
   }
-}
\ No newline at end of file
+  ledcWrite(channel, maxDuty * pattern.dutyPercent / 100);
+}
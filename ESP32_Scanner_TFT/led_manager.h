@@ -3,13 +3,26 @@
 
 #include "hardware_config.h"
 
+// A blink pattern run by the LEDC peripheral: one PWM period per blink.
+// A zero period means steady, fully on when dutyPercent > 0.
+struct LedPattern {
+  uint16_t periodMs;
+  uint8_t dutyPercent;
+};
+
+// Both LEDs are driven by LEDC, so patterns keep running while the loop is
+// blocked in a scan or an upload. The loop only picks a pattern; each
+// setter re-selects immediately and LEDC is touched only on a change.
 class LEDManager {
 private:
   bool systemOn;
   bool scanning;
+  bool online;
+  bool uploading;
+  int backlog;
   
-  unsigned long lastBlink;
-  bool blinkState;
+  LedPattern yellowPattern;  // Currently programmed
+  LedPattern bluePattern;
   
 public:
   LEDManager();
@@ -20,12 +33,21 @@ public:
   void setSystemState(bool on, bool scanning);
   void setSystemOn(bool on);
   void setScanning(bool scanning);
+  void setOnline(bool online);
+  void setBacklog(int pending);
+  void setUploading(bool uploading);
+  
+  // True while either LED blinks (LEDC stops in light sleep)
+  bool isBlinking();
   
 private:
   void updateLEDs();
+  LedPattern selectYellow();
+  LedPattern selectBlue();
+  void applyPattern(uint8_t channel, LedPattern pattern, LedPattern& current);
 };
 
 // Global LED manager instance
 extern LEDManager leds;
 
-#endif // LED_MANAGER_H
\ No newline at end of file
+#endif // LED_MANAGER_H
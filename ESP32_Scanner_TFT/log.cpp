@@ -0,0 +1,142 @@
+#include "log.h"
+#include <stdarg.h>
+
+// Global instance defined in ESP32_Scanner_TFT.ino
+
+// Guards the ring indices; shared by every task that logs
+static portMUX_TYPE logLock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char LEVEL_TAGS[] = { '-', 'E', 'W', 'I', 'D', 'V' };
+
+Logger::Logger() {
+  readPos = 0;
+  writePos = 0;
+  level = LOG_DEFAULT_LEVEL;
+  drainTask = NULL;
+  dropped = 0;
+  reportedDropped = 0;
+}
+
+bool Logger::begin() {
+  BaseType_t created = xTaskCreatePinnedToCore(drainTaskEntry, "log_drain", LOG_TASK_STACK,
+                                               this, LOG_TASK_PRIORITY, &drainTask, LOG_TASK_CORE);
+  if (created != pdPASS) {
+    drainTask = NULL;
+    Serial.println("Log drain task unavailable, logging synchronously");
+    return false;
+  }
+  return true;
+}
+
+void Logger::setLevel(uint8_t newLevel) {
+  level = newLevel > LOG_COMPILE_LEVEL ? LOG_COMPILE_LEVEL : newLevel;
+}
+
+uint8_t Logger::getLevel() {
+  return level;
+}
+
+void Logger::write(uint8_t messageLevel, const char* format, ...) {
+  if (messageLevel > level || messageLevel == LOG_LEVEL_NONE) {
+    return;
+  }
+
+  // "<seconds>.<ms> <level> <message>\n", truncated to one line
+  char line[LOG_LINE_SIZE];
+  unsigned long now = millis();
+  int prefix = snprintf(line, sizeof(line), "%lu.%03lu %c ", now / 1000, now % 1000,
+                        LEVEL_TAGS[messageLevel <= LOG_LEVEL_VERBOSE ? messageLevel : 0]);
+
+  va_list args;
+  va_start(args, format);
+  int body = vsnprintf(line + prefix, sizeof(line) - prefix - 1, format, args);
+  va_end(args);
+
+  size_t length = prefix + (body > 0 ? body : 0);
+  if (length > sizeof(line) - 2) {
+    length = sizeof(line) - 2;
+    memcpy(line + length - 3, "...", 3);
+  }
+  line[length++] = '\n';
+
+  append(line, length);
+  if (drainTask) {
+    xTaskNotifyGive(drainTask);
+  } else {
+    drain();
+  }
+}
+
+void Logger::append(const char* text, size_t length) {
+  portENTER_CRITICAL(&logLock);
+  if (length > LOG_BUFFER_SIZE - (writePos - readPos)) {
+    dropped++;
+  } else {
+    for (size_t i = 0; i < length; i++) {
+      ring[(writePos + i) % LOG_BUFFER_SIZE] = text[i];
+    }
+    writePos += length;
+  }
+  portEXIT_CRITICAL(&logLock);
+}
+
+void Logger::drain() {
+  char chunk[64];
+  while (true) {
+    // Copy out under the lock, write to the UART outside it
+    size_t count = 0;
+    portENTER_CRITICAL(&logLock);
+    while (count < sizeof(chunk) && readPos + count != writePos) {
+      chunk[count] = ring[(readPos + count) % LOG_BUFFER_SIZE];
+      count++;
+    }
+    portEXIT_CRITICAL(&logLock);
+    if (count == 0) {
+      break;
+    }
+    Serial.write((const uint8_t*)chunk, count);
+    portENTER_CRITICAL(&logLock);
+    readPos += count;
+    portEXIT_CRITICAL(&logLock);
+  }
+
+  unsigned long droppedNow = dropped;
+  if (droppedNow != reportedDropped) {
+    Serial.printf("[LOG] %lu message(s) dropped\n", droppedNow - reportedDropped);
+    reportedDropped = droppedNow;
+  }
+}
+
+void Logger::drainTaskEntry(void* param) {
+  Logger* self = static_cast<Logger*>(param);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
+    self->drain();
+  }
+}
+
+void Logger::flush(unsigned long timeoutMs) {
+  if (!drainTask) {
+    drain();
+    return;
+  }
+  unsigned long start = millis();
+  while (millis() - start < timeoutMs) {
+    portENTER_CRITICAL(&logLock);
+    bool empty = (readPos == writePos);
+    portEXIT_CRITICAL(&logLock);
+    if (empty) {
+      break;
+    }
+    xTaskNotifyGive(drainTask);
+    delay(1);
+  }
+}
+
+unsigned long Logger::getDropped() {
+  return dropped;
+}
+
+uint32_t Logger::getQueuedBytes() {
+  return writePos - readPos;
+}
@@ -0,0 +1,87 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include "hardware_config.h"
+
+// Log levels; a message is kept when its level <= the active level
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARN    2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_DEBUG   4
+#define LOG_LEVEL_VERBOSE 5
+
+// Messages above this level are compiled out entirely
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// Deferred logging: callers format into a stack line and copy it into a
+// RAM ring; a low-priority task drains the ring to Serial. Logging never
+// waits on the UART, and lines that do not fit are counted and dropped.
+// Not for use from ISRs.
+class Logger {
+private:
+  char ring[LOG_BUFFER_SIZE];
+  uint32_t readPos;             // Free-running; index with % LOG_BUFFER_SIZE
+  uint32_t writePos;
+  uint8_t level;
+  TaskHandle_t drainTask;
+  volatile unsigned long dropped;
+  unsigned long reportedDropped;
+
+  static void drainTaskEntry(void* param);
+  void append(const char* text, size_t length);
+  void drain();
+
+public:
+  Logger();
+  bool begin();
+
+  // Runtime level, capped by LOG_COMPILE_LEVEL
+  void setLevel(uint8_t newLevel);
+  uint8_t getLevel();
+
+  void write(uint8_t messageLevel, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+  // Waits until everything queued so far has reached the UART
+  void flush(unsigned long timeoutMs = 1000);
+
+  unsigned long getDropped();
+  // Bytes waiting in the ring for the drain task
+  uint32_t getQueuedBytes();
+};
+
+extern Logger logger;
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logger.write(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logger.write(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logger.write(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logger.write(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_VERBOSE
+#define LOG_VERBOSE(...) logger.write(LOG_LEVEL_VERBOSE, __VA_ARGS__)
+#else
+#define LOG_VERBOSE(...) do {} while (0)
+#endif
+
+#endif // LOG_H
@@ -0,0 +1,195 @@
+#include "metrics_server.h"
+#include "scanner_metrics.h"
+#include "heap_monitor.h"
+#include "log.h"
+#include <stdarg.h>
+
+// Global instance defined in ESP32_Scanner_TFT.ino
+
+MetricsServer::MetricsServer() : server(METRICS_PORT) {
+  serverTask = NULL;
+  out = NULL;
+  chunkLength = 0;
+  scrapes = 0;
+}
+
+bool MetricsServer::begin() {
+  if (serverTask) {
+    return true;
+  }
+  server.begin();
+  BaseType_t created = xTaskCreatePinnedToCore(serverTaskEntry, "metrics", METRICS_TASK_STACK,
+                                               this, METRICS_TASK_PRIORITY, &serverTask, METRICS_TASK_CORE);
+  if (created != pdPASS) {
+    serverTask = NULL;
+    LOG_ERROR("Failed to start metrics server task");
+    return false;
+  }
+  LOG_INFO("Metrics at http://%s:%d/metrics", WiFi.localIP().toString().c_str(), METRICS_PORT);
+  return true;
+}
+
+bool MetricsServer::isRunning() {
+  return serverTask != NULL;
+}
+
+unsigned long MetricsServer::getScrapes() {
+  return scrapes;
+}
+
+void MetricsServer::serverTaskEntry(void* param) {
+  MetricsServer* self = static_cast<MetricsServer*>(param);
+  for (;;) {
+    WiFiClient client = self->server.available();
+    if (client) {
+      self->handleClient(client);
+      client.stop();
+    } else {
+      vTaskDelay(pdMS_TO_TICKS(METRICS_POLL_MS));
+    }
+  }
+}
+
+void MetricsServer::handleClient(WiFiClient& client) {
+  client.setTimeout(1000);
+  String requestLine = client.readStringUntil('\n');
+
+  // Skip the headers; nothing in them changes the response
+  while (client.connected()) {
+    String header = client.readStringUntil('\n');
+    if (header.length() <= 1) {
+      break;
+    }
+  }
+
+  if (!requestLine.startsWith("GET /metrics")) {
+    client.print("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    return;
+  }
+
+  // The body is streamed in chunks and ended by closing the connection, so
+  // the page never has to fit in RAM at once
+  scrapes++;
+  client.print("HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\n\r\n");
+  out = &client;
+  chunkLength = 0;
+  render();
+  flushChunk();
+  out = NULL;
+}
+
+void MetricsServer::flushChunk() {
+  if (out && chunkLength > 0) {
+    out->write((const uint8_t*)chunk, chunkLength);
+  }
+  chunkLength = 0;
+}
+
+void MetricsServer::appendf(const char* format, ...) {
+  char line[METRICS_LINE_SIZE];
+  va_list args;
+  va_start(args, format);
+  int written = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (written <= 0) {
+    return;
+  }
+  size_t length = (size_t)written < sizeof(line) ? (size_t)written : sizeof(line) - 1;
+  if (chunkLength + length > sizeof(chunk)) {
+    flushChunk();
+  }
+  memcpy(chunk + chunkLength, line, length);
+  chunkLength += length;
+}
+
+void MetricsServer::appendCounter(const char* name, const char* help, uint32_t value) {
+  appendf("# HELP %s %s\n", name, help);
+  appendf("# TYPE %s counter\n", name);
+  appendf("%s %lu\n", name, (unsigned long)value);
+}
+
+void MetricsServer::appendGauge(const char* name, const char* help, int32_t value) {
+  appendf("# HELP %s %s\n", name, help);
+  appendf("# TYPE %s gauge\n", name);
+  appendf("%s %ld\n", name, (long)value);
+}
+
+void MetricsServer::appendHistogram(const char* name, const char* help, const LatencyHistogram& histogram) {
+  appendf("# HELP %s %s\n", name, help);
+  appendf("# TYPE %s histogram\n", name);
+  uint32_t cumulative = 0;
+  for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+    cumulative += histogram.buckets[i];
+    appendf("%s_bucket{le=\"%lu\"} %lu\n", name, (unsigned long)histogram.bound(i), (unsigned long)cumulative);
+  }
+  cumulative += histogram.buckets[LATENCY_BUCKET_COUNT];
+  appendf("%s_bucket{le=\"+Inf\"} %lu\n", name, (unsigned long)cumulative);
+  appendf("%s_sum %llu\n", name, (unsigned long long)histogram.sum);
+  appendf("%s_count %lu\n", name, (unsigned long)cumulative);
+}
+
+void MetricsServer::render() {
+  // Counters are written by other tasks; each 32-bit read is atomic, the
+  // page as a whole is not a consistent snapshot
+  const ScannerMetrics& m = scannerMetrics;
+  uint32_t seen = m.advertisementsSeen;
+  uint32_t matched = m.advertisementsMatched;
+
+  appendGauge("scanner_uptime_seconds", "Seconds since boot", (int32_t)(millis() / 1000));
+  appendCounter("scanner_advertisements_seen_total", "BLE advertisements reported by the scan", seen);
+  appendCounter("scanner_advertisements_filtered_total", "Advertisements rejected by the attendance filter",
+                seen >= matched ? seen - matched : 0);
+  appendCounter("scanner_advertisements_matched_total", "Advertisements that passed the attendance filter", matched);
+  appendf("# HELP scanner_advertisements_rejected_early_total Advertisements rejected on the raw payload, by stage\n");
+  appendf("# TYPE scanner_advertisements_rejected_early_total counter\n");
+  appendf("scanner_advertisements_rejected_early_total{stage=\"no_carrier\"} %lu\n",
+          (unsigned long)m.rejectedNoCarrier);
+  appendf("scanner_advertisements_rejected_early_total{stage=\"too_short\"} %lu\n",
+          (unsigned long)m.rejectedTooShort);
+  appendf("scanner_advertisements_rejected_early_total{stage=\"no_prefix\"} %lu\n",
+          (unsigned long)m.rejectedNoPrefix);
+  appendCounter("scanner_address_cache_hits_total", "Advertisements answered from the per-address verdict cache",
+                m.addressCacheHits);
+  appendCounter("scanner_address_cache_misses_total", "Advertisements parsed and filtered in full",
+                m.addressCacheMisses);
+  appendGauge("scanner_students_present", "Registered devices currently present", m.studentsPresent);
+  appendf("# HELP scanner_presence_changes_total Presence changes queued for upload, by kind\n");
+  appendf("# TYPE scanner_presence_changes_total counter\n");
+  appendf("scanner_presence_changes_total{change=\"arrival\"} %lu\n", (unsigned long)m.arrivals);
+  appendf("scanner_presence_changes_total{change=\"departure\"} %lu\n", (unsigned long)m.departures);
+  appendCounter("scanner_presence_untracked_total", "Sightings of registered devices past PRESENCE_MAX_DEVICES",
+                m.presenceUntracked);
+  appendCounter("scanner_presence_discarded_total", "Presence changes dropped before they could be uploaded",
+                m.presenceDiscarded);
+
+  appendCounter("scanner_records_uploaded_total", "Attendance records acknowledged by the backend", m.recordsUploaded);
+  appendCounter("scanner_records_failed_total", "Attendance records the backend reported as failed", m.recordsRejected);
+  appendCounter("scanner_upload_batches_total", "Batch uploads that got a response", m.uploadsSucceeded);
+  appendCounter("scanner_upload_batch_failures_total", "Batch uploads that failed", m.uploadsFailed);
+  appendGauge("scanner_outbox_depth", "Presence changes not yet acknowledged", m.uploadPending);
+
+  appendCounter("scanner_http_requests_total", "Backend requests started", m.httpRequests);
+  appendCounter("scanner_http_errors_total", "Backend requests without an HTTP status", m.httpErrors);
+  appendCounter("scanner_tls_handshakes_total", "TLS sessions opened to the backend", m.tlsHandshakes);
+  appendCounter("scanner_tls_failures_total", "TLS sessions that failed to connect", m.tlsFailures);
+
+  appendHistogram("scanner_http_request_duration_ms", "Backend request time until the body is read",
+                  m.requestLatency);
+  appendHistogram("scanner_detection_ack_ms", "Detection to backend acknowledgement per record", m.ackLatency);
+  appendHistogram("scanner_detection_queue_ms", "Detection until the record's batch is sent", m.queueLatency);
+  appendHistogram("scanner_batch_serialize_us", "Batch body build time", m.serializeLatency);
+  appendHistogram("scanner_batch_network_ms", "Batch round trip minus server time", m.networkLatency);
+  appendHistogram("scanner_batch_server_ms", "Batch handling time reported by the backend", m.serverLatency);
+
+  appendGauge("scanner_heap_free_bytes", "Free internal heap", m.heapFree);
+  appendGauge("scanner_heap_largest_block_bytes", "Largest allocatable internal block", m.heapLargestBlock);
+  appendGauge("scanner_heap_min_free_bytes", "Lowest free heap since boot", m.heapMinFree);
+  appendGauge("scanner_psram_free_bytes", "Free PSRAM, 0 without PSRAM", m.psramFree);
+  appendf("# HELP scanner_heap_retained_bytes Net heap growth attributed to a subsystem\n");
+  appendf("# TYPE scanner_heap_retained_bytes gauge\n");
+  for (int i = 0; i < HEAP_SUBSYSTEM_COUNT; i++) {
+    HeapSubsystem subsystem = (HeapSubsystem)i;
+    appendf("scanner_heap_retained_bytes{subsystem=\"%s\"} %ld\n", HeapMonitor::getName(subsystem),
+            (long)heapMonitor.getStats(subsystem).retainedBytes);
+  }
+}
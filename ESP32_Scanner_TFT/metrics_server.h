@@ -0,0 +1,42 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <WiFi.h>
+#include "hardware_config.h"
+#include "scanner_metrics.h"
+
+// Serves GET /metrics in the Prometheus text exposition format so a venue
+// Prometheus can scrape the scanners. Runs in its own low-priority task on
+// the loop core; it only reads counters and never touches BLE or the
+// display.
+class MetricsServer {
+private:
+  WiFiServer server;
+  TaskHandle_t serverTask;
+  WiFiClient* out;               // Client being answered, set during render
+  char chunk[METRICS_CHUNK_SIZE];
+  size_t chunkLength;
+  unsigned long scrapes;
+
+  static void serverTaskEntry(void* param);
+  void handleClient(WiFiClient& client);
+  void render();
+  void flushChunk();
+  void appendf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  void appendCounter(const char* name, const char* help, uint32_t value);
+  void appendGauge(const char* name, const char* help, int32_t value);
+  void appendHistogram(const char* name, const char* help, const LatencyHistogram& histogram);
+
+public:
+  MetricsServer();
+
+  // Safe to call again after a reconnect; only the first call starts the task
+  bool begin();
+  bool isRunning();
+  unsigned long getScrapes();
+};
+
+// Global metrics server instance
+extern MetricsServer metricsServer;
+
+#endif // METRICS_SERVER_H
@@ -0,0 +1,134 @@
+#include "power_manager.h"
+#include "button_manager.h"
+#include "display_manager.h"
+#include "led_manager.h"
+#include "log.h"
+#include <esp_sleep.h>
+
+// Global instance defined in ESP32_Scanner_TFT.ino
+
+PowerManager::PowerManager() {
+  idleMode = false;
+  idleSinceMs = 0;
+  sleepUnavailable = false;
+  wakePending = false;
+  wakeMicros = 0;
+  lastWakeLatencyUs = 0;
+  maxWakeLatencyUs = 0;
+  totalWakeLatencyUs = 0;
+  buttonWakes = 0;
+  timerWakes = 0;
+  sleptMs = 0;
+}
+
+bool PowerManager::begin() {
+  LOG_INFO("Initializing power management...");
+  setCpuFrequencyMhz(ACTIVE_CPU_FREQ_MHZ);
+  LOG_INFO("CPU at %lu MHz, idle %d MHz", (unsigned long)getCpuFrequencyMhz(), IDLE_CPU_FREQ_MHZ);
+  return true;
+}
+
+void PowerManager::setIdleMode(bool idle) {
+  if (idle == idleMode) {
+    return;
+  }
+  idleMode = idle;
+  idleSinceMs = millis();
+  setCpuFrequencyMhz(idle ? IDLE_CPU_FREQ_MHZ : ACTIVE_CPU_FREQ_MHZ);
+  LOG_DEBUG("[PWR] %s, CPU %lu MHz", idle ? "Idle" : "Active", (unsigned long)getCpuFrequencyMhz());
+}
+
+bool PowerManager::isIdleMode() {
+  return idleMode;
+}
+
+bool PowerManager::canSleep() {
+  // LEDC stops in light sleep, so a blinking LED keeps us awake
+  if (!idleMode || sleepUnavailable || buttons.isBusy() || display.isFlushing() || leds.isBlinking()) {
+    return false;
+  }
+  unsigned long now = millis();
+  unsigned long quietSince = buttons.getLastActivityMs();
+  if (now - idleSinceMs < now - quietSince) {
+    quietSince = idleSinceMs;
+  }
+  return now - quietSince >= IDLE_SLEEP_AFTER_MS;
+}
+
+void PowerManager::wait(unsigned long timeoutMs) {
+  if (canSleep()) {
+    lightSleep(IDLE_SLEEP_PERIOD_MS);
+  } else {
+    buttons.waitForInput(timeoutMs);
+  }
+}
+
+void PowerManager::lightSleep(unsigned long periodMs) {
+  // Queued log lines and UART output still in the FIFO would be lost
+  logger.flush();
+  Serial.flush();
+
+  buttons.enableWakeup();
+  esp_sleep_enable_gpio_wakeup();
+  esp_sleep_enable_timer_wakeup((uint64_t)periodMs * 1000ULL);
+
+  unsigned long sleepStart = millis();
+  esp_err_t result = esp_light_sleep_start();
+  unsigned long now = micros();
+
+  buttons.disableWakeup();
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+  if (result != ESP_OK) {
+    // e.g. a radio driver refused; keep the low clock, stop trying to sleep
+    LOG_WARN("[PWR] Light sleep unavailable (err %d)", (int)result);
+    sleepUnavailable = true;
+    return;
+  }
+  sleptMs += millis() - sleepStart;
+
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+    buttonWakes++;
+    wakePending = true;
+    wakeMicros = now;
+  } else {
+    timerWakes++;
+  }
+}
+
+void PowerManager::markResponsive() {
+  if (!wakePending) {
+    return;
+  }
+  wakePending = false;
+  lastWakeLatencyUs = micros() - wakeMicros;
+  totalWakeLatencyUs += lastWakeLatencyUs;
+  if (lastWakeLatencyUs > maxWakeLatencyUs) {
+    maxWakeLatencyUs = lastWakeLatencyUs;
+  }
+  LOG_INFO("[PWR] Button wake, responsive in %lu us (max %lu us, %lu wakes, %lu ms asleep)",
+           lastWakeLatencyUs, maxWakeLatencyUs, buttonWakes, sleptMs);
+}
+
+unsigned long PowerManager::getLastWakeLatencyUs() {
+  return lastWakeLatencyUs;
+}
+
+unsigned long PowerManager::getMaxWakeLatencyUs() {
+  return maxWakeLatencyUs;
+}
+
+unsigned long PowerManager::getAverageWakeLatencyUs() {
+  return buttonWakes > 0 ? totalWakeLatencyUs / buttonWakes : 0;
+}
+
+unsigned long PowerManager::getButtonWakes() {
+  return buttonWakes;
+}
+
+unsigned long PowerManager::getTimerWakes() {
+  return timerWakes;
+}
+
+unsigned long PowerManager::getSleptMs() {
+  return sleptMs;
+}
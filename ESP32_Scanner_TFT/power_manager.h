@@ -0,0 +1,56 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include "hardware_config.h"
+
+// Idle power handling for screens that only wait for a button (event menu,
+// error). The CPU clock drops while idle; after IDLE_SLEEP_AFTER_MS without
+// input the loop light-sleeps until a button press or the periodic timer.
+class PowerManager {
+private:
+  bool idleMode;
+  unsigned long idleSinceMs;
+  bool sleepUnavailable;
+
+  // Wake-to-responsive measurement for button wakes
+  bool wakePending;
+  unsigned long wakeMicros;
+  unsigned long lastWakeLatencyUs;
+  unsigned long maxWakeLatencyUs;
+  unsigned long totalWakeLatencyUs;
+
+  unsigned long buttonWakes;
+  unsigned long timerWakes;
+  unsigned long sleptMs;
+
+  bool canSleep();
+  void lightSleep(unsigned long periodMs);
+
+public:
+  PowerManager();
+  bool begin();
+
+  // Called every loop pass with whether the current state is idle
+  void setIdleMode(bool idle);
+  bool isIdleMode();
+
+  // Replaces the loop's fixed delay: light sleep when allowed, otherwise
+  // wait for a button edge
+  void wait(unsigned long timeoutMs);
+
+  // Called once the loop has handled input and started the next frame
+  void markResponsive();
+
+  // Statistics
+  unsigned long getLastWakeLatencyUs();
+  unsigned long getMaxWakeLatencyUs();
+  unsigned long getAverageWakeLatencyUs();
+  unsigned long getButtonWakes();
+  unsigned long getTimerWakes();
+  unsigned long getSleptMs();
+};
+
+// Global power manager instance
+extern PowerManager power;
+
+#endif // POWER_MANAGER_H
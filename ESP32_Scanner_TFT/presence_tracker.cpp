@@ -0,0 +1,139 @@
+#include "presence_tracker.h"
+#include "scanner_metrics.h"
+
+static const int RSSI_SCALE = 16;
+
+PresenceTracker::PresenceTracker() {
+  dropped = 0;
+  pendingCount = 0;
+  reset();
+}
+
+int PresenceTracker::reset() {
+  int discarded = pendingCount;
+  memset(state, UNSEEN, sizeof(state));
+  presentCount = 0;
+  pendingCount = 0;
+  return discarded;
+}
+
+bool PresenceTracker::queue(int ordinal, PresenceChange change, uint32_t timeMs, uint32_t nowMs) {
+  if (pendingCount >= PRESENCE_OUTBOX_SIZE) {
+    dropped++;
+    return false;
+  }
+  PresenceEvent& event = outbox[pendingCount++];
+  event.timeMs = timeMs;
+  event.detectedMs = nowMs;
+  event.dwellMs = change == PRESENCE_ARRIVAL ? 0 : timeMs - arrivedMs[ordinal];
+  event.ordinal = (int16_t)ordinal;
+  event.rssi = (int8_t)(smoothed[ordinal] / RSSI_SCALE);
+  event.change = (uint8_t)change;
+  return true;
+}
+
+int PresenceTracker::depart(int ordinal, uint32_t timeMs, uint32_t nowMs, uint8_t nextState) {
+  int queued = 0;
+  if (state[ordinal] == PRESENT) {
+    presentCount--;
+    scannerMetrics.departures++;
+    queued = queue(ordinal, PRESENCE_DEPARTURE, timeMs, nowMs) ? 1 : 0;
+  }
+  state[ordinal] = nextState;
+  return queued;
+}
+
+int PresenceTracker::update(const SightingView& sightings, uint32_t nowMs) {
+  int queued = 0;
+
+  for (int i = 0; i < sightings.size(); i++) {
+    int ordinal = sightings.ordinal[i];
+    if (ordinal < 0) {
+      continue;
+    }
+    if (ordinal >= PRESENCE_MAX_DEVICES) {
+      scannerMetrics.presenceUntracked++;
+      continue;
+    }
+    int sample = sightings.rssi[i] * RSSI_SCALE;
+    uint32_t seenAt = sightings.timestamp[i];
+
+    // The first sighting seeds the average; later ones move it a fraction
+    // of the way, so one strong or weak packet does not flip the state
+    if (state[ordinal] == UNSEEN) {
+      smoothed[ordinal] = (int16_t)sample;
+      state[ordinal] = NEAR;
+    } else {
+      smoothed[ordinal] += (int16_t)((sample - smoothed[ordinal]) / (1 << PRESENCE_EMA_SHIFT));
+    }
+    lastSeenMs[ordinal] = seenAt;
+
+    if (state[ordinal] == NEAR && smoothed[ordinal] >= PRESENCE_ENTER_DBM * RSSI_SCALE) {
+      state[ordinal] = PRESENT;
+      presentCount++;
+      arrivedMs[ordinal] = seenAt;
+      lastReportMs[ordinal] = seenAt;
+      scannerMetrics.arrivals++;
+      queued += queue(ordinal, PRESENCE_ARRIVAL, seenAt, nowMs) ? 1 : 0;
+    } else if (state[ordinal] == PRESENT && smoothed[ordinal] < PRESENCE_EXIT_DBM * RSSI_SCALE) {
+      // Still in range, so the average is kept; a single strong packet at
+      // the door cannot bring the device straight back
+      queued += depart(ordinal, seenAt, nowMs, NEAR);
+    }
+  }
+
+  // Devices that went quiet leave at the time they were last seen
+  for (int ordinal = 0; ordinal < PRESENCE_MAX_DEVICES; ordinal++) {
+    if (state[ordinal] == UNSEEN) {
+      continue;
+    }
+    if (nowMs - lastSeenMs[ordinal] >= PRESENCE_DEPART_MS) {
+      queued += depart(ordinal, lastSeenMs[ordinal], nowMs, UNSEEN);
+    }
+#if PRESENCE_DWELL_REPORT_MS > 0
+    else if (state[ordinal] == PRESENT && nowMs - lastReportMs[ordinal] >= PRESENCE_DWELL_REPORT_MS) {
+      lastReportMs[ordinal] = nowMs;
+      queued += queue(ordinal, PRESENCE_DWELL, lastSeenMs[ordinal], nowMs) ? 1 : 0;
+    }
+#endif
+  }
+  return queued;
+}
+
+int PresenceTracker::departAll(uint32_t nowMs) {
+  int queued = 0;
+  for (int ordinal = 0; ordinal < PRESENCE_MAX_DEVICES; ordinal++) {
+    if (state[ordinal] != UNSEEN) {
+      queued += depart(ordinal, lastSeenMs[ordinal], nowMs, UNSEEN);
+    }
+  }
+  return queued;
+}
+
+int PresenceTracker::getPresentCount() const {
+  return presentCount;
+}
+
+const PresenceEvent* PresenceTracker::getPending() const {
+  return outbox;
+}
+
+int PresenceTracker::getPendingCount() const {
+  return pendingCount;
+}
+
+void PresenceTracker::acknowledge(int count) {
+  if (count <= 0) {
+    return;
+  }
+  if (count >= pendingCount) {
+    pendingCount = 0;
+    return;
+  }
+  memmove(outbox, outbox + count, (pendingCount - count) * sizeof(PresenceEvent));
+  pendingCount -= count;
+}
+
+unsigned long PresenceTracker::getDroppedCount() const {
+  return dropped;
+}
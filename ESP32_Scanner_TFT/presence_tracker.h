@@ -0,0 +1,67 @@
+#ifndef PRESENCE_TRACKER_H
+#define PRESENCE_TRACKER_H
+
+#include <Arduino.h>
+#include "hardware_config.h"
+#include "common_types.h"
+#include "sighting_buffer.h"
+
+// Turns per-scan sightings into presence sessions. Each registered device
+// gets an exponential moving average of its RSSI; it arrives when the
+// average reaches PRESENCE_ENTER_DBM and leaves when it drops below
+// PRESENCE_EXIT_DBM or the device goes unseen for PRESENCE_DEPART_MS.
+// Only those changes are queued for upload, so a phone that stays in the
+// room costs one arrival and one departure instead of a record per scan.
+// Main loop only; indexed by registered ordinal.
+class PresenceTracker {
+public:
+  PresenceTracker();
+
+  // Forgets every session and pending change; call when the registration
+  // table is reloaded. Returns the number of pending changes discarded.
+  int reset();
+
+  // Feeds one scan; returns the number of changes queued
+  int update(const SightingView& sightings, uint32_t nowMs);
+
+  // Ends every open session, as when scanning stops
+  int departAll(uint32_t nowMs);
+
+  int getPresentCount() const;
+
+  // Changes waiting for upload, oldest first
+  const PresenceEvent* getPending() const;
+  int getPendingCount() const;
+  // Drops the first `count` pending changes once the backend has them
+  void acknowledge(int count);
+  // Changes lost because the outbox was full
+  unsigned long getDroppedCount() const;
+
+private:
+  enum State : uint8_t {
+    UNSEEN,   // No sighting in this session, or timed out
+    NEAR,     // Seen, average below the arrival threshold
+    PRESENT
+  };
+
+  int16_t smoothed[PRESENCE_MAX_DEVICES];   // dBm * 16
+  uint32_t arrivedMs[PRESENCE_MAX_DEVICES];
+  uint32_t lastSeenMs[PRESENCE_MAX_DEVICES];
+  uint32_t lastReportMs[PRESENCE_MAX_DEVICES];
+  uint8_t state[PRESENCE_MAX_DEVICES];
+  int presentCount;
+
+  PresenceEvent outbox[PRESENCE_OUTBOX_SIZE];
+  int pendingCount;
+  unsigned long dropped;
+
+  bool queue(int ordinal, PresenceChange change, uint32_t timeMs, uint32_t nowMs);
+  // Ends a session; `nextState` is NEAR after a weak signal, which keeps
+  // the average, or UNSEEN after a timeout
+  int depart(int ordinal, uint32_t timeMs, uint32_t nowMs, uint8_t nextState);
+};
+
+// Global presence tracker instance
+extern PresenceTracker presence;
+
+#endif // PRESENCE_TRACKER_H
@@ -0,0 +1,85 @@
+#ifndef SCANNER_METRICS_H
+#define SCANNER_METRICS_H
+
+#include <Arduino.h>
+#include "hardware_config.h"
+
+// Histogram with doubling bucket bounds: bucket i counts samples <=
+// firstBound << i, the last bucket is +Inf. The unit is the caller's (ms
+// unless noted). Buckets are not cumulative; exporters sum them.
+struct LatencyHistogram {
+  uint32_t firstBound;
+  uint32_t buckets[LATENCY_BUCKET_COUNT + 1];
+  uint32_t count;
+  uint64_t sum;
+
+  explicit LatencyHistogram(uint32_t first = LATENCY_FIRST_BUCKET_MS)
+    : firstBound(first), buckets(), count(0), sum(0) {}
+
+  uint32_t bound(int bucket) const { return firstBound << bucket; }
+
+  void record(uint32_t value) {
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKET_COUNT && value > bound(bucket)) {
+      bucket++;
+    }
+    buckets[bucket]++;
+    count++;
+    sum += value;
+  }
+};
+
+// Running counters shared by the scanner, the upload path and the
+// dashboard. Counters only ever increase; rates are derived by readers.
+struct ScannerMetrics {
+  // BLE (written from the BLE callback)
+  volatile uint32_t advertisementsSeen = 0;     // Every advertisement reported
+  volatile uint32_t advertisementsMatched = 0;  // Passed the attendance filter
+  volatile uint32_t rejectedNoCarrier = 0;      // Early rejects, see PayloadScreen
+  volatile uint32_t rejectedTooShort = 0;
+  volatile uint32_t rejectedNoPrefix = 0;
+  volatile uint32_t addressCacheHits = 0;       // Verdict reused, payload not parsed
+  volatile uint32_t addressCacheMisses = 0;
+
+  // Last scan
+  int studentsPresent = 0;  // Registered devices currently present
+
+  // Presence changes, see PresenceTracker
+  uint32_t arrivals = 0;
+  uint32_t departures = 0;
+  uint32_t presenceUntracked = 0;  // Sightings past PRESENCE_MAX_DEVICES, ignored
+  uint32_t presenceDiscarded = 0;  // Pending changes dropped un-uploaded
+
+  // Uploads
+  int uploadPending = 0;    // Presence changes not yet acknowledged
+  uint32_t lastUploadMs = 0;
+  uint32_t uploadsSucceeded = 0;
+  uint32_t uploadsFailed = 0;
+  uint32_t recordsUploaded = 0;   // Acknowledged by the backend as recorded
+  uint32_t recordsRejected = 0;   // Acknowledged but reported failed
+
+  // HTTP, written by BackendClient::makeRequest
+  uint32_t httpRequests = 0;
+  uint32_t httpErrors = 0;        // No HTTP status: connect/TLS/timeout
+  uint32_t tlsHandshakes = 0;     // Every HTTPS request opens a new session
+  uint32_t tlsFailures = 0;
+  LatencyHistogram requestLatency;
+
+  // Detection to backend acknowledgement, per record, and its stages
+  LatencyHistogram ackLatency;         // Detection -> response parsed
+  LatencyHistogram queueLatency;       // Detection -> batch send starts
+  LatencyHistogram serializeLatency{SERIALIZE_FIRST_BUCKET_US};  // Per batch, microseconds
+  LatencyHistogram networkLatency;     // Per batch, round trip minus server time
+  LatencyHistogram serverLatency;      // Per batch, as reported by the backend
+
+  // Heap, refreshed by HeapMonitor::sample()
+  uint32_t heapFree = 0;
+  uint32_t heapLargestBlock = 0;
+  uint32_t heapMinFree = 0;   // Low-water mark since boot
+  uint32_t psramFree = 0;
+};
+
+// Global metrics instance
+extern ScannerMetrics scannerMetrics;
+
+#endif // SCANNER_METRICS_H
@@ -0,0 +1,65 @@
+#include "sighting_buffer.h"
+
+SightingBuffer::SightingBuffer() {
+  dropped = 0;
+  clear();
+}
+
+void SightingBuffer::clear() {
+  count = 0;
+  memset(index, 0xFF, sizeof(index)); // all slots = -1
+}
+
+int SightingBuffer::find(uint32_t hash, int16_t deviceOrdinal) const {
+  uint32_t slot = hash & (SIGHTING_INDEX_SIZE - 1);
+  while (index[slot] >= 0) {
+    int row = index[slot];
+    if (uuidHash[row] == hash && ordinal[row] == deviceOrdinal) {
+      return row;
+    }
+    slot = (slot + 1) & (SIGHTING_INDEX_SIZE - 1);
+  }
+  return -1;
+}
+
+int SightingBuffer::add(uint32_t hash, int16_t deviceOrdinal, int8_t deviceRssi, uint32_t detectedAt, const uint8_t* deviceAddress) {
+  int row = count;
+  if (row >= MAX_SIGHTINGS) {
+    dropped++;
+    return -1;
+  }
+
+  uuidHash[row] = hash;
+  ordinal[row] = deviceOrdinal;
+  rssi[row] = deviceRssi;
+  timestamp[row] = detectedAt;
+  memcpy(address[row], deviceAddress, 6);
+
+  uint32_t slot = hash & (SIGHTING_INDEX_SIZE - 1);
+  while (index[slot] >= 0) {
+    slot = (slot + 1) & (SIGHTING_INDEX_SIZE - 1);
+  }
+  index[slot] = (int16_t)row;
+
+  count = row + 1;
+  return row;
+}
+
+SightingView SightingBuffer::view() const {
+  SightingView v;
+  v.uuidHash = uuidHash;
+  v.ordinal = ordinal;
+  v.rssi = rssi;
+  v.timestamp = timestamp;
+  v.address = address;
+  v.count = count;
+  return v;
+}
+
+int SightingBuffer::size() const {
+  return count;
+}
+
+unsigned long SightingBuffer::getDroppedCount() const {
+  return dropped;
+}
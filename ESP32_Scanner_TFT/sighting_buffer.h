@@ -0,0 +1,56 @@
+#ifndef SIGHTING_BUFFER_H
+#define SIGHTING_BUFFER_H
+
+#include <Arduino.h>
+#include "hardware_config.h"
+
+// Read-only view over one scan's sightings. Columns are parallel arrays
+// indexed 0..count-1 and stay valid until the next scan starts.
+struct SightingView {
+  const uint32_t* uuidHash;
+  const int16_t* ordinal;     // Registered device index, -1 if not registered
+  const int8_t* rssi;
+  const uint32_t* timestamp;  // millis() at detection
+  const uint8_t (*address)[6];
+  int count;
+
+  int size() const { return count; }
+  bool isRegistered(int i) const { return ordinal[i] >= 0; }
+};
+
+// Preallocated struct-of-arrays store for scan results. Written from the
+// BLE callback, read by the main loop through view() after the scan stops;
+// nothing is allocated or copied per cycle.
+class SightingBuffer {
+private:
+  uint32_t uuidHash[MAX_SIGHTINGS];
+  int16_t ordinal[MAX_SIGHTINGS];
+  int8_t rssi[MAX_SIGHTINGS];
+  uint32_t timestamp[MAX_SIGHTINGS];
+  uint8_t address[MAX_SIGHTINGS][6];
+  volatile int count;
+
+  // Open-addressing index over uuidHash for per-scan deduplication
+  int16_t index[SIGHTING_INDEX_SIZE];
+
+  unsigned long dropped;
+
+public:
+  SightingBuffer();
+
+  void clear();
+
+  // Returns the row of an existing sighting of this device, or -1. The
+  // ordinal tells apart registered UUIDs whose hashes collide; unregistered
+  // devices (-1) are still matched on the hash alone.
+  int find(uint32_t hash, int16_t deviceOrdinal) const;
+
+  // Appends a sighting; returns its row, or -1 when the buffer is full
+  int add(uint32_t hash, int16_t deviceOrdinal, int8_t deviceRssi, uint32_t detectedAt, const uint8_t* deviceAddress);
+
+  SightingView view() const;
+  int size() const;
+  unsigned long getDroppedCount() const;
+};
+
+#endif // SIGHTING_BUFFER_H
@@ -0,0 +1,66 @@
+#include "string_arena.h"
+
+StringArena::StringArena(char* storage, size_t size) {
+  buffer = storage;
+  capacity = size;
+  used = 0;
+  highWater = 0;
+  overflowCount = 0;
+}
+
+void* StringArena::allocate(size_t size, size_t align) {
+  size_t start = (used + align - 1) & ~(align - 1);
+  if (start + size > capacity) {
+    overflowCount++;
+    return nullptr;
+  }
+
+  used = start + size;
+  if (used > highWater) {
+    highWater = used;
+  }
+  return buffer + start;
+}
+
+const char* StringArena::copy(const char* str) {
+  return copy(str, str ? strlen(str) : 0);
+}
+
+const char* StringArena::copy(const char* str, size_t len) {
+  if (!str || len == 0) {
+    return "";
+  }
+
+  char* dest = (char*)allocate(len + 1, 1);
+  if (!dest) {
+    return "";
+  }
+
+  memcpy(dest, str, len);
+  dest[len] = '\0';
+  return dest;
+}
+
+const char* StringArena::copy(const String& str) {
+  return copy(str.c_str(), str.length());
+}
+
+void StringArena::reset() {
+  used = 0;
+}
+
+size_t StringArena::getUsed() const {
+  return used;
+}
+
+size_t StringArena::getCapacity() const {
+  return capacity;
+}
+
+size_t StringArena::getHighWater() const {
+  return highWater;
+}
+
+unsigned long StringArena::getOverflowCount() const {
+  return overflowCount;
+}
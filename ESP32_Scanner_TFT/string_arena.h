@@ -0,0 +1,50 @@
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include <Arduino.h>
+
+// Bump allocator for transient strings (event lists, registered devices,
+// upload batches). Allocation is a pointer increment inside a fixed buffer
+// and the whole arena is released at once with reset(), so reloads and
+// flushes never fragment the heap.
+class StringArena {
+private:
+  char* buffer;
+  size_t capacity;
+  size_t used;
+  size_t highWater;
+  unsigned long overflowCount;
+
+public:
+  StringArena(char* storage, size_t size);
+
+  // Raw allocation; returns nullptr when the arena is full
+  void* allocate(size_t size, size_t align = sizeof(void*));
+
+  // Copy a string into the arena. Never returns nullptr: on overflow the
+  // result is an empty string and the overflow counter is bumped.
+  const char* copy(const char* str);
+  const char* copy(const char* str, size_t len);
+  const char* copy(const String& str);
+
+  // Release everything allocated since the last reset
+  void reset();
+
+  // Statistics
+  size_t getUsed() const;
+  size_t getCapacity() const;
+  size_t getHighWater() const;
+  unsigned long getOverflowCount() const;
+};
+
+// Arena with its own statically allocated storage
+template <size_t N>
+class StaticStringArena : public StringArena {
+private:
+  char storage[N];
+
+public:
+  StaticStringArena() : StringArena(storage, N) {}
+};
+
+#endif // STRING_ARENA_H
@@ -0,0 +1,75 @@
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+TraceBuffer traceBuffer;
+
+TraceBuffer::TraceBuffer() : head(0) {
+  paused = false;
+  for (int i = 0; i < TRACE_BUFFER_EVENTS; i++) {
+    events[i].seq = 0;
+  }
+}
+
+void TraceBuffer::record(const char* name, char phase) {
+  if (paused) {
+    return;
+  }
+  uint32_t index = head.fetch_add(1, std::memory_order_relaxed);
+  TraceEvent& event = events[index & (TRACE_BUFFER_EVENTS - 1)];
+  event.seq = 0;
+  event.name = name;
+  event.timeUs = micros();
+  event.task = (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle();
+  event.phase = phase;
+  std::atomic_thread_fence(std::memory_order_release);
+  event.seq = index + 1;
+}
+
+void TraceBuffer::clear() {
+  paused = true;
+  for (int i = 0; i < TRACE_BUFFER_EVENTS; i++) {
+    events[i].seq = 0;
+  }
+  head.store(0);
+  paused = false;
+}
+
+uint32_t TraceBuffer::getRecorded() {
+  return head.load(std::memory_order_relaxed);
+}
+
+void TraceBuffer::dumpChromeJson(Print& out) {
+  paused = true;
+
+  uint32_t end = head.load(std::memory_order_acquire);
+  uint32_t start = end > TRACE_BUFFER_EVENTS ? end - TRACE_BUFFER_EVENTS : 0;
+  char line[128];
+  bool first = true;
+
+  out.print("{\"traceEvents\":[\n");
+  for (uint32_t i = start; i < end; i++) {
+    const TraceEvent& event = events[i & (TRACE_BUFFER_EVENTS - 1)];
+    if (event.seq != i + 1) {
+      continue; // Torn or overwritten slot
+    }
+    snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,\"tid\":%lu}",
+             first ? "" : ",\n", event.name, event.phase,
+             (unsigned long)event.timeUs, (unsigned long)event.task);
+    out.print(line);
+    first = false;
+  }
+  out.print("\n],\"displayTimeUnit\":\"ms\"}\n");
+
+  paused = false;
+}
+
+TraceScope::TraceScope(const char* spanName) : name(spanName) {
+  traceBuffer.record(name, 'B');
+}
+
+TraceScope::~TraceScope() {
+  traceBuffer.record(name, 'E');
+}
+
+#endif // TRACE_ENABLED
@@ -0,0 +1,73 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "hardware_config.h"
+
+// Enable to record begin/end spans into a RAM ring. Send 't' over Serial to
+// dump it as Chrome trace JSON (open in Perfetto or chrome://tracing).
+// Disabled, every TRACE_* macro compiles to nothing.
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+#if TRACE_ENABLED
+
+#include <atomic>
+
+// Span names must be string literals; only the pointer is stored
+struct TraceEvent {
+  const char* name;
+  uint32_t timeUs;
+  uint32_t task;            // Task handle, used as the trace thread id
+  volatile uint32_t seq;    // Write index + 1 once the slot is complete
+  char phase;               // 'B' begin, 'E' end
+};
+
+// Multi-producer ring: writers claim a slot with one atomic increment and
+// never block, so spans can be recorded from any task. Old events are
+// overwritten when the ring wraps.
+class TraceBuffer {
+private:
+  TraceEvent events[TRACE_BUFFER_EVENTS];
+  std::atomic<uint32_t> head;
+  volatile bool paused;
+
+public:
+  TraceBuffer();
+
+  void record(const char* name, char phase);
+  void clear();
+  uint32_t getRecorded();
+
+  // Writes the ring as {"traceEvents":[...]}; recording pauses meanwhile
+  void dumpChromeJson(Print& out);
+};
+
+// Ends a span when it goes out of scope
+class TraceScope {
+private:
+  const char* name;
+
+public:
+  explicit TraceScope(const char* spanName);
+  ~TraceScope();
+};
+
+extern TraceBuffer traceBuffer;
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#define TRACE_BEGIN(name) traceBuffer.record((name), 'B')
+#define TRACE_END(name)   traceBuffer.record((name), 'E')
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#else
+
+#define TRACE_BEGIN(name) do {} while (0)
+#define TRACE_END(name)   do {} while (0)
+#define TRACE_SCOPE(name) do {} while (0)
+
+#endif // TRACE_ENABLED
+
+#endif // TRACE_H
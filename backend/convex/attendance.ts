@@ -1,5 +1,13 @@
 import { mutation, query, internalMutation, internalQuery } from "./_generated/server";
 import { v } from "convex/values";
+import { Doc } from "./_generated/dataModel";
+
+// Whether a row is a check-in: a plain scan or a presence arrival.
+// Departure and dwell rows only describe a stay and must not be counted
+// as attendance.
+export function isCheckIn(record: Doc<"attendance">): boolean {
+  return record.isPresent && (record.presence === undefined || record.presence === "arrival");
+}
 
 // Record attendance for a user (single check-in)
 export const recordAttendance = mutation({
@@ -71,11 +79,11 @@ export const getEventAttendance = query({
     includeUserDetails: v.optional(v.boolean()),
   },
   handler: async (ctx, args) => {
-    const attendanceRecords = await ctx.db
+    const attendanceRecords = (await ctx.db
       .query("attendance")
       .withIndex("by_event", (q) => q.eq("eventId", args.eventId))
       .order("desc")
-      .collect();
+      .collect()).filter(isCheckIn);
 
     if (!args.includeUserDetails) {
       return attendanceRecords;
@@ -103,11 +111,11 @@ export const getUserAttendance = query({
     includeEventDetails: v.optional(v.boolean()),
   },
   handler: async (ctx, args) => {
-    const attendanceRecords = await ctx.db
+    const attendanceRecords = (await ctx.db
       .query("attendance")
       .withIndex("by_user", (q) => q.eq("userId", args.userId))
       .order("desc")
-      .collect();
+      .collect()).filter(isCheckIn);
 
     if (!args.includeEventDetails) {
       return attendanceRecords;
@@ -140,9 +148,9 @@ export const didUserAttendEvent = query({
       .withIndex("by_user_event", (q) => 
         q.eq("userId", args.userId).eq("eventId", args.eventId)
       )
-      .first();
+      .collect();
 
-    return !!attendance;
+    return attendance.some(isCheckIn);
   },
 });
 
@@ -150,7 +158,7 @@ export const didUserAttendEvent = query({
 export const getEventAttendanceStats = query({
   args: { eventId: v.id("events") },
   handler: async (ctx, args) => {
-    const [attendanceRecords, registrations] = await Promise.all([
+    const [allRecords, registrations] = await Promise.all([
       ctx.db
         .query("attendance")
         .withIndex("by_event", (q) => q.eq("eventId", args.eventId))
@@ -162,6 +170,7 @@ export const getEventAttendanceStats = query({
         .collect()
     ]);
 
+    const attendanceRecords = allRecords.filter(isCheckIn);
     const uniqueAttendees = new Set(attendanceRecords.map(a => a.userId));
     
     return {
@@ -185,6 +194,11 @@ export const batchRecordAttendance = internalMutation({
       scannerSource: v.optional(v.string()),
       rssi: v.optional(v.number()),
       deviceName: v.optional(v.string()),
+      // Presence-tracking scanners send only changes: "arrival",
+      // "departure" (timestamp = last seen) or "dwell"; dwellMs is the time
+      // present so far. Records without it are plain sightings.
+      presence: v.optional(v.string()),
+      dwellMs: v.optional(v.number()),
     })),
   },
   handler: async (ctx, args) => {
@@ -257,15 +271,19 @@ export const batchRecordAttendance = internalMutation({
           continue;
         }
 
-        // Check for existing attendance record (first-seen semantics per user/event)
-        const existingAttendance = await ctx.db
+        // Departures and dwell summaries are always stored. Sightings keep
+        // first-seen semantics per user/event; arrivals too, unless the
+        // latest record is a departure (the student came back).
+        const isChange = record.presence === "departure" || record.presence === "dwell";
+        const existingAttendance = isChange ? null : await ctx.db
           .query("attendance")
           .withIndex("by_user_event", (q) => 
             q.eq("userId", user._id).eq("eventId", event._id)
           )
+          .order("desc")
           .first();
 
-        if (existingAttendance) {
+        if (existingAttendance && (record.presence !== "arrival" || existingAttendance.isPresent)) {
           results.push({
             bleUuid: record.bleUuid,
             status: "duplicate",
@@ -289,10 +307,12 @@ export const batchRecordAttendance = internalMutation({
           scanTime: record.timestamp,
           deviceId: record.scannerSource || "unknown",
           signalStrength: record.rssi,
-          isPresent: true,
+          isPresent: record.presence !== "departure",
           scannerSource: record.scannerSource,
           synced: true, // This is from scanner sync
           syncedAt: Date.now(),
+          presence: record.presence,
+          dwellMs: record.dwellMs,
         });
 
         // Track window
@@ -392,16 +412,48 @@ export const calculateAttendancePercentage = internalMutation({
     const scanIntervalMs = scanIntervalMinutes * 60 * 1000;
     const expectedScans = Math.max(1, Math.floor(eventDuration / scanIntervalMs));
 
-    // Calculate actual presence
-    const presentScans = attendanceRecords.length;
-    const attendancePercentage = Math.min(100, (presentScans / expectedScans) * 100);
-
     // Calculate first and last seen
     const firstSeen = Math.min(...attendanceRecords.map(r => r.scanTime));
     const lastSeen = Math.max(...attendanceRecords.map(r => r.scanTime));
 
-    // Calculate total duration present (simplified - assumes continuous presence)
-    const totalDuration = lastSeen - firstSeen;
+    let presentScans: number;
+    let totalDuration: number;
+    let attendancePercentage: number;
+    if (attendanceRecords.some(r => r.presence !== undefined)) {
+      // Presence-tracking scanners send one row per change, not per scan:
+      // add up the stays from each arrival to its departure (or to the
+      // latest row of a stay that is still open) and express them in scans
+      const rows = [...attendanceRecords].sort((a, b) => a.scanTime - b.scanTime);
+      totalDuration = 0;
+      let openedAt: number | null = null;
+      let lastInStay = 0;
+      let closedAt: number | null = null;
+      for (const row of rows) {
+        if (row.presence === "departure") {
+          if (openedAt !== null) {
+            totalDuration += row.scanTime - openedAt;
+          } else if (typeof row.dwellMs === "number" && row.scanTime !== closedAt) {
+            totalDuration += row.dwellMs;  // Arrival row missing; skips a resent departure
+          }
+          openedAt = null;
+          closedAt = row.scanTime;
+        } else if (openedAt === null && isCheckIn(row)) {
+          openedAt = row.scanTime;
+        }
+        lastInStay = row.scanTime;
+      }
+      if (openedAt !== null) {
+        totalDuration += lastInStay - openedAt;
+      }
+      presentScans = Math.min(expectedScans, Math.round(totalDuration / scanIntervalMs));
+      attendancePercentage = eventDuration > 0 ? Math.min(100, (totalDuration / eventDuration) * 100) : 100;
+    } else {
+      // One row per scan the user was seen in
+      presentScans = attendanceRecords.filter(isCheckIn).length;
+      attendancePercentage = Math.min(100, (presentScans / expectedScans) * 100);
+      // Simplified - assumes continuous presence
+      totalDuration = lastSeen - firstSeen;
+    }
 
     // Update or create attendance summary
     const existingSummary = await ctx.db
@@ -134,6 +134,8 @@ http.route({
   path: "/batch-checkin",
   method: "POST",
   handler: httpAction(async (ctx, request) => {
+    // Reported back so scanners can split round trip into network and server time
+    const receivedAt = Date.now();
     try {
       // Parse request body
       const body = await request.text();
@@ -205,6 +207,7 @@ http.route({
         JSON.stringify({
           success: true,
           ...result,
+          serverMs: Date.now() - receivedAt,
         }),
         { 
           status: 200, 
@@ -1,5 +1,6 @@
 import { mutation, query, internalQuery } from "./_generated/server";
 import { v } from "convex/values";
+import { isCheckIn } from "./attendance";
 
 // Register user for an event
 export const registerForEvent = mutation({
@@ -163,7 +164,7 @@ export const getEventStats = query({
     return {
       totalRegistered: registrations.filter(r => r.status === "registered").length,
       totalCancelled: registrations.filter(r => r.status === "cancelled").length,
-      totalAttended: new Set(attendanceRecords.map(a => a.userId)).size,
+      totalAttended: new Set(attendanceRecords.filter(isCheckIn).map(a => a.userId)).size,
     };
   },
 });
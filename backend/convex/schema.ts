@@ -44,6 +44,8 @@ export default defineSchema({
     scannerSource: v.optional(v.string()), // Which scanner detected the user
     synced: v.boolean(), // Whether this was synced from offline scanner
     syncedAt: v.optional(v.number()), // When this record was synced
+    presence: v.optional(v.string()), // "arrival" | "departure" | "dwell" from presence-tracking scanners
+    dwellMs: v.optional(v.number()), // Time present when the departure/dwell record was made
   })
     .index("by_event", ["eventId"])
     .index("by_user", ["userId"])